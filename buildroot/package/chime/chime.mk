@@ -15,7 +15,7 @@ CHIME_CONFIG_VERSION = $(strip $(shell sed -n 's/^CHIME_CONFIG_VERSION=//p' $(VI
 CHIME_BUILD_ID = $(strip $(shell sed -n 's/^CHIME_BUILD_ID=//p' $(CHIME_BUILD_META_FILE) 2>/dev/null))
 CHIME_LICENSE = MIT
 CHIME_LICENSE_FILES = chime/README.md
-CHIME_DEPENDENCIES = mosquitto openssl
+CHIME_DEPENDENCIES = alsa-lib flac mosquitto openssl opusfile zlib host-zlib
 
 ifeq ($(CHIME_VERSION),)
 $(error Missing chime app version in $(CHIME_VERSION_FILE))
@@ -35,21 +35,47 @@ endif
 
 CHIME_COMMON_SOURCES = \
 	common/src/logging/logger.cpp \
+	common/src/metrics/metrics.cpp \
+	common/src/metrics/prometheus.cpp \
+	common/src/metrics/stats_segment.cpp \
+	common/src/mqtt/topic_matcher.cpp \
+	common/src/runtime/event_loop.cpp \
 	common/src/runtime/signal_handler.cpp \
+	common/src/runtime/thread_priority.cpp \
 	common/src/util/environment.cpp \
 	common/src/util/filesystem.cpp \
 	common/src/util/platform.cpp \
 	common/src/util/strings.cpp \
-	common/src/util/time.cpp
+	common/src/util/time.cpp \
+	common/src/util/write_behind_file.cpp
 
 CHIME_DAEMON_SOURCES = \
 	chime/src/main.cpp \
+	chime/src/audio/alsa_audio_player.cpp \
+	chime/src/audio/alsa_volume_control.cpp \
 	chime/src/audio/aplay_audio_player.cpp \
+	chime/src/audio/audio_engine.cpp \
+	chime/src/audio/audio_mixer.cpp \
+	chime/src/audio/flac_decoder.cpp \
+	chime/src/audio/opus_decoder.cpp \
+	chime/src/audio/pcm_convert.cpp \
+	chime/src/audio/pcm_dsp.cpp \
+	chime/src/audio/sound_cache.cpp \
+	chime/src/audio/wav.cpp \
 	chime/src/config/chime_config.cpp \
 	chime/src/network/linux_wifi_monitor.cpp \
 	chime/src/service/chime_service.cpp \
+	chime/src/service/ring_dedup.cpp \
+	chime/src/service/ring_router.cpp \
 	common/src/mqtt/client.cpp
 
+# Host tool that compiles webui/dist (synced next to chime/ when it was
+# built) into chime-webd.
+CHIME_EMBED_UI_SOURCES = \
+	chime/tools/embed_ui_assets.cpp \
+	chime/src/webd/string_utils.cpp \
+	chime/src/webd/ui_asset_cache.cpp
+
 CHIME_WEBD_SOURCES = \
 	chime/src/webd/main.cpp \
 	chime/src/webd/apply_manager.cpp \
@@ -57,6 +83,7 @@ CHIME_WEBD_SOURCES = \
 	chime/src/webd/json.cpp \
 	chime/src/webd/mdns.cpp \
 	chime/src/webd/string_utils.cpp \
+	chime/src/webd/ui_asset_cache.cpp \
 	chime/src/webd/ui_assets.cpp \
 	chime/src/webd/web_server.cpp \
 	chime/src/webd/wifi_scan.cpp
@@ -68,14 +95,22 @@ define CHIME_BUILD_CMDS
 		-DCHIME_CONFIG_VERSION=\"$(CHIME_CONFIG_VERSION)\" \
 		-DCHIME_BUILD_ID=\"$(CHIME_BUILD_ID)\" \
 		-I$(@D)/chime/include -I$(@D)/common/include \
+		-I$(STAGING_DIR)/usr/include/opus \
 		-o $(@D)/chime/chime \
 		$(addprefix $(@D)/,$(CHIME_COMMON_SOURCES) $(CHIME_DAEMON_SOURCES)) \
-		$(TARGET_LDFLAGS) -lmosquitto
+		$(TARGET_LDFLAGS) -lmosquitto -lasound -lFLAC -lopusfile -lopus -logg -lpthread
+	$(HOSTCXX) $(HOST_CXXFLAGS) -std=c++20 -Wall -Wextra \
+		-I$(@D)/chime/include \
+		-o $(@D)/chime/chime-webd-embed-ui \
+		$(addprefix $(@D)/,$(CHIME_EMBED_UI_SOURCES)) \
+		$(HOST_LDFLAGS) -lz
+	$(@D)/chime/chime-webd-embed-ui $(@D)/webui/dist $(@D)/chime/webd_embedded_ui.cpp
 	$(TARGET_CXX) $(TARGET_CXXFLAGS) -std=c++20 -Wall -Wextra \
 		-I$(@D)/chime/include -I$(@D)/common/include \
 		-o $(@D)/chime/chime-webd \
 		$(addprefix $(@D)/,$(CHIME_COMMON_SOURCES) $(CHIME_WEBD_SOURCES)) \
-		$(TARGET_LDFLAGS) -lssl -lcrypto -lpthread
+		$(@D)/chime/webd_embedded_ui.cpp \
+		$(TARGET_LDFLAGS) -lssl -lcrypto -lz -lpthread
 endef
 
 # Install to /usr/local/bin
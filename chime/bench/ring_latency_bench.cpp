@@ -0,0 +1,352 @@
+// Ring-path latency benchmark.
+//
+// Drives ChimeService::OnMessage with synthetic MQTT messages and reports
+// p50/p99/max for each stage of the ring path:
+//   match+log    message dispatch -> "ring received" (topic match, message log)
+//   play call    message dispatch -> AudioPlayer::Play()
+//   on_message   full OnMessage() for ring and non-ring messages
+//   first frame  message dispatch -> first PCM frames queued (--backend=alsa)
+//
+// The default backend is an instrumented fake AudioPlayer, so the numbers
+// isolate the daemon's own work. --backend=alsa plays a short generated tone
+// through AlsaAudioPlayer (use --device=null for a sink that needs no card).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "chime/audio_player.h"
+#include "chime/chime_config.h"
+#include "chime/chime_service.h"
+#include "chime/sound_cache.h"
+#include "chime/volume_control.h"
+#include "chime/wav.h"
+#include "chime/wifi_monitor.h"
+#include "vc/logging/logger.h"
+#include "vc/metrics/metrics.h"
+#include "vc/mqtt/client.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kDefaultIterations = 10000;
+constexpr int kDefaultAlsaIterations = 100;
+constexpr int kDefaultWarmup = 100;
+constexpr int kDefaultAlsaWarmup = 5;
+constexpr int kToneSampleRate = 48000;
+constexpr int kToneMilliseconds = 20;
+constexpr auto kFirstFrameTimeout = std::chrono::seconds(2);
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+struct Options {
+    std::string backend = "fake";
+    std::string device = "null";
+    int iterations = 0;
+    int warmup = -1;
+    std::size_t payload_bytes = 64;
+    bool verbose = false;
+};
+
+class Series {
+  public:
+    explicit Series(std::string name) : name_(std::move(name)) {}
+
+    void Add(int64_t ns) { samples_.push_back(ns); }
+
+    void Print() {
+        if (samples_.empty()) {
+            std::printf("%-22s %8s\n", name_.c_str(), "n/a");
+            return;
+        }
+        std::sort(samples_.begin(), samples_.end());
+        std::printf("%-22s %8zu %10.2f %10.2f %10.2f\n", name_.c_str(), samples_.size(), Percentile(0.50) / 1000.0,
+                    Percentile(0.99) / 1000.0, static_cast<double>(samples_.back()) / 1000.0);
+    }
+
+  private:
+    double Percentile(double fraction) const {
+        const auto index = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(samples_.size()))) - 1;
+        return static_cast<double>(samples_[std::min(index, samples_.size() - 1)]);
+    }
+
+    std::string name_;
+    std::vector<int64_t> samples_;
+};
+
+// Swallows log output (unless verbose) but timestamps the lines that mark
+// ring-path milestones. The first-frame line is logged by the engine's
+// housekeeping thread some time after the fact, so instead of timestamping
+// it, this keeps the render thread's own request-to-first-frame figure.
+class TimingLogger final : public vc::logging::Logger {
+  public:
+    explicit TimingLogger(bool verbose) : verbose_(verbose) {}
+
+    void Log(vc::logging::Level level, std::string_view component, std::string_view message) override {
+        const int64_t now = NowNs();
+        constexpr std::string_view kFirstFrames = "first frames queued ";
+        if (component == "chime" && message.substr(0, 13) == "ring received") {
+            ring_logged_ns_.store(now);
+        } else if (component == "audio" && message.substr(0, kFirstFrames.size()) == kFirstFrames) {
+            // "first frames queued <N>us after request (...)"
+            const std::string value(message.substr(kFirstFrames.size()));
+            first_frame_us_.store(std::strtoll(value.c_str(), nullptr, 10));
+        }
+        if (verbose_ || level != vc::logging::Level::kInfo) {
+            echo_.Log(level, component, message);
+        }
+    }
+
+    void Reset() {
+        ring_logged_ns_.store(0);
+        first_frame_us_.store(-1);
+    }
+
+    int64_t ring_logged_ns() const { return ring_logged_ns_.load(); }
+    // Play() to first PCM frames queued, as measured on the render thread;
+    // -1 until the engine reports it.
+    int64_t first_frame_us() const { return first_frame_us_.load(); }
+
+  private:
+    bool verbose_;
+    vc::logging::StderrLogger echo_;
+    std::atomic<int64_t> ring_logged_ns_{0};
+    std::atomic<int64_t> first_frame_us_{-1};
+};
+
+class FakeAudioPlayer final : public chime::AudioPlayer {
+  public:
+    void Play(const std::string &, int, chime::SoundCategory) override {}
+    bool IsPlaying() const override { return false; }
+};
+
+// Notes when Play() is called before handing it on. The engine takes its
+// request timestamp on entry to the same call, so play_ns() plus the
+// render thread's figure is when the first frames were queued.
+class TimedAudioPlayer final : public chime::AudioPlayer {
+  public:
+    explicit TimedAudioPlayer(chime::AudioPlayer &inner) : inner_(inner) {}
+
+    void Play(const std::string &path, int volume_percent, chime::SoundCategory category) override {
+        play_ns_ = NowNs();
+        inner_.Play(path, volume_percent, category);
+    }
+    bool IsPlaying() const override { return inner_.IsPlaying(); }
+
+    void Reset() { play_ns_ = 0; }
+    int64_t play_ns() const { return play_ns_; }
+
+  private:
+    chime::AudioPlayer &inner_;
+    int64_t play_ns_ = 0;
+};
+
+class NullWifiMonitor final : public chime::WifiMonitor {
+  public:
+    std::optional<chime::WifiState> ReadState(const std::string &) const override { return std::nullopt; }
+};
+
+bool WriteTone(const std::string &path) {
+    constexpr int frames = kToneSampleRate * kToneMilliseconds / 1000;
+    std::vector<uint8_t> samples;
+    samples.reserve(static_cast<std::size_t>(frames) * 2);
+    for (int i = 0; i < frames; ++i) {
+        const double phase = 2.0 * 3.14159265358979 * 880.0 * i / kToneSampleRate;
+        const auto sample = static_cast<int16_t>(std::lround(8000.0 * std::sin(phase)));
+        samples.push_back(static_cast<uint8_t>(static_cast<uint16_t>(sample) & 0xFF));
+        samples.push_back(static_cast<uint8_t>((static_cast<uint16_t>(sample) >> 8) & 0xFF));
+    }
+    const std::vector<uint8_t> header = chime::BuildWavHeader(1, kToneSampleRate, 16, samples.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+    out.write(reinterpret_cast<const char *>(samples.data()), static_cast<std::streamsize>(samples.size()));
+    return out.good();
+}
+
+void PrintUsage(const char *program) {
+    std::fprintf(stderr,
+                 "Usage: %s [--backend=fake|alsa] [--device=NAME] [--iterations=N] [--warmup=N]\n"
+                 "          [--payload-bytes=N] [--verbose]\n",
+                 program);
+}
+
+bool ParseOptions(int argc, char *argv[], Options *options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const auto value_of = [&arg](std::string_view prefix) -> std::optional<std::string> {
+            if (arg.substr(0, prefix.size()) != prefix) {
+                return std::nullopt;
+            }
+            return std::string(arg.substr(prefix.size()));
+        };
+
+        if (const auto value = value_of("--backend=")) {
+            options->backend = *value;
+        } else if (const auto value = value_of("--device=")) {
+            options->device = *value;
+        } else if (const auto value = value_of("--iterations=")) {
+            options->iterations = std::atoi(value->c_str());
+        } else if (const auto value = value_of("--warmup=")) {
+            options->warmup = std::atoi(value->c_str());
+        } else if (const auto value = value_of("--payload-bytes=")) {
+            options->payload_bytes = static_cast<std::size_t>(std::strtoul(value->c_str(), nullptr, 10));
+        } else if (arg == "--verbose") {
+            options->verbose = true;
+        } else {
+            return false;
+        }
+    }
+    if (options->backend != "fake" && options->backend != "alsa") {
+        return false;
+    }
+    if (options->iterations <= 0) {
+        options->iterations = options->backend == "alsa" ? kDefaultAlsaIterations : kDefaultIterations;
+    }
+    if (options->warmup < 0) {
+        options->warmup = options->backend == "alsa" ? kDefaultAlsaWarmup : kDefaultWarmup;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, &options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+    const bool use_alsa = options.backend == "alsa";
+    if (use_alsa && !chime::AlsaAudioPlayer::Available()) {
+        std::fprintf(stderr, "alsa backend not available in this build\n");
+        return 1;
+    }
+
+    const std::filesystem::path work_dir =
+        std::filesystem::temp_directory_path() / ("chime-bench-" + std::to_string(getpid()));
+    std::filesystem::create_directories(work_dir);
+    const std::string sound_path = (work_dir / "tone.wav").string();
+    if (!WriteTone(sound_path)) {
+        std::fprintf(stderr, "failed to write %s\n", sound_path.c_str());
+        return 1;
+    }
+
+    chime::ChimeConfig config;
+    config.ring_topic = "doorbell/+/ring";
+    config.sound_path = sound_path;
+    config.ring_sounds_dir.clear();
+    config.observed_topics_path = (work_dir / "observed_topics.txt").string();
+    config.metrics_path = (work_dir / "metrics.json").string();
+    // Every iteration sends the same ring; none of them may be dropped.
+    config.ring_dedup_window_ms = 0;
+    config.audio_backend = options.backend;
+    config.audio_device = options.device;
+
+    TimingLogger logger(options.verbose);
+    chime::SoundCache sound_cache(logger, chime::PcmOutputFormat{static_cast<uint16_t>(config.audio_output_channels),
+                                                                 static_cast<uint32_t>(config.audio_output_rate)});
+    sound_cache.Preload({sound_path});
+
+    vc::metrics::Registry metrics;
+    FakeAudioPlayer fake_player;
+    std::unique_ptr<chime::AlsaAudioPlayer> alsa_player;
+    chime::AudioPlayer *inner_player = &fake_player;
+    if (use_alsa) {
+        alsa_player = std::make_unique<chime::AlsaAudioPlayer>(logger, sound_cache, options.device,
+                                                               chime::MixerPolicy{}, config.audio_realtime_priority,
+                                                               metrics);
+        inner_player = alsa_player.get();
+    }
+    TimedAudioPlayer timed_player(*inner_player);
+
+    chime::VolumeControl volume_control(logger, config.audio_mixer_card);
+    NullWifiMonitor wifi_monitor;
+    chime::ChimeService service(config, logger, timed_player, sound_cache, volume_control, wifi_monitor, metrics);
+
+    vc::mqtt::Message ring;
+    ring.topic = "doorbell/front/ring";
+    ring.payload.assign(options.payload_bytes, 'x');
+    vc::mqtt::Message other;
+    other.topic = "sensors/garage/temperature";
+    other.payload.assign(options.payload_bytes, '7');
+
+    Series match_and_log("match+log");
+    Series play_call("play call");
+    Series first_frame("first frame");
+    Series ring_on_message("on_message (ring)");
+    Series other_on_message("on_message (other)");
+
+    const int total = options.warmup + options.iterations;
+    for (int i = 0; i < total; ++i) {
+        const bool record = i >= options.warmup;
+        logger.Reset();
+        timed_player.Reset();
+
+        const int64_t ring_start = NowNs();
+        service.OnMessage(ring.View());
+        const int64_t ring_end = NowNs();
+
+        if (use_alsa) {
+            const auto deadline = Clock::now() + kFirstFrameTimeout;
+            while (logger.first_frame_us() < 0 && Clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            while (timed_player.IsPlaying() && Clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        const int64_t other_start = NowNs();
+        service.OnMessage(other.View());
+        const int64_t other_end = NowNs();
+
+        if (!record) {
+            continue;
+        }
+        if (logger.ring_logged_ns() != 0) {
+            match_and_log.Add(logger.ring_logged_ns() - ring_start);
+        }
+        if (timed_player.play_ns() != 0) {
+            play_call.Add(timed_player.play_ns() - ring_start);
+            if (logger.first_frame_us() >= 0) {
+                first_frame.Add(timed_player.play_ns() - ring_start + logger.first_frame_us() * 1000);
+            }
+        }
+        ring_on_message.Add(ring_end - ring_start);
+        other_on_message.Add(other_end - other_start);
+    }
+
+    std::printf("backend=%s iterations=%d warmup=%d payload_bytes=%zu\n", options.backend.c_str(), options.iterations,
+                options.warmup, options.payload_bytes);
+    std::printf("%-22s %8s %10s %10s %10s\n", "stage", "samples", "p50_us", "p99_us", "max_us");
+    match_and_log.Print();
+    play_call.Print();
+    if (use_alsa) {
+        first_frame.Print();
+    }
+    ring_on_message.Print();
+    other_on_message.Print();
+
+    alsa_player.reset();
+    std::error_code ec;
+    std::filesystem::remove_all(work_dir, ec);
+    return 0;
+}
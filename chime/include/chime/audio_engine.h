@@ -0,0 +1,116 @@
+#ifndef CHIME_AUDIO_ENGINE_H
+#define CHIME_AUDIO_ENGINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "chime/audio_mixer.h"
+
+namespace vc::logging {
+class Logger;
+}
+
+namespace vc::metrics {
+class Histogram;
+class Registry;
+}
+
+namespace chime {
+
+class SoundCache;
+
+// Output device driven by the engine's render thread. Implementations never
+// log; state changes and failures are reported by posting MixerEvents to the
+// mixer passed in. Write() runs once per period and must not allocate;
+// Configure() only runs when playback starts after an idle period. Work that
+// must stay off the render thread goes into Housekeep(), which a sink can
+// request with AudioMixer::WakeHousekeeping().
+class PcmSink {
+  public:
+    virtual ~PcmSink() = default;
+
+    virtual const std::string &Name() const = 0;
+    // Opens the device if needed, applies `format` if it changed and readies
+    // the device for writes.
+    virtual bool Configure(const MixerFormat &format, AudioMixer &mixer) = 0;
+    // Blocks until the device has accepted all frames.
+    virtual bool Write(const uint8_t *data, std::size_t frames, AudioMixer &mixer) = 0;
+    // Plays out queued audio, then stops the device.
+    virtual void Drain() = 0;
+    // Stops the device and discards queued audio.
+    virtual void Drop() = 0;
+    virtual void Close() = 0;
+    // Runs on the housekeeping thread each time it wakes.
+    virtual void Housekeep() {}
+};
+
+// Long-lived playback pipeline around an AudioMixer: Play() resolves the
+// sound and enqueues it without blocking (a sound missing from the cache is
+// loaded by the cache's loader thread and enqueued from there once it is
+// ready), a render thread mixes periods into
+// the sink, and a housekeeping thread logs mixer events, frees retired sounds
+// and runs the sink's Housekeep(). After the last voice ends the render thread keeps the device
+// running on silence for a short while so back-to-back rings skip the
+// prepare step.
+//
+// Play() is meant to be called from one thread (the service loop). A positive
+// realtime_priority runs the render thread under SCHED_FIFO. Start latency
+// and playback time of every sound are recorded in `metrics`.
+class AudioEngine {
+  public:
+    static constexpr std::size_t kPeriodFrames = 256;
+    static constexpr uint16_t kMaxChannels = 8;
+
+    AudioEngine(vc::logging::Logger &logger, SoundCache &sounds, const MixerPolicy &policy,
+                std::unique_ptr<PcmSink> sink, int realtime_priority, vc::metrics::Registry &metrics);
+    ~AudioEngine();
+
+    AudioEngine(const AudioEngine &) = delete;
+    AudioEngine &operator=(const AudioEngine &) = delete;
+
+    void Play(const std::string &path, int volume_percent, SoundCategory category);
+    bool IsPlaying() const { return mixer_.Active(); }
+
+  private:
+    // Serializes the command queue's producers, Play() and loads completing
+    // on the sound cache's loader thread. Shared with pending loads so the
+    // destructor can cut them off.
+    struct Producer {
+        std::mutex mutex;
+        AudioEngine *engine = nullptr;
+    };
+
+    // Called with the producer mutex held.
+    void Submit(const std::string &path, std::shared_ptr<const CachedSound> sound, int volume_percent,
+                SoundCategory category, int64_t requested_at);
+    void RenderLoop();
+    void HousekeepingLoop();
+    void LogEvent(const MixerEvent &event);
+
+    vc::logging::Logger &logger_;
+    SoundCache &sounds_;
+    std::unique_ptr<PcmSink> sink_;
+    AudioMixer mixer_;
+    vc::metrics::Histogram &start_latency_us_;
+    vc::metrics::Histogram &playback_ms_;
+
+    std::shared_ptr<Producer> producer_;
+    uint32_t next_id_ = 1;
+    std::atomic<bool> stopping_{false};
+    // Set only after the render thread has exited, so a sink waiting in
+    // Configure() on Housekeep() is still served during shutdown.
+    std::atomic<bool> housekeeping_stopping_{false};
+    uint64_t reported_dropped_events_ = 0;
+
+    std::thread render_thread_;
+    std::thread housekeeping_thread_;
+};
+
+} // namespace chime
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef CHIME_AUDIO_MIXER_H
+#define CHIME_AUDIO_MIXER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "chime/pcm_dsp.h"
+#include "chime/sound_cache.h"
+#include "vc/util/spsc_queue.h"
+
+namespace chime {
+
+enum class SoundCategory : uint8_t { kBell, kNotification, kOther };
+
+const char *SoundCategoryName(SoundCategory category);
+
+// What happens when a sound starts while another of the same category plays.
+enum class OverlapPolicy : uint8_t { kMix, kQueue, kReplace };
+
+// What a bell does to notification and other voices that are playing.
+enum class BellPriority : uint8_t { kMix, kDuck, kPreempt };
+
+std::optional<OverlapPolicy> ParseOverlapPolicy(std::string_view value);
+std::optional<BellPriority> ParseBellPriority(std::string_view value);
+
+struct MixerPolicy {
+    OverlapPolicy bell = OverlapPolicy::kReplace;
+    OverlapPolicy notification = OverlapPolicy::kQueue;
+    OverlapPolicy other = OverlapPolicy::kQueue;
+    BellPriority bell_priority = BellPriority::kDuck;
+    int32_t duck_gain_q15 = kQ15Unity / 4;
+
+    OverlapPolicy ForCategory(SoundCategory category) const;
+};
+
+struct MixerFormat {
+    uint16_t channels = 0;
+    uint32_t sample_rate = 0;
+    uint16_t bits_per_sample = 0;
+
+    bool valid() const { return channels != 0 && sample_rate != 0 && bits_per_sample != 0; }
+    bool operator==(const MixerFormat &other) const = default;
+};
+
+MixerFormat FormatOf(const CachedSound &sound);
+
+struct MixerCommand {
+    uint32_t id = 0;
+    SoundCategory category = SoundCategory::kOther;
+    int32_t gain_q15 = kQ15Unity;
+    int64_t requested_at_ns = 0;
+    std::shared_ptr<const CachedSound> sound;
+};
+
+// Emitted by the render thread for the housekeeping thread to log. Fields
+// other than type are event specific; `what` always points at a literal.
+struct MixerEvent {
+    enum class Type : uint8_t {
+        kStarted,   // value = request-to-first-render latency (us)
+        kFinished,  // value = request-to-finish time (ms)
+        kQueued,
+        kDeferred,  // waiting for the device to go idle for a format change
+        kReplaced,
+        kPreempted,
+        kDropped,
+        kDeviceOpened,
+        kDeviceConfigured,  // value = sample rate, code = channels
+        kDeviceError,       // code = negative errno, what = failing call
+        kUnderrun,
+    };
+
+    Type type = Type::kStarted;
+    uint32_t id = 0;
+    SoundCategory category = SoundCategory::kOther;
+    int64_t value = 0;
+    int32_t code = 0;
+    const char *what = "";
+};
+
+// Real-time mixer shared by a control thread, a render thread and a
+// housekeeping thread. The control thread submits play commands through a
+// wait-free SPSC queue; the render thread applies the policy, mixes up to
+// kMaxVoices voices with the PCM kernels (16-bit voices are summed at 32 bits
+// and saturated once) and reports through an event queue.
+// Nothing on the render side allocates, locks or frees: finished sounds are
+// handed back through a retire queue and released by the housekeeping thread.
+//
+// Voices only mix when they share one output format. A sound in a different
+// format waits in the pending list until the mixer is idle, at which point
+// WantedFormat() reports it so the render thread can reconfigure the device.
+class AudioMixer {
+  public:
+    static constexpr std::size_t kMaxVoices = 4;
+    static constexpr std::size_t kMaxPending = 8;
+    static constexpr std::size_t kCommandCapacity = 16;
+    static constexpr std::size_t kEventCapacity = 128;
+    static constexpr std::size_t kRetireCapacity = 32;
+    // Samples (frames * channels) summed per accumulator pass.
+    static constexpr std::size_t kMixChunkSamples = 1024;
+
+    explicit AudioMixer(const MixerPolicy &policy);
+
+    AudioMixer(const AudioMixer &) = delete;
+    AudioMixer &operator=(const AudioMixer &) = delete;
+
+    // Control thread.
+    bool Submit(MixerCommand &&command);
+    bool Active() const { return active_voices_.load(std::memory_order_acquire) > 0; }
+    uint32_t ActiveVoices() const { return active_voices_.load(std::memory_order_relaxed); }
+
+    // Housekeeping thread.
+    bool PopEvent(MixerEvent *event);
+    std::size_t ReleaseRetired();
+    uint32_t EventSequence() const { return event_seq_.load(std::memory_order_acquire); }
+    void WaitForEvents(uint32_t seen) const { event_seq_.wait(seen, std::memory_order_acquire); }
+    uint64_t DroppedEvents() const { return dropped_events_.load(std::memory_order_relaxed); }
+
+    // Render thread.
+    uint32_t CommandSequence() const { return command_seq_.load(std::memory_order_acquire); }
+    void WaitForCommands(uint32_t seen) const { command_seq_.wait(seen, std::memory_order_acquire); }
+    void ProcessCommands();
+    bool HasPending() const { return pending_count_ > 0; }
+    MixerFormat OutputFormat() const { return output_format_; }
+    MixerFormat WantedFormat() const;
+    void SetOutputFormat(const MixerFormat &format);
+    void Render(uint8_t *out, std::size_t frames);
+    void StopAll(MixerEvent::Type reason);
+    void DropPending();
+    void PostEvent(const MixerEvent &event);
+
+    // Any thread; wakes both waiters (used for shutdown).
+    void Interrupt();
+    // Any thread; wakes the housekeeping thread without posting an event.
+    void WakeHousekeeping();
+
+  private:
+    struct Voice {
+        std::shared_ptr<const CachedSound> sound;
+        uint32_t id = 0;
+        SoundCategory category = SoundCategory::kOther;
+        int32_t gain_q15 = kQ15Unity;
+        int64_t requested_at_ns = 0;
+        uint64_t start_order = 0;
+        std::size_t frame = 0;
+        bool active = false;
+        bool started = false;
+    };
+
+    void RenderChunk(uint8_t *out, std::size_t frames);
+    void ApplyPlay(MixerCommand &&command);
+    bool CanStart(const MixerCommand &command) const;
+    bool StartVoice(MixerCommand &&command);
+    void Enqueue(MixerCommand &&command, MixerEvent::Type reason);
+    void RemovePending(std::size_t index);
+    void Promote();
+    void Retire(Voice &voice, MixerEvent::Type reason);
+    bool CategoryActive(SoundCategory category) const;
+    void UpdateActiveCount();
+
+    const MixerPolicy policy_;
+    const PcmKernels &kernels_;
+
+    vc::util::SpscQueue<MixerCommand, kCommandCapacity> commands_;
+    vc::util::SpscQueue<MixerEvent, kEventCapacity> events_;
+    vc::util::SpscQueue<std::shared_ptr<const CachedSound>, kRetireCapacity> retired_;
+    std::atomic<uint32_t> command_seq_{0};
+    std::atomic<uint32_t> event_seq_{0};
+    std::atomic<uint32_t> active_voices_{0};
+    std::atomic<uint64_t> dropped_events_{0};
+
+    // Render-thread state.
+    std::array<Voice, kMaxVoices> voices_{};
+    std::array<MixerCommand, kMaxPending> pending_{};
+    std::size_t pending_count_ = 0;
+    MixerFormat output_format_;
+    uint64_t next_start_order_ = 0;
+    std::array<int32_t, kMixChunkSamples> accumulator_{};
+};
+
+} // namespace chime
+
+#endif
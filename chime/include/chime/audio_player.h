@@ -1,37 +1,78 @@
 #ifndef CHIME_AUDIO_PLAYER_H
 #define CHIME_AUDIO_PLAYER_H
 
-#include <atomic>
-#include <mutex>
+#include <memory>
 #include <string>
-#include <thread>
+
+#include "chime/audio_mixer.h"
 
 namespace vc::logging {
 class Logger;
 }
 
+namespace vc::metrics {
+class Registry;
+}
+
 namespace chime {
 
+class AudioEngine;
+class SoundCache;
+
 class AudioPlayer {
  public:
   virtual ~AudioPlayer() = default;
-  virtual void Play(const std::string& path, int volume_percent = 100) = 0;
+  virtual void Play(const std::string& path, int volume_percent = 100,
+                    SoundCategory category = SoundCategory::kOther) = 0;
   virtual bool IsPlaying() const = 0;
 };
 
+// Mixes sounds in software through an AudioEngine and streams the result into
+// a long-lived `aplay -` process. aplay is started when playback begins and
+// exits once the engine goes idle.
 class AplayAudioPlayer final : public AudioPlayer {
  public:
-  explicit AplayAudioPlayer(vc::logging::Logger& logger);
+  AplayAudioPlayer(vc::logging::Logger& logger, SoundCache& sounds, const MixerPolicy& policy,
+                   int realtime_priority, vc::metrics::Registry& metrics);
   ~AplayAudioPlayer() override;
 
-  void Play(const std::string& path, int volume_percent = 100) override;
+  AplayAudioPlayer(const AplayAudioPlayer&) = delete;
+  AplayAudioPlayer& operator=(const AplayAudioPlayer&) = delete;
+
+  void Play(const std::string& path, int volume_percent = 100,
+            SoundCategory category = SoundCategory::kOther) override;
+  bool IsPlaying() const override;
+
+ private:
+  vc::logging::Logger& logger_;
+  std::unique_ptr<AudioEngine> engine_;
+};
+
+// Plays sounds through libasound via an AudioEngine, so overlapping sounds
+// are mixed according to the MixerPolicy instead of being skipped. The PCM
+// handle is opened on first use and kept open between rings. Samples come
+// from the sound cache; paths that are not cached are loaded in the
+// background and play once they are ready.
+class AlsaAudioPlayer final : public AudioPlayer {
+ public:
+  AlsaAudioPlayer(vc::logging::Logger& logger, SoundCache& sounds, std::string device_name,
+                  const MixerPolicy& policy, int realtime_priority, vc::metrics::Registry& metrics);
+  ~AlsaAudioPlayer() override;
+
+  AlsaAudioPlayer(const AlsaAudioPlayer&) = delete;
+  AlsaAudioPlayer& operator=(const AlsaAudioPlayer&) = delete;
+
+  // False when the binary was built without libasound.
+  static bool Available();
+
+  void Play(const std::string& path, int volume_percent = 100,
+            SoundCategory category = SoundCategory::kOther) override;
   bool IsPlaying() const override;
 
  private:
   vc::logging::Logger& logger_;
-  std::atomic<bool> playing_{false};
-  std::mutex playback_thread_mutex_;
-  std::thread playback_thread_;
+  std::string device_name_;
+  std::unique_ptr<AudioEngine> engine_;
 };
 
 }  // namespace chime
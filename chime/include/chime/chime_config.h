@@ -8,6 +8,19 @@
 
 namespace chime {
 
+// One ring_routes entry: a ring on `topic_filter` plays `sound`.
+struct RingRoute {
+  std::string topic_filter;
+  // Absolute path, or a file name inside ring_sounds_dir.
+  std::string sound;
+  // 0-100; -1 uses volume_bell.
+  int volume = -1;
+  // When several routes match a message, the highest priority one plays.
+  int priority = 0;
+  // Further matches of this route are ignored this long after it played.
+  int cooldown_ms = 0;
+};
+
 struct ChimeConfig {
   std::string host;
   int port = 0;
@@ -28,13 +41,52 @@ struct ChimeConfig {
   std::string sound_path = "/usr/local/share/chime/ring.wav";
   std::string notification_success_sound_path = "/usr/local/share/chime/test.wav";
   std::string notification_failure_sound_path = "/usr/local/share/chime/ring.wav";
+  std::string ring_sounds_dir = "/var/lib/chime/ring_sounds";
+  // Topic-to-sound table. When empty, ring_topic plays sound_path at
+  // volume_bell.
+  std::vector<RingRoute> ring_routes;
+  // Repeats of a ring (same topic and payload) within this window are
+  // dropped before playback; 0 disables.
+  int ring_dedup_window_ms = 1000;
   int volume_bell = 80;
   int volume_notifications = 70;
   int volume_other = 70;
   bool audio_enabled = true;
+  std::string audio_backend = "alsa";
+  std::string audio_device = "default";
+  // ALSA mixer (card) holding the hardware volume control, and the level it
+  // is set to at startup. Per-sound volumes are applied in software on top.
+  std::string audio_mixer_card = "default";
+  int audio_hardware_volume = 100;
+  // Native format of the output device. Every sound is converted to it once
+  // when the sound cache loads the file.
+  int audio_output_rate = 48000;
+  int audio_output_channels = 2;
+  // Mixer policy (alsa backend): overlap handling per sound category and what
+  // a bell does to other sounds that are playing.
+  std::string audio_policy_bell = "replace";
+  std::string audio_policy_notification = "queue";
+  std::string audio_policy_other = "queue";
+  std::string audio_bell_priority = "duck";
+  int audio_duck_percent = 25;
+  // SCHED_FIFO priority of the audio render thread; 0 keeps normal scheduling.
+  int audio_realtime_priority = 20;
 
   std::string wifi_interface = "wlan0";
   int wifi_check_interval = 5;
+
+  // Shared with chime-webd, which reads it for ring-topic suggestions.
+  std::string observed_topics_path = "/var/lib/chime/observed_topics.txt";
+
+  // Metrics snapshot (JSON), published retained on metrics_topic and written
+  // to metrics_path for chime-webd every metrics_interval seconds; 0
+  // disables both.
+  int metrics_interval = 60;
+  std::string metrics_topic = "chime/metrics";
+  std::string metrics_path = "/var/run/chime_metrics.json";
+  // Shared-memory copy of the metrics, refreshed every second, that
+  // chime-webd serves at /metrics; empty disables it.
+  std::string stats_segment_path = "/dev/shm/chime_stats";
 };
 
 vc::config::LoadResult<ChimeConfig> LoadConfig(const std::string& path);
@@ -2,15 +2,27 @@
 #define CHIME_CHIME_SERVICE_H
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <optional>
 #include <string>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
 #include "chime/audio_player.h"
 #include "chime/chime_config.h"
+#include "chime/observed_topics.h"
+#include "chime/ring_dedup.h"
+#include "chime/ring_router.h"
+#include "chime/sound_cache.h"
+#include "chime/volume_control.h"
 #include "chime/wifi_monitor.h"
+#include "vc/metrics/metrics.h"
+#include "vc/metrics/stats_segment.h"
 #include "vc/mqtt/client.h"
+#include "vc/runtime/event_loop.h"
+#include "vc/util/lru_map.h"
+#include "vc/util/write_behind_file.h"
 
 namespace vc::logging {
 class Logger;
@@ -25,43 +37,81 @@ namespace chime {
 class ChimeService final : public vc::mqtt::EventHandler {
  public:
   ChimeService(const ChimeConfig& config, vc::logging::Logger& logger,
-               AudioPlayer& audio_player, const WifiMonitor& wifi_monitor);
+               AudioPlayer& audio_player, SoundCache& sound_cache,
+               const VolumeControl& volume_control,
+               const WifiMonitor& wifi_monitor, vc::metrics::Registry& metrics);
 
   int Run(vc::runtime::SignalHandler& signal_handler);
 
   void OnConnect(int rc) override;
   void OnDisconnect(int rc) override;
-  void OnMessage(const vc::mqtt::Message& message) override;
+  void OnMessage(const vc::mqtt::MessageView& message) override;
 
  private:
   enum class NotificationSoundType { kSuccess, kFailure };
 
+  // Broker socket plumbing for the event loop.
+  void WatchMqttSocket();
+  void OnMqttSocketReady(uint32_t events);
+  void ReportMqttBacklog();
+  void UpdateMqttWriteInterest();
+  void HandleMqttLoopError();
+  void ScheduleMqttReconnect();
+  void ReconnectMqtt();
+
+  // Routing, de-duplication and playback for a message on a ring topic.
+  void HandleRing(const vc::mqtt::MessageView& message,
+                  std::chrono::steady_clock::time_point now);
   void LogWifiState(const WifiState& state) const;
   void LogHealth(bool clock_sane);
-  bool RingTopicMatches(const std::string& message_topic) const;
+  void UpdateMetricGauges();
+  void PublishMetrics();
   bool WifiStateIsConnected(const std::optional<WifiState>& state) const;
   void PlayNotification(NotificationSoundType type);
-  void RecordObservedTopic(const std::string& topic);
+  void RecordObservedTopic(std::string_view topic);
   void LoadObservedTopics();
-  bool PersistObservedTopics(std::string* error) const;
+  void QueueObservedTopicsWrite();
 
   const ChimeConfig& config_;
   vc::logging::Logger& logger_;
   vc::mqtt::Client mqtt_client_;
   AudioPlayer& audio_player_;
+  SoundCache& sound_cache_;
+  const VolumeControl& volume_control_;
   const WifiMonitor& wifi_monitor_;
+  RingRouter ring_router_;
+  RingDeduplicator ring_dedup_;
+  vc::runtime::EventLoop event_loop_;
+  int mqtt_socket_ = -1;
+  bool mqtt_want_write_ = false;
+  bool mqtt_falling_behind_ = false;
+  vc::runtime::EventLoop::TimerId reconnect_timer_ = -1;
 
   std::atomic<bool> mqtt_connected_{false};
-  std::atomic<unsigned long long> messages_received_{0};
-  std::atomic<unsigned long long> ring_messages_received_{0};
-  std::atomic<unsigned long long> loop_errors_{0};
-  std::atomic<unsigned long long> reconnect_attempts_{0};
-  std::atomic<unsigned long long> heartbeats_sent_{0};
+  vc::metrics::Registry& metrics_;
+  vc::metrics::Counter& messages_received_;
+  vc::metrics::Counter& ring_messages_received_;
+  vc::metrics::Counter& loop_errors_;
+  vc::metrics::Counter& reconnect_attempts_;
+  vc::metrics::Counter& heartbeats_sent_;
+  vc::metrics::CounterFamily& topic_messages_;
+  vc::metrics::CounterFamily& topic_bytes_;
+  vc::metrics::Histogram& message_bytes_;
+  vc::metrics::Histogram& dispatch_us_;
+  vc::metrics::Gauge& mqtt_connected_gauge_;
+  vc::metrics::Gauge& mqtt_backlog_gauge_;
+  vc::metrics::Gauge& cached_sounds_gauge_;
+  vc::metrics::Gauge& observed_topics_gauge_;
+  vc::metrics::StatsSegmentWriter stats_segment_;
 
   bool clock_was_unsynced_ = false;
-  std::vector<std::string> observed_topics_;
-  std::unordered_set<std::string> observed_topics_set_;
+  std::string message_log_;
+  vc::util::LruMap<ObservedTopicStats> observed_topics_;
   bool observed_topics_loaded_ = false;
+  // Message counts changed since the topics file was last queued.
+  bool observed_topics_dirty_ = false;
+  vc::util::WriteBehindFile observed_topics_file_;
+  vc::util::WriteBehindFile metrics_file_;
 };
 
 }  // namespace chime
@@ -0,0 +1,72 @@
+#ifndef CHIME_OBSERVED_TOPICS_H
+#define CHIME_OBSERVED_TOPICS_H
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+#include "vc/config/kv_config.h"
+
+namespace chime {
+
+// What chime knows about a topic it has received messages on. Shared with
+// chime-webd through observed_topics_path.
+struct ObservedTopicStats {
+    std::time_t first_seen = 0;
+    std::time_t last_seen = 0;
+    unsigned long long messages = 0;
+};
+
+// One line of the observed topics file, most recently seen topic first:
+// "<topic>\t<first_seen>\t<last_seen>\t<messages>". Appends to `out`.
+inline void AppendObservedTopicLine(std::string_view topic, const ObservedTopicStats &stats, std::string *out) {
+    out->append(topic);
+    out->push_back('\t');
+    out->append(std::to_string(static_cast<long long>(stats.first_seen)));
+    out->push_back('\t');
+    out->append(std::to_string(static_cast<long long>(stats.last_seen)));
+    out->push_back('\t');
+    out->append(std::to_string(stats.messages));
+    out->push_back('\n');
+}
+
+// Parses a line written by AppendObservedTopicLine(). Fields are taken from
+// the right, so a topic containing tabs survives; a line without them (the
+// older one-topic-per-line format) is a topic with unknown stats.
+inline bool ParseObservedTopicLine(std::string_view line, std::string *topic, ObservedTopicStats *stats) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
+        line.remove_suffix(1);
+    }
+    *stats = ObservedTopicStats{};
+
+    std::string_view rest = line;
+    long long fields[3] = {};
+    bool parsed = true;
+    for (int i = 2; i >= 0 && parsed; --i) {
+        const auto tab = rest.rfind('\t');
+        if (tab == std::string_view::npos) {
+            parsed = false;
+            break;
+        }
+        const std::string number(rest.substr(tab + 1));
+        char *end = nullptr;
+        fields[i] = std::strtoll(number.c_str(), &end, 10);
+        parsed = !number.empty() && end != nullptr && *end == '\0' && fields[i] >= 0;
+        rest = rest.substr(0, tab);
+    }
+
+    if (parsed) {
+        stats->first_seen = static_cast<std::time_t>(fields[0]);
+        stats->last_seen = static_cast<std::time_t>(fields[1]);
+        stats->messages = static_cast<unsigned long long>(fields[2]);
+        *topic = std::string(rest);
+    } else {
+        *topic = vc::config::trim(line);
+    }
+    return !topic->empty();
+}
+
+} // namespace chime
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef CHIME_PCM_CONVERT_H
+#define CHIME_PCM_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace chime {
+
+struct CachedSound;
+
+// Layout every cached sound is converted to: interleaved signed 16-bit PCM at
+// the output device's native rate and channel count. With all sounds in one
+// format the mixer never waits for a device reconfiguration and ALSA's plug
+// layer has nothing left to convert at play time.
+struct PcmOutputFormat {
+    uint16_t channels = 2;
+    uint32_t sample_rate = 48000;
+};
+
+enum class PcmEncoding { kU8, kS16, kS24, kS32, kFloat32, kFloat64 };
+
+// Maps a WAV fmt chunk (format tag after resolving WAVE_FORMAT_EXTENSIBLE,
+// and bytes per sample taken from block_align) to an encoding.
+std::optional<PcmEncoding> PcmEncodingOf(uint16_t audio_format, uint16_t bytes_per_sample);
+
+// Interleaved little-endian input frames.
+struct PcmSource {
+    const uint8_t *data = nullptr;
+    std::size_t frames = 0;
+    uint16_t channels = 0;
+    uint32_t sample_rate = 0;
+    PcmEncoding encoding = PcmEncoding::kS16;
+};
+
+// Converts `source` into `target` and stores it in `sound`. Channels are
+// remapped first (mono is duplicated, extra channels are averaged down), then
+// the rate is changed with a Kaiser-windowed sinc polyphase filter whose
+// cutoff sits just below the lower of the two Nyquist frequencies. Meant for
+// load time only: it allocates and works in floating point.
+bool ConvertPcm(const PcmSource &source, const PcmOutputFormat &target, CachedSound *sound, std::string *error);
+
+} // namespace chime
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef CHIME_PCM_DSP_H
+#define CHIME_PCM_DSP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chime {
+
+// Q15 gain of 1.0. Gains are kept in an int32_t so unity is representable.
+constexpr int32_t kQ15Unity = 1 << 15;
+
+// Converts a 0..100 volume into a Q15 gain (out-of-range values are clamped).
+int32_t GainQ15FromPercent(int volume_percent);
+
+// Sample kernels. Gains must be in [0, kQ15Unity]; every kernel rounds to
+// nearest and saturates exactly like the scalar reference, so vectorized
+// variants are bit-exact with it. u8 samples are offset binary (128 = silence).
+struct PcmKernels {
+    const char *name;
+    // samples[i] = sat(samples[i] * gain)
+    void (*gain_s16)(int16_t *samples, std::size_t count, int32_t gain_q15);
+    void (*gain_u8)(uint8_t *samples, std::size_t count, int32_t gain_q15);
+    // dst[i] = sat(dst[i] + src[i] * gain)
+    void (*mix_s16)(int16_t *dst, const int16_t *src, std::size_t count, int32_t gain_q15);
+    void (*mix_u8)(uint8_t *dst, const uint8_t *src, std::size_t count, int32_t gain_q15);
+    // acc[i] += src[i] * gain, without saturating; sum voices here and
+    // saturate once with saturate_s32_to_s16.
+    void (*accumulate_s16)(int32_t *acc, const int16_t *src, std::size_t count, int32_t gain_q15);
+    // dst[i] = sat(src[i])
+    void (*saturate_s32_to_s16)(const int32_t *src, int16_t *dst, std::size_t count);
+};
+
+// Portable reference implementation.
+const PcmKernels &ScalarPcmKernels();
+
+// Fastest variant for this build and CPU: NEON when compiled for it, AVX2 when
+// the host CPU reports it at runtime, SSE2 on other x86-64 hosts, otherwise
+// the scalar reference.
+const PcmKernels &ActivePcmKernels();
+
+// Every variant compiled into this build that the host CPU can run, scalar
+// reference first. Used to check each of them against the reference.
+std::vector<const PcmKernels *> SupportedPcmKernels();
+
+// Applies a Q15 gain in place to 8-bit unsigned or 16-bit signed little-endian
+// PCM using the active kernels. Meant to run per output chunk so volume
+// scaling never needs a second copy of the whole sound. Returns false for any
+// other bit depth.
+bool ApplyGainQ15(uint8_t *samples, std::size_t size, uint16_t bits_per_sample, int32_t gain_q15);
+
+} // namespace chime
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef CHIME_RING_DEDUP_H
+#define CHIME_RING_DEDUP_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace chime {
+
+// Drops repeats of a ring: bell buttons and Zigbee bridges publish the same
+// message two or three times in a burst, and QoS 1 redelivers after a
+// reconnect. Recent rings are remembered as (topic, payload) hashes in a
+// fixed ring buffer, so checking a message never allocates; the window is
+// counted from the first copy, so a steady repeat still rings once per
+// window.
+class RingDeduplicator {
+  public:
+    static constexpr std::size_t kCapacity = 32;
+
+    // A zero window disables de-duplication.
+    explicit RingDeduplicator(std::chrono::milliseconds window);
+
+    // True if the same topic and payload was accepted less than one window
+    // before `now`; otherwise remembers this ring and returns false.
+    bool IsDuplicate(std::string_view topic, std::string_view payload, std::chrono::steady_clock::time_point now);
+
+    unsigned long long hits() const { return hits_; }
+    unsigned long long misses() const { return misses_; }
+
+  private:
+    struct Entry {
+        uint64_t key = 0;
+        std::chrono::steady_clock::time_point accepted;
+    };
+
+    std::chrono::milliseconds window_;
+    std::array<Entry, kCapacity> entries_{};
+    std::size_t next_ = 0;
+    std::size_t used_ = 0;
+    unsigned long long hits_ = 0;
+    unsigned long long misses_ = 0;
+};
+
+} // namespace chime
+
+#endif
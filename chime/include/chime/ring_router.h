@@ -0,0 +1,52 @@
+#ifndef CHIME_RING_ROUTER_H
+#define CHIME_RING_ROUTER_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "vc/mqtt/topic_matcher.h"
+
+namespace chime {
+
+struct ChimeConfig;
+
+// Compiled form of ChimeConfig::ring_routes. Every route's topic filter goes
+// into one topic trie, so finding the route for a message costs the same
+// with four routes as with four hundred, and does not allocate.
+class RingRouter {
+  public:
+    struct Route {
+        std::string topic_filter;
+        // Resolved against ring_sounds_dir.
+        std::string sound_path;
+        int volume = 0;
+        int priority = 0;
+        std::chrono::milliseconds cooldown{0};
+    };
+
+    // Compiles config.ring_routes, or a single route from ring_topic,
+    // sound_path and volume_bell when the table is empty. Routes with an
+    // invalid filter are skipped and described in `errors`.
+    void Build(const ChimeConfig &config, std::vector<std::string> *errors);
+
+    // Highest priority route matching `topic`; earlier routes win ties.
+    const Route *Match(std::string_view topic) const;
+
+    // Records that `route` fires at `now`; false while it is still in its
+    // cooldown from the last time.
+    bool Admit(const Route &route, std::chrono::steady_clock::time_point now);
+
+    const std::vector<Route> &routes() const { return routes_; }
+
+  private:
+    std::vector<Route> routes_;
+    std::vector<std::chrono::steady_clock::time_point> last_fired_;
+    vc::mqtt::TopicMatcher matcher_;
+};
+
+} // namespace chime
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef CHIME_SOUND_CACHE_H
+#define CHIME_SOUND_CACHE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "chime/pcm_convert.h"
+
+namespace vc::logging {
+class Logger;
+}
+
+namespace chime {
+
+// Heap buffer whose start is aligned for vector loads. The allocation is
+// rounded up to a whole number of alignment blocks (zero filled), so kernels
+// may read a full block past the last sample.
+class AlignedPcmBuffer {
+  public:
+    static constexpr std::size_t kAlignment = 64;
+
+    AlignedPcmBuffer() = default;
+    explicit AlignedPcmBuffer(std::size_t size);
+
+    uint8_t *data() { return data_.get(); }
+    const uint8_t *data() const { return data_.get(); }
+    std::size_t size() const { return size_; }
+
+  private:
+    struct Deleter {
+        void operator()(uint8_t *ptr) const;
+    };
+
+    std::unique_ptr<uint8_t[], Deleter> data_;
+    std::size_t size_ = 0;
+};
+
+struct CachedSound {
+    std::string path;
+    int64_t mtime = 0;
+    uint64_t file_size = 0;
+    uint16_t channels = 0;
+    uint32_t sample_rate = 0;
+    uint16_t bits_per_sample = 0;
+    uint16_t block_align = 0;
+    AlignedPcmBuffer samples;
+    // The file's own format before conversion, for logs.
+    std::string source_format;
+
+    std::size_t frames() const { return block_align == 0 ? 0 : samples.size() / block_align; }
+};
+
+// Reads a sound file and converts it to `format` (see pcm_convert.h). The
+// container is detected from the file's magic bytes rather than its name: WAV
+// (8/16/24/32-bit integer or 32/64-bit float PCM), FLAC, or Ogg Opus (see
+// sound_decoders.h).
+bool LoadSoundFile(const std::string &path, const PcmOutputFormat &format, CachedSound *sound, std::string *error);
+
+// Copies interleaved signed 16-bit samples into `sound` and sets its format
+// fields. Used by the decoders.
+void AssignPcm16(const std::vector<int16_t> &samples, uint16_t channels, uint32_t sample_rate, CachedSound *sound);
+
+// Memory-resident PCM for every sound the chime may play. Files are read and
+// validated once; Find() never touches the filesystem, so the ring path does
+// no disk I/O. Every sound is converted to one output format when it is
+// loaded, so playback never resamples or reconfigures the device between
+// sounds.
+//
+// Preload() and PreloadDirectory() load synchronously at startup. After that,
+// Refresh() only re-stats preloaded paths and directories and hands any file
+// whose mtime or size changed (for example after chime-webd activates a new
+// ring sound) to the cache's loader thread. The loader decodes and converts
+// it and swaps the new sound in under the lock; Find() returns the previous
+// version until then. Preload, PreloadDirectory and Refresh are meant for a
+// single thread (the service loop).
+class SoundCache {
+  public:
+    using LoadCallback = std::function<void(std::shared_ptr<const CachedSound>)>;
+
+    SoundCache(vc::logging::Logger &logger, const PcmOutputFormat &output_format);
+    ~SoundCache();
+
+    SoundCache(const SoundCache &) = delete;
+    SoundCache &operator=(const SoundCache &) = delete;
+
+    void Preload(const std::vector<std::string> &paths);
+    void PreloadDirectory(const std::string &directory);
+    void Refresh();
+
+    std::shared_ptr<const CachedSound> Find(const std::string &path) const;
+    // Loads `path` on the loader thread if it is not cached yet, then calls
+    // `done` there with the sound, or nullptr if it cannot be loaded. Jobs
+    // still queued when the cache is destroyed are dropped.
+    void LoadAsync(const std::string &path, LoadCallback done);
+
+    std::size_t Count() const;
+    std::size_t TotalBytes() const;
+    const PcmOutputFormat &output_format() const { return output_format_; }
+
+  private:
+    using Stamp = std::pair<int64_t, uint64_t>;
+
+    struct LoadJob {
+        std::string path;
+        // Empty for refresh jobs.
+        LoadCallback done;
+    };
+
+    bool NeedsLoad(const std::string &path, Stamp *stamp);
+    bool Load(const std::string &path, const Stamp &stamp);
+    bool LoadIfChanged(const std::string &path);
+    std::vector<std::string> ListDirectory(const std::string &directory) const;
+    void QueueRefresh(const std::string &path);
+    void LoaderLoop();
+
+    vc::logging::Logger &logger_;
+    const PcmOutputFormat output_format_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const CachedSound>> sounds_;
+    std::unordered_map<std::string, Stamp> rejected_stamps_;
+    // Service-loop state.
+    std::vector<std::string> watched_paths_;
+    std::vector<std::string> directories_;
+
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_cv_;
+    std::deque<LoadJob> jobs_;
+    std::unordered_set<std::string> queued_refreshes_;
+    bool stopping_ = false;
+    std::thread loader_thread_;
+};
+
+} // namespace chime
+
+#endif
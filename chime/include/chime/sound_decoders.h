@@ -0,0 +1,30 @@
+#ifndef CHIME_SOUND_DECODERS_H
+#define CHIME_SOUND_DECODERS_H
+
+#include <cstdint>
+#include <string>
+
+namespace chime {
+
+struct CachedSound;
+
+// Longest compressed sound that will be decoded into the cache. Ring sounds
+// are a few seconds; this only stops a bad upload from exhausting memory.
+constexpr uint32_t kMaxDecodedSeconds = 60;
+
+// Decoders for compressed ring sounds. Each fills `sound` with interleaved
+// signed 16-bit PCM. They only run when the sound cache (re)loads a file, so
+// a compressed sound costs the same as a WAV once it is cached. Builds
+// without the decoder library report false from *Available() and fail to
+// decode with an error saying so.
+bool FlacDecoderAvailable();
+bool DecodeFlacFile(const std::string &path, CachedSound *sound, std::string *error);
+
+// Ogg Opus always decodes at 48 kHz; streams with more than two channels are
+// downmixed to stereo.
+bool OpusDecoderAvailable();
+bool DecodeOpusFile(const std::string &path, CachedSound *sound, std::string *error);
+
+} // namespace chime
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef CHIME_VOLUME_CONTROL_H
+#define CHIME_VOLUME_CONTROL_H
+
+#include <string>
+
+namespace vc::logging {
+class Logger;
+}
+
+namespace chime {
+
+// Hardware playback volume through the ALSA simple-mixer API. Open() finds
+// the control once (known names first, then any element with a playback
+// volume) and keeps the mixer handle open, so SetPercent() is a direct
+// snd_mixer call rather than an amixer process per attempt.
+class VolumeControl {
+  public:
+    VolumeControl(vc::logging::Logger &logger, std::string card);
+    ~VolumeControl();
+
+    VolumeControl(const VolumeControl &) = delete;
+    VolumeControl &operator=(const VolumeControl &) = delete;
+
+    // False when the binary was built without libasound.
+    static bool Available();
+
+    bool Open();
+    bool SetPercent(int percent);
+
+    // Name of the chosen control; empty when none was found.
+    const std::string &control_name() const { return control_name_; }
+
+  private:
+    void Close();
+
+    vc::logging::Logger &logger_;
+    std::string card_;
+    std::string control_name_;
+    void *mixer_ = nullptr;
+    void *element_ = nullptr;
+};
+
+} // namespace chime
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef CHIME_WAV_H
+#define CHIME_WAV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chime {
+
+struct WavInfo {
+    // Format tag (1 = PCM, 3 = IEEE float); WAVE_FORMAT_EXTENSIBLE is resolved
+    // to the tag of its SubFormat.
+    uint16_t audio_format = 0;
+    uint16_t channels = 0;
+    uint32_t sample_rate = 0;
+    uint16_t bits_per_sample = 0;
+    uint16_t block_align = 0;
+    std::size_t data_offset = 0;
+    std::size_t data_size = 0;
+};
+
+// Walks the RIFF chunk list and locates the fmt and data chunks. Only validates
+// structure; callers decide which encodings they can play.
+bool ParseWavHeader(const std::vector<uint8_t> &wav_bytes, WavInfo *info, std::string *error);
+
+bool ReadWavFile(const std::string &path, std::vector<uint8_t> *wav_bytes, WavInfo *info, std::string *error);
+
+// Canonical 44-byte PCM header for a data chunk of data_size bytes.
+std::vector<uint8_t> BuildWavHeader(uint16_t channels, uint32_t sample_rate, uint16_t bits_per_sample,
+                                    std::size_t data_size);
+
+} // namespace chime
+
+#endif
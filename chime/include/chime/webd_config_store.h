@@ -1,6 +1,7 @@
 #ifndef CHIME_WEBD_CONFIG_STORE_H
 #define CHIME_WEBD_CONFIG_STORE_H
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -35,6 +36,9 @@ class ConfigStore {
   vc::logging::Logger& logger_;
   std::string chime_config_path_;
   std::string wpa_supplicant_path_;
+  // Web server workers may load and save at the same time; a save rewrites
+  // both files, so neither may be read halfway through it.
+  mutable std::mutex mutex_;
 };
 
 }  // namespace chime::webd
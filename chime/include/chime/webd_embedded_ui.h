@@ -0,0 +1,33 @@
+#ifndef CHIME_WEBD_EMBEDDED_UI_H
+#define CHIME_WEBD_EMBEDDED_UI_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "chime/webd_ui_asset_cache.h"
+
+namespace chime::webd {
+
+// The web UI build compiled into chime-webd by chime-webd-embed-ui. The
+// table is generated at build time and empty when no build was available.
+
+// FNV-1a over the path, started from `seed`. The generator picks the seed
+// under which every embedded path gets its own slot, so a lookup hashes
+// once and compares one path.
+constexpr uint32_t EmbeddedUiPathHash(std::string_view path, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (const char c : path) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Asset for a request path such as "/assets/app.js"; "/" is index.html.
+const UiAsset *FindEmbeddedUiAsset(std::string_view request_path);
+std::size_t EmbeddedUiAssetCount();
+
+} // namespace chime::webd
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef CHIME_WEBD_HTTP_REQUEST_H
+#define CHIME_WEBD_HTTP_REQUEST_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+namespace chime::webd {
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::string body;
+    std::string content_type;
+    bool has_content_type = false;
+    // HTTP/1.1 unless "Connection: close", HTTP/1.0 only with
+    // "Connection: keep-alive".
+    bool keep_alive = false;
+    std::string accept_encoding;
+    std::string if_none_match;
+};
+
+// Reads up to `size` bytes of the connection into `data` and returns how
+// many it read; zero or less once the peer has closed it or it failed.
+using HttpReadFunction = std::function<int(char *data, int size)>;
+
+// Parses one request from `buffered` plus whatever more it needs to `read`,
+// leaving bytes of any following request in `buffered`. Fails once
+// `deadline` passes, however steadily the client trickles in, and leaves
+// `error` empty if the client closed the connection before sending
+// anything.
+bool ReadHttpRequest(const HttpReadFunction &read, std::chrono::steady_clock::time_point deadline,
+                     std::string *buffered, HttpRequest *request, std::string *error);
+
+} // namespace chime::webd
+
+#endif
@@ -2,11 +2,20 @@
 #define CHIME_WEBD_STRING_UTILS_H
 
 #include <string>
+#include <string_view>
 
 namespace chime::webd {
 
 std::string ToLower(const std::string &value);
 
+// Whether an Accept-Encoding header allows `coding`, explicitly or through
+// "*"; a q-value of zero rules it out.
+bool AcceptsEncoding(const std::string &header, const std::string &coding);
+
+// Whether an If-None-Match list names `etag` or is "*". Weak validators
+// compare equal to strong ones here (RFC 9110 weak comparison).
+bool EtagListMatches(const std::string &header, std::string_view etag);
+
 } // namespace chime::webd
 
 #endif
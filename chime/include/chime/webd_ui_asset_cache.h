@@ -0,0 +1,92 @@
+#ifndef CHIME_WEBD_UI_ASSET_CACHE_H
+#define CHIME_WEBD_UI_ASSET_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace chime::webd {
+
+struct UiAssetVariant {
+    // Empty for a compressed variant the asset does not have.
+    std::string_view body;
+    std::string_view etag;
+};
+
+// One web UI file with its headers decided up front. The views point into
+// a UiAssetCache or into the table embedded at build time.
+struct UiAsset {
+    std::string_view path;
+    std::string_view content_type;
+    std::string_view cache_control;
+    UiAssetVariant identity;
+    UiAssetVariant gzip;
+    UiAssetVariant brotli;
+};
+
+// How to answer one request for an asset: the best variant the client
+// accepts, and whether its If-None-Match already names any encoding of the
+// same bytes.
+struct UiAssetChoice {
+    const UiAssetVariant *variant = nullptr;
+    // Empty for identity.
+    std::string_view content_encoding;
+    bool vary_accept_encoding = false;
+    bool not_modified = false;
+};
+
+UiAssetChoice ChooseUiAssetVariant(const UiAsset &asset, const std::string &accept_encoding,
+                                   const std::string &if_none_match);
+
+// Files of a web UI build directory, read once with their headers decided
+// up front, so serving an asset never touches the filesystem. Compressible
+// assets also keep a gzip copy, and a brotli copy when the directory ships
+// a precompressed `<file>.br` next to the file.
+class UiAssetCache {
+  public:
+    struct Totals {
+        std::size_t files = 0;
+        std::size_t identity_bytes = 0;
+        std::size_t gzip_bytes = 0;
+        std::size_t brotli_bytes = 0;
+    };
+
+    UiAssetCache() = default;
+    UiAssetCache(const UiAssetCache &) = delete;
+    UiAssetCache &operator=(const UiAssetCache &) = delete;
+
+    // Replaces the cache with the files under `dist_dir`; a missing
+    // directory leaves it empty. Fails, also leaving it empty, if a file
+    // cannot be read.
+    bool Load(const std::string &dist_dir, std::string *error);
+
+    bool empty() const { return entries_.empty(); }
+    Totals totals() const { return totals_; }
+
+    // Asset for a request path such as "/assets/app.js"; "/" is index.html.
+    const UiAsset *Find(std::string_view request_path) const;
+    void ForEach(const std::function<void(const UiAsset &)> &visit) const;
+
+  private:
+    // Owns the bytes `asset` points at; map nodes never move.
+    struct Entry {
+        std::string content_type;
+        std::string cache_control;
+        std::string identity;
+        std::string gzip;
+        std::string brotli;
+        std::string identity_etag;
+        std::string gzip_etag;
+        std::string brotli_etag;
+        UiAsset asset;
+    };
+
+    std::unordered_map<std::string, Entry> entries_;
+    Totals totals_;
+};
+
+} // namespace chime::webd
+
+#endif
@@ -2,11 +2,19 @@
 #define CHIME_WEBD_WEB_SERVER_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
+#include "chime/webd_http_request.h"
 #include "chime/webd_types.h"
+#include "chime/webd_ui_asset_cache.h"
 
 namespace vc::logging {
 class Logger;
@@ -18,12 +26,20 @@ class ApplyManager;
 class ConfigStore;
 class WifiScanner;
 
+// Key of the self-signed certificate generated when none exists. P-256
+// handshakes cost the device a fraction of an RSA-2048 signature.
+enum class TlsKeyType {
+    kRsa2048,
+    kEcdsaP256,
+};
+
 class WebServer {
   public:
     WebServer(vc::logging::Logger &logger, ConfigStore &config_store, WifiScanner &wifi_scanner,
               ApplyManager &apply_manager, std::string bind_address, int port, std::string cert_path,
-              std::string key_path, std::string ui_dist_dir, std::string observed_topics_path,
-              std::string ring_sounds_dir, std::string active_ring_sound_path);
+              std::string key_path, TlsKeyType tls_key_type, std::string ui_dist_dir, std::string observed_topics_path,
+              std::string ring_sounds_dir, std::string active_ring_sound_path, std::string metrics_path,
+              std::string stats_segment_path);
     ~WebServer();
 
     WebServer(const WebServer &) = delete;
@@ -33,24 +49,26 @@ class WebServer {
     void Stop();
 
   private:
-    struct HttpRequest {
-        std::string method;
-        std::string path;
-        std::string body;
-        std::string content_type;
-        bool has_content_type = false;
-    };
-
     struct HttpResponse {
         int status = 500;
         std::string content_type = "application/json; charset=utf-8";
         std::string cache_control = "no-store";
         std::string body = "{\"error\":\"internal\"}";
+        std::string content_encoding;
+        std::string etag;
+        std::string vary;
+        // Sent instead of `body` when set; points into ui_assets_, which
+        // does not change while connections are served, or into the
+        // embedded UI.
+        std::optional<std::string_view> cached_body;
     };
 
     void AcceptLoop();
+    void WorkerLoop();
     void HandleConnection(int client_fd);
-    bool ReadHttpRequest(void *ssl, HttpRequest *request, std::string *error) const;
+    // Waits for the next request on a kept-alive connection; false once it
+    // has been idle too long or its worker is needed elsewhere.
+    bool WaitForNextRequest(void *ssl, int client_fd, const std::string &buffered);
     HttpResponse Route(const HttpRequest &request);
 
     HttpResponse HandleGetCoreConfig();
@@ -58,11 +76,16 @@ class WebServer {
     HttpResponse HandleWifiScan();
     HttpResponse HandleGetSystemVersion();
     HttpResponse HandleGetObservedTopics();
+    HttpResponse HandleGetMetrics();
+    HttpResponse HandleGetPrometheusMetrics();
     HttpResponse HandleGetRingSounds();
     HttpResponse HandleUploadRingSound(const HttpRequest &request);
     HttpResponse HandleSelectRingSound(const HttpRequest &request);
     HttpResponse ReservedNotImplemented(const std::string &path) const;
-    std::optional<HttpResponse> TryServeExternalUi(const HttpRequest &request) const;
+    // The UI from ui_dist_dir_ when that is set and loaded, otherwise the
+    // one embedded at build time.
+    const UiAsset *FindUiAsset(std::string_view request_path) const;
+    std::optional<HttpResponse> TryServeUi(const HttpRequest &request) const;
 
     bool EnsureTlsMaterial(std::string *error) const;
 
@@ -75,15 +98,32 @@ class WebServer {
     int port_ = 8443;
     std::string cert_path_;
     std::string key_path_;
+    TlsKeyType tls_key_type_ = TlsKeyType::kRsa2048;
     std::string ui_dist_dir_;
+    // Loaded from ui_dist_dir_ by Start(); read-only while serving. Empty
+    // unless a directory overrides the embedded UI.
+    UiAssetCache ui_assets_;
     std::string observed_topics_path_;
     std::string ring_sounds_dir_;
     std::string active_ring_sound_path_;
+    std::string metrics_path_;
+    std::string stats_segment_path_;
 
     std::atomic<bool> running_{false};
     int listen_fd_ = -1;
     void *ssl_ctx_ = nullptr;
     std::thread accept_thread_;
+
+    // Accepted sockets waiting for a worker. Connections are handled by a
+    // fixed pool so one slow client or a long Wi-Fi scan does not hold up
+    // the others.
+    std::mutex connections_mutex_;
+    std::condition_variable connections_ready_;
+    std::deque<int> pending_connections_;
+    std::vector<std::thread> workers_;
+    // Ring sound files are listed, replaced and selected by several
+    // handlers.
+    std::mutex ring_sounds_mutex_;
 };
 
 } // namespace chime::webd
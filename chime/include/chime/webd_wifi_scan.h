@@ -1,6 +1,7 @@
 #ifndef CHIME_WEBD_WIFI_SCAN_H
 #define CHIME_WEBD_WIFI_SCAN_H
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -26,6 +27,8 @@ class WifiScanner {
  public:
   WifiScanner(vc::logging::Logger& logger, std::string interface_name);
 
+  // Concurrent callers wait for the scan in progress and then run their
+  // own; wpa_cli keeps one set of scan results per interface.
   WifiScanResult Scan() const;
 
  private:
@@ -34,6 +37,7 @@ class WifiScanner {
 
   vc::logging::Logger& logger_;
   std::string interface_name_;
+  mutable std::mutex scan_mutex_;
 };
 
 }  // namespace chime::webd
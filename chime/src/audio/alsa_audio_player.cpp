@@ -0,0 +1,141 @@
+#include "chime/audio_player.h"
+
+#include <alsa/asoundlib.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "chime/audio_engine.h"
+#include "chime/sound_cache.h"
+#include "vc/logging/logger.h"
+
+namespace chime {
+namespace {
+
+// Kept short because a ring that arrives mid-sound is mixed into the stream
+// behind whatever is already buffered.
+constexpr unsigned int kPcmLatencyUs = 50000;
+
+class AlsaPcmSink final : public PcmSink {
+  public:
+    explicit AlsaPcmSink(std::string device_name) : device_name_(std::move(device_name)) {}
+    ~AlsaPcmSink() override { Close(); }
+
+    const std::string &Name() const override { return device_name_; }
+
+    bool Configure(const MixerFormat &format, AudioMixer &mixer) override {
+        if (pcm_ == nullptr) {
+            const int open_rc = snd_pcm_open(&pcm_, device_name_.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+            if (open_rc < 0) {
+                pcm_ = nullptr;
+                return Fail(mixer, "snd_pcm_open", open_rc);
+            }
+            configured_ = MixerFormat{};
+            mixer.PostEvent({MixerEvent::Type::kDeviceOpened});
+        }
+
+        if (!(configured_ == format)) {
+            const snd_pcm_format_t sample_format =
+                format.bits_per_sample == 8 ? SND_PCM_FORMAT_U8 : SND_PCM_FORMAT_S16_LE;
+            const int params_rc = snd_pcm_set_params(pcm_, sample_format, SND_PCM_ACCESS_RW_INTERLEAVED,
+                                                     format.channels, format.sample_rate, 1, kPcmLatencyUs);
+            if (params_rc < 0) {
+                return Fail(mixer, "snd_pcm_set_params", params_rc);
+            }
+            configured_ = format;
+            MixerEvent configured{MixerEvent::Type::kDeviceConfigured};
+            configured.value = format.sample_rate;
+            configured.code = format.channels;
+            mixer.PostEvent(configured);
+        }
+
+        const int prepare_rc = snd_pcm_prepare(pcm_);
+        if (prepare_rc < 0) {
+            return Fail(mixer, "snd_pcm_prepare", prepare_rc);
+        }
+        return true;
+    }
+
+    bool Write(const uint8_t *data, std::size_t frames, AudioMixer &mixer) override {
+        const std::size_t frame_bytes =
+            static_cast<std::size_t>(configured_.channels) * configured_.bits_per_sample / 8;
+        while (frames > 0) {
+            const snd_pcm_sframes_t written = snd_pcm_writei(pcm_, data, static_cast<snd_pcm_uframes_t>(frames));
+            if (written < 0) {
+                if (written == -EPIPE) {
+                    mixer.PostEvent({MixerEvent::Type::kUnderrun});
+                }
+                const int recovered = snd_pcm_recover(pcm_, static_cast<int>(written), 1);
+                if (recovered < 0) {
+                    return Fail(mixer, "snd_pcm_writei", recovered);
+                }
+                continue;
+            }
+            data += static_cast<std::size_t>(written) * frame_bytes;
+            frames -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    void Drain() override {
+        if (pcm_ != nullptr) {
+            snd_pcm_drain(pcm_);
+        }
+    }
+
+    void Drop() override {
+        if (pcm_ != nullptr) {
+            snd_pcm_drop(pcm_);
+        }
+    }
+
+    void Close() override {
+        if (pcm_ == nullptr) {
+            return;
+        }
+        snd_pcm_close(pcm_);
+        pcm_ = nullptr;
+        configured_ = MixerFormat{};
+    }
+
+  private:
+    bool Fail(AudioMixer &mixer, const char *what, int code) {
+        MixerEvent error{MixerEvent::Type::kDeviceError};
+        error.code = code;
+        error.what = what;
+        mixer.PostEvent(error);
+        Close();
+        return false;
+    }
+
+    std::string device_name_;
+    snd_pcm_t *pcm_ = nullptr;
+    MixerFormat configured_;
+};
+
+} // namespace
+
+AlsaAudioPlayer::AlsaAudioPlayer(vc::logging::Logger &logger, SoundCache &sounds, std::string device_name,
+                                 const MixerPolicy &policy, int realtime_priority, vc::metrics::Registry &metrics)
+    : logger_(logger), device_name_(std::move(device_name)),
+      engine_(std::make_unique<AudioEngine>(logger, sounds, policy, std::make_unique<AlsaPcmSink>(device_name_),
+                                            realtime_priority, metrics)) {}
+
+AlsaAudioPlayer::~AlsaAudioPlayer() = default;
+
+bool AlsaAudioPlayer::Available() {
+    return true;
+}
+
+void AlsaAudioPlayer::Play(const std::string &path, int volume_percent, SoundCategory category) {
+    engine_->Play(path, volume_percent, category);
+}
+
+bool AlsaAudioPlayer::IsPlaying() const {
+    return engine_->IsPlaying();
+}
+
+} // namespace chime
@@ -0,0 +1,30 @@
+#include "chime/audio_player.h"
+
+#include <utility>
+
+#include "chime/audio_engine.h"
+#include "chime/sound_cache.h"
+#include "vc/logging/logger.h"
+
+namespace chime {
+
+AlsaAudioPlayer::AlsaAudioPlayer(vc::logging::Logger &logger, SoundCache &, std::string device_name,
+                                 const MixerPolicy &, int, vc::metrics::Registry &)
+    : logger_(logger), device_name_(std::move(device_name)) {}
+
+AlsaAudioPlayer::~AlsaAudioPlayer() = default;
+
+bool AlsaAudioPlayer::Available() {
+    return false;
+}
+
+void AlsaAudioPlayer::Play(const std::string &path, int volume_percent, SoundCategory category) {
+    logger_.Info("audio", "(alsa unavailable) would play '" + path + "' volume=" + std::to_string(volume_percent) +
+                              "% as " + SoundCategoryName(category) + " on '" + device_name_ + "'");
+}
+
+bool AlsaAudioPlayer::IsPlaying() const {
+    return false;
+}
+
+} // namespace chime
@@ -0,0 +1,136 @@
+#include "chime/volume_control.h"
+
+#include <alsa/asoundlib.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <utility>
+
+#include "vc/logging/logger.h"
+
+namespace chime {
+namespace {
+
+constexpr std::array<const char *, 7> kControlCandidates = {
+    "PCM", "Speaker", "Master", "Digital", "Playback", "DAC", "Headphone",
+};
+
+snd_mixer_t *AsMixer(void *handle) {
+    return static_cast<snd_mixer_t *>(handle);
+}
+
+snd_mixer_elem_t *AsElement(void *handle) {
+    return static_cast<snd_mixer_elem_t *>(handle);
+}
+
+bool IsUsable(snd_mixer_elem_t *element) {
+    return element != nullptr && snd_mixer_selem_is_active(element) && snd_mixer_selem_has_playback_volume(element);
+}
+
+snd_mixer_elem_t *FindNamed(snd_mixer_t *mixer, const char *name) {
+    snd_mixer_selem_id_t *id = nullptr;
+    if (snd_mixer_selem_id_malloc(&id) < 0) {
+        return nullptr;
+    }
+    snd_mixer_selem_id_set_index(id, 0);
+    snd_mixer_selem_id_set_name(id, name);
+    snd_mixer_elem_t *element = snd_mixer_find_selem(mixer, id);
+    snd_mixer_selem_id_free(id);
+    return IsUsable(element) ? element : nullptr;
+}
+
+} // namespace
+
+VolumeControl::VolumeControl(vc::logging::Logger &logger, std::string card)
+    : logger_(logger), card_(std::move(card)) {}
+
+VolumeControl::~VolumeControl() {
+    Close();
+}
+
+bool VolumeControl::Available() {
+    return true;
+}
+
+bool VolumeControl::Open() {
+    Close();
+
+    snd_mixer_t *mixer = nullptr;
+    int rc = snd_mixer_open(&mixer, 0);
+    if (rc < 0) {
+        logger_.Warn("audio", "snd_mixer_open failed: " + std::string(snd_strerror(rc)));
+        return false;
+    }
+    mixer_ = mixer;
+    rc = snd_mixer_attach(mixer, card_.c_str());
+    if (rc >= 0) {
+        rc = snd_mixer_selem_register(mixer, nullptr, nullptr);
+    }
+    if (rc >= 0) {
+        rc = snd_mixer_load(mixer);
+    }
+    if (rc < 0) {
+        logger_.Warn("audio", "mixer '" + card_ + "' unavailable: " + std::string(snd_strerror(rc)));
+        Close();
+        return false;
+    }
+
+    snd_mixer_elem_t *element = nullptr;
+    for (const char *name : kControlCandidates) {
+        if ((element = FindNamed(mixer, name)) != nullptr) {
+            break;
+        }
+    }
+    if (element == nullptr) {
+        for (snd_mixer_elem_t *candidate = snd_mixer_first_elem(mixer); candidate != nullptr;
+             candidate = snd_mixer_elem_next(candidate)) {
+            if (IsUsable(candidate)) {
+                element = candidate;
+                break;
+            }
+        }
+    }
+    if (element == nullptr) {
+        logger_.Warn("audio", "mixer '" + card_ + "' has no playback volume control");
+        Close();
+        return false;
+    }
+
+    element_ = element;
+    control_name_ = snd_mixer_selem_get_name(element);
+    logger_.Info("audio", "using mixer control '" + control_name_ + "' on '" + card_ + "'");
+    return true;
+}
+
+bool VolumeControl::SetPercent(int percent) {
+    if (element_ == nullptr) {
+        return false;
+    }
+    snd_mixer_elem_t *element = AsElement(element_);
+    long min = 0;
+    long max = 0;
+    snd_mixer_selem_get_playback_volume_range(element, &min, &max);
+    const long value = min + (max - min) * std::clamp(percent, 0, 100) / 100;
+
+    const int rc = snd_mixer_selem_set_playback_volume_all(element, value);
+    if (rc < 0) {
+        logger_.Warn("audio", "setting mixer control '" + control_name_ + "' failed: " + std::string(snd_strerror(rc)));
+        return false;
+    }
+    if (snd_mixer_selem_has_playback_switch(element)) {
+        snd_mixer_selem_set_playback_switch_all(element, percent > 0 ? 1 : 0);
+    }
+    return true;
+}
+
+void VolumeControl::Close() {
+    if (mixer_ != nullptr) {
+        snd_mixer_close(AsMixer(mixer_));
+    }
+    mixer_ = nullptr;
+    element_ = nullptr;
+    control_name_.clear();
+}
+
+} // namespace chime
@@ -0,0 +1,28 @@
+#include "chime/volume_control.h"
+
+#include <utility>
+
+#include "vc/logging/logger.h"
+
+namespace chime {
+
+VolumeControl::VolumeControl(vc::logging::Logger &logger, std::string card)
+    : logger_(logger), card_(std::move(card)) {}
+
+VolumeControl::~VolumeControl() = default;
+
+bool VolumeControl::Available() {
+    return false;
+}
+
+bool VolumeControl::Open() {
+    return false;
+}
+
+bool VolumeControl::SetPercent(int) {
+    return false;
+}
+
+void VolumeControl::Close() {}
+
+} // namespace chime
@@ -1,384 +1,257 @@
 #include "chime/audio_player.h"
 
-#include <algorithm>
-#include <array>
+#include <atomic>
 #include <cerrno>
-#include <chrono>
-#include <cmath>
+#include <csignal>
 #include <cstdint>
-#include <cstdlib>
-#include <exception>
-#include <fstream>
+#include <memory>
 #include <string>
-#include <thread>
 #include <vector>
 
-#include <cstdio>
+#include <fcntl.h>
+#include <sched.h>
+#include <spawn.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include "chime/audio_engine.h"
+#include "chime/sound_cache.h"
+#include "chime/wav.h"
 #include "vc/logging/logger.h"
-#include "vc/util/filesystem.h"
 #include "vc/util/platform.h"
-#include "vc/util/strings.h"
 
 namespace chime {
 namespace {
 
-constexpr std::array<const char *, 9> kMixerControlCandidates = {
-    "PCM",
-    "Speaker",
-    "Master",
-    "Digital",
-    "Playback",
-    "DAC",
-    "Headphone",
-    "PCM Playback Volume",
-    "Digital Playback Volume",
-};
-
-struct MixerSetResult {
-    bool success = false;
-    std::string control_name;
-};
-
-struct PlaybackThreadCleanup {
-    std::string *temporary_scaled_path = nullptr;
-    std::atomic<bool> *playing = nullptr;
-
-    ~PlaybackThreadCleanup() {
-        if (temporary_scaled_path != nullptr && !temporary_scaled_path->empty()) {
-            std::remove(temporary_scaled_path->c_str());
-        }
-        if (playing != nullptr) {
-            playing->store(false);
+// aplay's own buffer, and the pipe feeding it, bound how long a ring that
+// arrives mid-sound waits behind audio that is already queued.
+constexpr const char *kAplayPath = "aplay";
+constexpr const char *kAplayBufferUs = "50000";
+constexpr int kPipeBufferBytes = 4096;
+// Announced as the data size of the streamed WAV; aplay plays until EOF.
+constexpr std::size_t kStreamDataBytes = 0x7FFFF000;
+
+// Streams the mix into an aplay child. Starting and reaping aplay happens on
+// the housekeeping thread, so the render thread never forks: a fork from a
+// SCHED_FIFO thread would copy the whole address space at real-time priority
+// and hand that priority to aplay. The render thread only writes to the pipe,
+// closes it, and waits for the housekeeping thread to start a replacement.
+class AplayPipeSink final : public PcmSink {
+  public:
+    ~AplayPipeSink() override { Close(); }
+
+    const std::string &Name() const override { return name_; }
+
+    // aplay learns the format from the WAV header, so a new format means a
+    // new aplay process.
+    bool Configure(const MixerFormat &format, AudioMixer &mixer) override {
+        if (fd_ >= 0 && configured_ == format) {
+            return true;
         }
-    }
-};
-
-uint16_t ReadLe16(const std::vector<uint8_t> &data, std::size_t offset) {
-    return static_cast<uint16_t>(data[offset]) | (static_cast<uint16_t>(data[offset + 1]) << 8);
-}
-
-uint32_t ReadLe32(const std::vector<uint8_t> &data, std::size_t offset) {
-    return static_cast<uint32_t>(data[offset]) | (static_cast<uint32_t>(data[offset + 1]) << 8) |
-           (static_cast<uint32_t>(data[offset + 2]) << 16) | (static_cast<uint32_t>(data[offset + 3]) << 24);
-}
-
-void WriteLe16(std::vector<uint8_t> *data, std::size_t offset, uint16_t value) {
-    (*data)[offset] = static_cast<uint8_t>(value & 0xFF);
-    (*data)[offset + 1] = static_cast<uint8_t>((value >> 8) & 0xFF);
-}
-
-bool ReadFileBytes(const std::string &path, std::vector<uint8_t> *output) {
-    if (output == nullptr) {
-        return false;
-    }
-    std::ifstream file(path, std::ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
-    output->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
-    return file.good() || file.eof();
-}
-
-bool WriteAllToFileDescriptor(int fd, const std::vector<uint8_t> &data) {
-    const uint8_t *buffer = data.data();
-    std::size_t remaining = data.size();
-    while (remaining > 0) {
-        const ssize_t written = write(fd, buffer, static_cast<size_t>(remaining));
-        if (written < 0) {
-            if (errno == EINTR) {
-                continue;
-            }
-            return false;
+        Retire(false);
+
+        requested_format_ = format;
+        spawn_state_.store(kSpawnRequested, std::memory_order_release);
+        mixer.WakeHousekeeping();
+        int state = kSpawnRequested;
+        while (state == kSpawnRequested) {
+            spawn_state_.wait(kSpawnRequested, std::memory_order_acquire);
+            state = spawn_state_.load(std::memory_order_acquire);
         }
-        if (written == 0) {
-            return false;
+        if (state == kSpawnFailed) {
+            return Fail(mixer, spawn_error_what_, spawn_error_code_);
         }
-        buffer += static_cast<std::size_t>(written);
-        remaining -= static_cast<std::size_t>(written);
+        mixer.PostEvent({MixerEvent::Type::kDeviceOpened});
+
+        configured_ = format;
+        frame_bytes_ = static_cast<std::size_t>(format.channels) * format.bits_per_sample / 8;
+        MixerEvent configured{MixerEvent::Type::kDeviceConfigured};
+        configured.value = format.sample_rate;
+        configured.code = format.channels;
+        mixer.PostEvent(configured);
+        return true;
     }
-    return fsync(fd) == 0;
-}
 
-bool ScalePcmWavInMemory(std::vector<uint8_t> *wav_bytes, int effective_volume, std::string *error) {
-    if (wav_bytes == nullptr) {
-        if (error != nullptr) {
-            *error = "internal error";
+    bool Write(const uint8_t *data, std::size_t frames, AudioMixer &mixer) override {
+        if (!WriteAll(fd_, data, frames * frame_bytes_)) {
+            return Fail(mixer, "write", -errno);
         }
-        return false;
+        return true;
     }
-    if (wav_bytes->size() < 44) {
-        if (error != nullptr) {
-            *error = "wav too small";
-        }
-        return false;
+
+    // Closing the pipe lets aplay play out what it has buffered and exit.
+    void Drain() override { Retire(false); }
+    void Drop() override { Retire(true); }
+
+    // Only called once the render and housekeeping threads have stopped.
+    void Close() override {
+        Retire(true);
+        Reap();
     }
 
-    const std::string riff(reinterpret_cast<const char *>(wav_bytes->data()), 4);
-    const std::string wave(reinterpret_cast<const char *>(wav_bytes->data() + 8), 4);
-    if (riff != "RIFF" || wave != "WAVE") {
-        if (error != nullptr) {
-            *error = "not a RIFF/WAVE file";
+    void Housekeep() override {
+        // The previous aplay has to release the device before the next opens it.
+        Reap();
+        if (spawn_state_.load(std::memory_order_acquire) != kSpawnRequested) {
+            return;
         }
-        return false;
+        const bool spawned = Spawn(requested_format_);
+        spawn_state_.store(spawned ? kSpawned : kSpawnFailed, std::memory_order_release);
+        spawn_state_.notify_all();
     }
 
-    bool have_fmt = false;
-    bool have_data = false;
-    uint16_t audio_format = 0;
-    uint16_t bits_per_sample = 0;
-    std::size_t data_offset = 0;
-    std::size_t data_size = 0;
-
-    std::size_t cursor = 12;
-    while (cursor <= wav_bytes->size() - 8) {
-        const std::size_t chunk_header = cursor;
-        const uint32_t chunk_size = ReadLe32(*wav_bytes, chunk_header + 4);
-        const std::size_t chunk_data = chunk_header + 8;
-        if (static_cast<std::size_t>(chunk_size) > wav_bytes->size() - chunk_data) {
-            if (error != nullptr) {
-                *error = "corrupt wav chunk size";
-            }
-            return false;
-        }
-        const std::size_t chunk_end = chunk_data + static_cast<std::size_t>(chunk_size);
+  private:
+    enum : int { kIdle, kSpawnRequested, kSpawned, kSpawnFailed };
 
-        const std::string chunk_id(reinterpret_cast<const char *>(wav_bytes->data() + chunk_header), 4);
-        if (chunk_id == "fmt ") {
-            if (chunk_size < 16) {
-                if (error != nullptr) {
-                    *error = "invalid fmt chunk";
+    static bool WriteAll(int fd, const uint8_t *data, std::size_t size) {
+        while (size > 0) {
+            const ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
                 }
                 return false;
             }
-            audio_format = ReadLe16(*wav_bytes, chunk_data + 0);
-            bits_per_sample = ReadLe16(*wav_bytes, chunk_data + 14);
-            have_fmt = true;
-        } else if (chunk_id == "data") {
-            data_offset = chunk_data;
-            data_size = static_cast<std::size_t>(chunk_size);
-            have_data = true;
+            data += written;
+            size -= static_cast<std::size_t>(written);
         }
-
-        const std::size_t padding = (chunk_size % 2 == 1) ? 1 : 0;
-        if (padding > wav_bytes->size() - chunk_end) {
-            if (error != nullptr) {
-                *error = "corrupt wav chunk padding";
-            }
-            return false;
-        }
-        cursor = chunk_end + padding;
+        return true;
     }
 
-    if (!have_fmt || !have_data) {
-        if (error != nullptr) {
-            *error = "missing fmt or data chunk";
-        }
-        return false;
-    }
-    if (audio_format != 1) {
-        if (error != nullptr) {
-            *error = "unsupported wav encoding (only PCM supported)";
+    // Housekeeping thread. aplay reads the WAV stream from a pipe on stdin,
+    // runs under SCHED_OTHER with an empty signal mask and default SIGPIPE
+    // handling whatever the spawning thread had, and its stderr is dropped.
+    bool Spawn(const MixerFormat &format) {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0) {
+            return SpawnFailed("pipe", -errno);
         }
-        return false;
-    }
 
-    const double gain = static_cast<double>(effective_volume) / 100.0;
-    if (bits_per_sample == 16) {
-        if (data_size % 2 != 0) {
-            if (error != nullptr) {
-                *error = "invalid 16-bit PCM data size";
-            }
-            return false;
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        sigset_t signals;
+        sigemptyset(&signals);
+        posix_spawnattr_setsigmask(&attr, &signals);
+        sigaddset(&signals, SIGPIPE);
+        posix_spawnattr_setsigdefault(&attr, &signals);
+        sched_param param{};
+        posix_spawnattr_setschedpolicy(&attr, SCHED_OTHER);
+        posix_spawnattr_setschedparam(&attr, &param);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSCHEDULER);
+
+        char *const argv[] = {const_cast<char *>(kAplayPath), const_cast<char *>("-q"), const_cast<char *>("-B"),
+                              const_cast<char *>(kAplayBufferUs), const_cast<char *>("-"), nullptr};
+        pid_t pid = -1;
+        const int rc = posix_spawnp(&pid, kAplayPath, &actions, &attr, argv, environ);
+        posix_spawnattr_destroy(&attr);
+        posix_spawn_file_actions_destroy(&actions);
+        close(fds[0]);
+        if (rc != 0) {
+            close(fds[1]);
+            return SpawnFailed("posix_spawn", -rc);
         }
-        for (std::size_t i = 0; i + 1 < data_size; i += 2) {
-            const std::size_t sample_offset = data_offset + i;
-            const int16_t sample = static_cast<int16_t>(static_cast<uint16_t>((*wav_bytes)[sample_offset]) |
-                                                        (static_cast<uint16_t>((*wav_bytes)[sample_offset + 1]) << 8));
-            const int scaled = static_cast<int>(std::lround(static_cast<double>(sample) * gain));
-            const int clamped = std::clamp(scaled, -32768, 32767);
-            WriteLe16(wav_bytes, sample_offset, static_cast<uint16_t>(static_cast<int16_t>(clamped)));
+#ifdef F_SETPIPE_SZ
+        fcntl(fds[1], F_SETPIPE_SZ, kPipeBufferBytes);
+#endif
+
+        const std::vector<uint8_t> header =
+            BuildWavHeader(format.channels, format.sample_rate, format.bits_per_sample, kStreamDataBytes);
+        if (!WriteAll(fds[1], header.data(), header.size())) {
+            const int code = -errno;
+            close(fds[1]);
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+            return SpawnFailed("write", code);
         }
+        fd_ = fds[1];
+        pid_ = pid;
         return true;
     }
 
-    if (bits_per_sample == 8) {
-        for (std::size_t i = 0; i < data_size; ++i) {
-            const std::size_t sample_offset = data_offset + i;
-            const int centered = static_cast<int>((*wav_bytes)[sample_offset]) - 128;
-            const int scaled = static_cast<int>(std::lround(static_cast<double>(centered) * gain));
-            const int clamped = std::clamp(scaled, -128, 127);
-            (*wav_bytes)[sample_offset] = static_cast<uint8_t>(clamped + 128);
-        }
-        return true;
-    }
-
-    if (error != nullptr) {
-        *error = "unsupported bits_per_sample=" + std::to_string(bits_per_sample);
-    }
-    return false;
-}
-
-bool CreateSoftwareScaledWav(const std::string &source_path, int effective_volume, std::string *output_path,
-                             std::string *error) {
-    if (output_path == nullptr) {
-        if (error != nullptr) {
-            *error = "internal error";
-        }
-        return false;
-    }
-
-    std::vector<uint8_t> wav_bytes;
-    if (!ReadFileBytes(source_path, &wav_bytes)) {
-        if (error != nullptr) {
-            *error = "failed to read source wav";
-        }
-        return false;
-    }
-    if (!ScalePcmWavInMemory(&wav_bytes, effective_volume, error)) {
+    bool SpawnFailed(const char *what, int code) {
+        spawn_error_what_ = what;
+        spawn_error_code_ = code;
         return false;
     }
 
-    char temp_path[] = "/tmp/chime-softvol-XXXXXX";
-    const int fd = mkstemp(temp_path);
-    if (fd < 0) {
-        if (error != nullptr) {
-            *error = "failed to create temp file";
+    // Render thread. Hands the running aplay to the housekeeping thread for
+    // reaping; `stop` also discards whatever it has not played yet.
+    void Retire(bool stop) {
+        if (fd_ < 0) {
+            return;
         }
-        return false;
-    }
-    const bool write_ok = WriteAllToFileDescriptor(fd, wav_bytes);
-    const int close_rc = close(fd);
-    if (!write_ok || close_rc != 0) {
-        std::remove(temp_path);
-        if (error != nullptr) {
-            *error = "failed to write scaled wav";
+        close(fd_);
+        if (stop) {
+            kill(pid_, SIGTERM);
         }
-        return false;
+        retired_pid_.store(pid_, std::memory_order_release);
+        fd_ = -1;
+        pid_ = -1;
+        configured_ = MixerFormat{};
     }
 
-    *output_path = temp_path;
-    return true;
-}
-
-MixerSetResult TrySetVolumeWithAmixer(int effective_volume) {
-    for (const char *control_name : kMixerControlCandidates) {
-        const std::string set_volume_cmd = "amixer -q sset \"" + vc::util::EscapeShellDoubleQuotes(control_name) +
-                                           "\" \"" + std::to_string(effective_volume) + "%\" >/dev/null 2>&1";
-        if (std::system(set_volume_cmd.c_str()) == 0) {
-            return {true, control_name};
+    // Housekeeping thread, or Close() after the threads have stopped.
+    void Reap() {
+        const pid_t pid = retired_pid_.exchange(-1, std::memory_order_acq_rel);
+        if (pid > 0) {
+            while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+            }
         }
     }
-    return {};
-}
 
-std::string MixerCandidatesForLog() {
-    std::string out;
-    for (std::size_t i = 0; i < kMixerControlCandidates.size(); ++i) {
-        if (i > 0) {
-            out += ", ";
-        }
-        out += kMixerControlCandidates[i];
+    bool Fail(AudioMixer &mixer, const char *what, int code) {
+        MixerEvent error{MixerEvent::Type::kDeviceError};
+        error.code = code;
+        error.what = what;
+        mixer.PostEvent(error);
+        Retire(true);
+        return false;
     }
-    return out;
-}
 
-} // namespace
+    std::string name_ = "aplay";
+    // Render-thread state, written by the housekeeping thread only while the
+    // render thread waits on spawn_state_.
+    int fd_ = -1;
+    pid_t pid_ = -1;
+    MixerFormat configured_;
+    std::size_t frame_bytes_ = 0;
+
+    MixerFormat requested_format_;
+    const char *spawn_error_what_ = "";
+    int spawn_error_code_ = 0;
+    std::atomic<int> spawn_state_{kIdle};
+    std::atomic<pid_t> retired_pid_{-1};
+};
 
-AplayAudioPlayer::AplayAudioPlayer(vc::logging::Logger &logger) : logger_(logger) {}
+} // namespace
 
-AplayAudioPlayer::~AplayAudioPlayer() {
-    std::lock_guard<std::mutex> lock(playback_thread_mutex_);
-    if (playback_thread_.joinable()) {
-        playback_thread_.join();
+AplayAudioPlayer::AplayAudioPlayer(vc::logging::Logger &logger, SoundCache &sounds, const MixerPolicy &policy,
+                                   int realtime_priority, vc::metrics::Registry &metrics)
+    : logger_(logger) {
+    if (!vc::util::IsLinux()) {
+        return;
     }
+    engine_ = std::make_unique<AudioEngine>(logger, sounds, policy, std::make_unique<AplayPipeSink>(),
+                                            realtime_priority, metrics);
 }
 
-void AplayAudioPlayer::Play(const std::string &path, int volume_percent) {
-    bool expected = false;
-    if (!playing_.compare_exchange_strong(expected, true)) {
-        logger_.Warn("audio", "already playing, skipping new request");
-        return;
-    }
+AplayAudioPlayer::~AplayAudioPlayer() = default;
 
-    if (!vc::util::IsLinux()) {
+void AplayAudioPlayer::Play(const std::string &path, int volume_percent, SoundCategory category) {
+    if (engine_ == nullptr) {
         logger_.Info("audio", "(local) would play '" + path + "' volume=" + std::to_string(volume_percent) + "%");
-        playing_ = false;
         return;
     }
-
-    if (!vc::util::FileExists(path)) {
-        logger_.Error("audio", "sound file not found: " + path);
-        playing_ = false;
-        return;
-    }
-
-    const int effective_volume = std::clamp(volume_percent, 0, 100);
-    auto *const logger = &logger_;
-    auto *const playing = &playing_;
-
-    std::lock_guard<std::mutex> lock(playback_thread_mutex_);
-    if (playback_thread_.joinable()) {
-        playback_thread_.join();
-    }
-    try {
-        playback_thread_ = std::thread([logger, playing, path, effective_volume]() {
-            std::string temporary_scaled_path;
-            const PlaybackThreadCleanup cleanup{&temporary_scaled_path, playing};
-
-            try {
-                const auto started = std::chrono::steady_clock::now();
-                logger->Info("audio", "playing '" + path + "' at " + std::to_string(effective_volume) + "%");
-
-                const MixerSetResult mixer_result = TrySetVolumeWithAmixer(effective_volume);
-                std::string playback_path = path;
-                if (!mixer_result.success) {
-                    logger->Warn("audio", "failed to set volume via amixer using known controls; ring volume "
-                                          "setting may have no audible effect (tried: " +
-                                              MixerCandidatesForLog() + ")");
-
-                    if (effective_volume < 100) {
-                        std::string scale_error;
-                        if (CreateSoftwareScaledWav(path, effective_volume, &temporary_scaled_path, &scale_error)) {
-                            playback_path = temporary_scaled_path;
-                            logger->Info("audio", "using software-scaled wav fallback at " +
-                                                      std::to_string(effective_volume) + "%");
-                        } else {
-                            logger->Warn("audio", "software volume fallback unavailable: " + scale_error);
-                        }
-                    }
-                } else {
-                    logger->Info("audio", "applied mixer control '" + mixer_result.control_name + "' to " +
-                                              std::to_string(effective_volume) + "%");
-                }
-
-                const std::string cmd =
-                    "aplay -q \"" + vc::util::EscapeShellDoubleQuotes(playback_path) + "\" 2>/dev/null";
-                const int rc = std::system(cmd.c_str());
-
-                const auto elapsed_ms =
-                    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started)
-                        .count();
-                if (rc != 0) {
-                    logger->Error("audio", "aplay failed with code " + std::to_string(rc));
-                } else {
-                    logger->Info("audio", "playback complete in " + std::to_string(elapsed_ms) + "ms");
-                }
-            } catch (const std::exception &error) {
-                logger->Error("audio", "playback thread exception: " + std::string(error.what()));
-            } catch (...) {
-                logger->Error("audio", "playback thread exception: unknown");
-            }
-        });
-    } catch (const std::exception &error) {
-        playing_.store(false);
-        logger_.Error("audio", "failed to start playback thread: " + std::string(error.what()));
-    }
+    engine_->Play(path, volume_percent, category);
 }
 
 bool AplayAudioPlayer::IsPlaying() const {
-    return playing_.load();
+    return engine_ != nullptr && engine_->IsPlaying();
 }
 
 } // namespace chime
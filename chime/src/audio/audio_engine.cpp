@@ -0,0 +1,256 @@
+#include "chime/audio_engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "chime/pcm_dsp.h"
+#include "chime/sound_cache.h"
+#include "vc/logging/logger.h"
+#include "vc/metrics/metrics.h"
+#include "vc/runtime/thread_priority.h"
+
+namespace chime {
+namespace {
+
+// How long the device keeps running on silence after the last voice ends.
+constexpr uint32_t kIdleStreamMs = 500;
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string Describe(SoundCategory category, uint32_t id) {
+    return std::string(SoundCategoryName(category)) + " #" + std::to_string(id);
+}
+
+} // namespace
+
+AudioEngine::AudioEngine(vc::logging::Logger &logger, SoundCache &sounds, const MixerPolicy &policy,
+                         std::unique_ptr<PcmSink> sink, int realtime_priority, vc::metrics::Registry &metrics)
+    : logger_(logger), sounds_(sounds), sink_(std::move(sink)), mixer_(policy),
+      start_latency_us_(metrics.AddHistogram("audio_start_latency_us", "play request to first frame queued",
+                                             {250, 500, 1000, 2500, 5000, 10000, 25000, 100000})),
+      playback_ms_(metrics.AddHistogram("audio_playback_ms", "play request to end of playback",
+                                        {250, 500, 1000, 2000, 5000, 10000, 30000})),
+      producer_(std::make_shared<Producer>()) {
+    producer_->engine = this;
+    render_thread_ = std::thread([this]() { RenderLoop(); });
+    housekeeping_thread_ = std::thread([this]() { HousekeepingLoop(); });
+
+    if (realtime_priority > 0) {
+        std::string error;
+        if (vc::runtime::SetRealtimePriority(render_thread_, realtime_priority, &error)) {
+            logger_.Info("audio", "render thread running SCHED_FIFO priority " + std::to_string(realtime_priority));
+        } else {
+            logger_.Warn("audio", "render thread keeps normal priority: " + error);
+        }
+    }
+}
+
+AudioEngine::~AudioEngine() {
+    {
+        const std::lock_guard<std::mutex> lock(producer_->mutex);
+        producer_->engine = nullptr;
+    }
+    stopping_.store(true, std::memory_order_release);
+    mixer_.Interrupt();
+    if (render_thread_.joinable()) {
+        render_thread_.join();
+    }
+    housekeeping_stopping_.store(true, std::memory_order_release);
+    mixer_.WakeHousekeeping();
+    if (housekeeping_thread_.joinable()) {
+        housekeeping_thread_.join();
+    }
+    sink_->Close();
+}
+
+void AudioEngine::Play(const std::string &path, int volume_percent, SoundCategory category) {
+    const int64_t requested_at = NowNs();
+    std::shared_ptr<const CachedSound> sound = sounds_.Find(path);
+    if (sound != nullptr) {
+        const std::lock_guard<std::mutex> lock(producer_->mutex);
+        Submit(path, std::move(sound), volume_percent, category, requested_at);
+        return;
+    }
+
+    // Decoding could stall the caller's event loop for a long time, so the
+    // cache's loader thread reads the file and submits it when done.
+    logger_.Warn("audio", "'" + path + "' not in sound cache, loading it in the background");
+    sounds_.LoadAsync(path, [producer = producer_, path, volume_percent, category,
+                             requested_at](std::shared_ptr<const CachedSound> loaded) {
+        const std::lock_guard<std::mutex> lock(producer->mutex);
+        AudioEngine *engine = producer->engine;
+        if (engine == nullptr) {
+            return;
+        }
+        if (loaded == nullptr) {
+            engine->logger_.Error("audio", "failed to load '" + path + "'");
+            return;
+        }
+        engine->Submit(path, std::move(loaded), volume_percent, category, requested_at);
+    });
+}
+
+void AudioEngine::Submit(const std::string &path, std::shared_ptr<const CachedSound> sound, int volume_percent,
+                         SoundCategory category, int64_t requested_at) {
+    if (sound->channels > kMaxChannels) {
+        logger_.Error("audio", "'" + path + "' has " + std::to_string(sound->channels) +
+                                   " channels, at most " + std::to_string(kMaxChannels) + " are supported");
+        return;
+    }
+
+    volume_percent = std::clamp(volume_percent, 0, 100);
+    MixerCommand command;
+    command.category = category;
+    command.gain_q15 = GainQ15FromPercent(volume_percent);
+    command.requested_at_ns = requested_at;
+    command.sound = std::move(sound);
+
+    const uint32_t id = next_id_++;
+    command.id = id;
+    if (!mixer_.Submit(std::move(command))) {
+        logger_.Warn("audio", "command queue full, dropping '" + path + "'");
+        return;
+    }
+    logger_.Info("audio", "playing '" + path + "' at " + std::to_string(volume_percent) + "% as " +
+                              Describe(category, id));
+}
+
+// Runs the mixer against the sink. Nothing in this loop allocates or takes a
+// lock; the sink reports device trouble through mixer events.
+void AudioEngine::RenderLoop() {
+    std::vector<uint8_t> period(kPeriodFrames * kMaxChannels * sizeof(int16_t));
+    bool streaming = false;
+    std::size_t idle_frames_left = 0;
+
+    const auto fail = [this, &streaming]() {
+        mixer_.StopAll(MixerEvent::Type::kDropped);
+        mixer_.DropPending();
+        streaming = false;
+    };
+
+    while (!stopping_.load(std::memory_order_acquire)) {
+        const uint32_t seen = mixer_.CommandSequence();
+        mixer_.ProcessCommands();
+
+        if (!mixer_.Active()) {
+            if (streaming && mixer_.HasPending()) {
+                // Something is waiting for a different format: let the tail
+                // of the last sound play out before reconfiguring.
+                sink_->Drain();
+                streaming = false;
+            } else if (streaming && idle_frames_left == 0) {
+                sink_->Drop();
+                streaming = false;
+            }
+
+            if (!streaming) {
+                if (!mixer_.HasPending()) {
+                    mixer_.WaitForCommands(seen);
+                    continue;
+                }
+                const MixerFormat wanted = mixer_.WantedFormat();
+                if (!sink_->Configure(wanted, mixer_)) {
+                    fail();
+                    continue;
+                }
+                streaming = true;
+                mixer_.SetOutputFormat(wanted);
+                if (!mixer_.Active()) {
+                    mixer_.DropPending();
+                    continue;
+                }
+            }
+        } else if (!streaming) {
+            if (!sink_->Configure(mixer_.OutputFormat(), mixer_)) {
+                fail();
+                continue;
+            }
+            streaming = true;
+        }
+
+        const bool mixing = mixer_.Active();
+        const std::size_t frames = mixing ? kPeriodFrames : std::min(kPeriodFrames, idle_frames_left);
+        mixer_.Render(period.data(), frames);
+        if (!sink_->Write(period.data(), frames, mixer_)) {
+            fail();
+            continue;
+        }
+        idle_frames_left = mixing ? static_cast<std::size_t>(mixer_.OutputFormat().sample_rate) * kIdleStreamMs / 1000
+                                  : idle_frames_left - frames;
+    }
+}
+
+void AudioEngine::HousekeepingLoop() {
+    while (true) {
+        const uint32_t seen = mixer_.EventSequence();
+        MixerEvent event;
+        while (mixer_.PopEvent(&event)) {
+            LogEvent(event);
+        }
+        mixer_.ReleaseRetired();
+        sink_->Housekeep();
+
+        const uint64_t dropped = mixer_.DroppedEvents();
+        if (dropped != reported_dropped_events_) {
+            logger_.Warn("audio", std::to_string(dropped - reported_dropped_events_) + " mixer events lost");
+            reported_dropped_events_ = dropped;
+        }
+        if (housekeeping_stopping_.load(std::memory_order_acquire)) {
+            return;
+        }
+        mixer_.WaitForEvents(seen);
+    }
+}
+
+void AudioEngine::LogEvent(const MixerEvent &event) {
+    const std::string sound = Describe(event.category, event.id);
+    switch (event.type) {
+    case MixerEvent::Type::kStarted:
+        start_latency_us_.Observe(static_cast<uint64_t>(std::max<int64_t>(event.value, 0)));
+        logger_.Info("audio",
+                     "first frames queued " + std::to_string(event.value) + "us after request (" + sound + ")");
+        break;
+    case MixerEvent::Type::kFinished:
+        playback_ms_.Observe(static_cast<uint64_t>(std::max<int64_t>(event.value, 0)));
+        logger_.Info("audio", "playback complete in " + std::to_string(event.value) + "ms (" + sound + ")");
+        break;
+    case MixerEvent::Type::kQueued:
+        logger_.Info("audio", sound + " queued");
+        break;
+    case MixerEvent::Type::kDeferred:
+        logger_.Info("audio", sound + " waiting for the device to change format");
+        break;
+    case MixerEvent::Type::kReplaced:
+        logger_.Info("audio", sound + " replaced by a newer " + SoundCategoryName(event.category));
+        break;
+    case MixerEvent::Type::kPreempted:
+        logger_.Info("audio", sound + " preempted by bell");
+        break;
+    case MixerEvent::Type::kDropped:
+        logger_.Warn("audio", sound + " dropped");
+        break;
+    case MixerEvent::Type::kDeviceOpened:
+        logger_.Info("audio", "opened audio device '" + sink_->Name() + "'");
+        break;
+    case MixerEvent::Type::kDeviceConfigured:
+        logger_.Info("audio", "configured audio device rate=" + std::to_string(event.value) +
+                                  " channels=" + std::to_string(event.code));
+        break;
+    case MixerEvent::Type::kDeviceError:
+        logger_.Error("audio", "audio device '" + sink_->Name() + "' " + event.what +
+                                   " failed: " + std::strerror(-event.code));
+        break;
+    case MixerEvent::Type::kUnderrun:
+        logger_.Warn("audio", "audio device underrun");
+        break;
+    }
+}
+
+} // namespace chime
@@ -0,0 +1,415 @@
+#include "chime/audio_mixer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace chime {
+namespace {
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int Rank(SoundCategory category) {
+    switch (category) {
+    case SoundCategory::kBell:
+        return 2;
+    case SoundCategory::kNotification:
+        return 1;
+    case SoundCategory::kOther:
+        break;
+    }
+    return 0;
+}
+
+// Hands a sound reference to the housekeeping thread. Dropping it here would
+// free the PCM buffer on the render thread if it was the last reference, so
+// that only happens when the retire queue is full.
+template <typename Queue> void ReleaseSound(Queue &retired, std::shared_ptr<const CachedSound> &sound) {
+    if (sound != nullptr && !retired.TryPush(std::move(sound))) {
+        sound.reset();
+    }
+}
+
+} // namespace
+
+const char *SoundCategoryName(SoundCategory category) {
+    switch (category) {
+    case SoundCategory::kBell:
+        return "bell";
+    case SoundCategory::kNotification:
+        return "notification";
+    case SoundCategory::kOther:
+        break;
+    }
+    return "other";
+}
+
+std::optional<OverlapPolicy> ParseOverlapPolicy(std::string_view value) {
+    if (value == "mix") {
+        return OverlapPolicy::kMix;
+    }
+    if (value == "queue") {
+        return OverlapPolicy::kQueue;
+    }
+    if (value == "replace") {
+        return OverlapPolicy::kReplace;
+    }
+    return std::nullopt;
+}
+
+std::optional<BellPriority> ParseBellPriority(std::string_view value) {
+    if (value == "mix") {
+        return BellPriority::kMix;
+    }
+    if (value == "duck") {
+        return BellPriority::kDuck;
+    }
+    if (value == "preempt") {
+        return BellPriority::kPreempt;
+    }
+    return std::nullopt;
+}
+
+OverlapPolicy MixerPolicy::ForCategory(SoundCategory category) const {
+    switch (category) {
+    case SoundCategory::kBell:
+        return bell;
+    case SoundCategory::kNotification:
+        return notification;
+    case SoundCategory::kOther:
+        break;
+    }
+    return other;
+}
+
+MixerFormat FormatOf(const CachedSound &sound) {
+    return MixerFormat{sound.channels, sound.sample_rate, sound.bits_per_sample};
+}
+
+AudioMixer::AudioMixer(const MixerPolicy &policy) : policy_(policy), kernels_(ActivePcmKernels()) {}
+
+bool AudioMixer::Submit(MixerCommand &&command) {
+    if (!commands_.TryPush(std::move(command))) {
+        return false;
+    }
+    command_seq_.fetch_add(1, std::memory_order_release);
+    command_seq_.notify_one();
+    return true;
+}
+
+bool AudioMixer::PopEvent(MixerEvent *event) {
+    return events_.TryPop(event);
+}
+
+std::size_t AudioMixer::ReleaseRetired() {
+    std::size_t released = 0;
+    std::shared_ptr<const CachedSound> sound;
+    while (retired_.TryPop(&sound)) {
+        sound.reset();
+        ++released;
+    }
+    return released;
+}
+
+void AudioMixer::Interrupt() {
+    command_seq_.fetch_add(1, std::memory_order_release);
+    command_seq_.notify_all();
+    event_seq_.fetch_add(1, std::memory_order_release);
+    event_seq_.notify_all();
+}
+
+void AudioMixer::WakeHousekeeping() {
+    event_seq_.fetch_add(1, std::memory_order_release);
+    event_seq_.notify_one();
+}
+
+void AudioMixer::PostEvent(const MixerEvent &event) {
+    MixerEvent copy = event;
+    if (!events_.TryPush(std::move(copy))) {
+        dropped_events_.fetch_add(1, std::memory_order_relaxed);
+    }
+    event_seq_.fetch_add(1, std::memory_order_release);
+    event_seq_.notify_one();
+}
+
+void AudioMixer::ProcessCommands() {
+    MixerCommand command;
+    while (commands_.TryPop(&command)) {
+        ApplyPlay(std::move(command));
+    }
+    Promote();
+}
+
+MixerFormat AudioMixer::WantedFormat() const {
+    if (Active() || pending_count_ == 0) {
+        return output_format_;
+    }
+    for (std::size_t i = 0; i < pending_count_; ++i) {
+        if (pending_[i].category == SoundCategory::kBell) {
+            return FormatOf(*pending_[i].sound);
+        }
+    }
+    return FormatOf(*pending_[0].sound);
+}
+
+void AudioMixer::SetOutputFormat(const MixerFormat &format) {
+    output_format_ = format;
+    Promote();
+}
+
+// Renders in chunks that fit the accumulator, so a period of any size stays
+// allocation free.
+void AudioMixer::Render(uint8_t *out, std::size_t frames) {
+    const std::size_t channels = std::max<std::size_t>(1, output_format_.channels);
+    const std::size_t frame_bytes = channels * (output_format_.bits_per_sample == 16 ? 2 : 1);
+    const std::size_t chunk_frames = std::max<std::size_t>(1, kMixChunkSamples / channels);
+    for (std::size_t done = 0; done < frames;) {
+        const std::size_t count = std::min(chunk_frames, frames - done);
+        RenderChunk(out + done * frame_bytes, count);
+        done += count;
+    }
+}
+
+// 16-bit voices are summed in the int32 accumulator and saturated once, so a
+// loud voice clipping early cannot change what the others add to the mix.
+void AudioMixer::RenderChunk(uint8_t *out, std::size_t frames) {
+    const std::size_t samples = frames * output_format_.channels;
+    const bool wide = output_format_.bits_per_sample == 16;
+    if (wide) {
+        std::fill_n(accumulator_.begin(), samples, 0);
+    } else {
+        std::memset(out, 0x80, samples);
+    }
+
+    const bool duck = policy_.bell_priority == BellPriority::kDuck && CategoryActive(SoundCategory::kBell);
+    const int64_t now = NowNs();
+    bool finished = false;
+    for (Voice &voice : voices_) {
+        if (!voice.active) {
+            continue;
+        }
+        int32_t gain = voice.gain_q15;
+        if (duck && voice.category != SoundCategory::kBell) {
+            gain = (gain * policy_.duck_gain_q15) >> 15;
+        }
+
+        const CachedSound &sound = *voice.sound;
+        const std::size_t count = std::min(frames, sound.frames() - voice.frame);
+        const uint8_t *src = sound.samples.data() + voice.frame * sound.block_align;
+        if (wide) {
+            kernels_.accumulate_s16(accumulator_.data(), reinterpret_cast<const int16_t *>(src),
+                                    count * sound.channels, gain);
+        } else {
+            kernels_.mix_u8(out, src, count * sound.channels, gain);
+        }
+
+        if (!voice.started) {
+            voice.started = true;
+            PostEvent({MixerEvent::Type::kStarted, voice.id, voice.category, (now - voice.requested_at_ns) / 1000});
+        }
+        voice.frame += count;
+        if (voice.frame >= sound.frames()) {
+            Retire(voice, MixerEvent::Type::kFinished);
+            finished = true;
+        }
+    }
+    if (wide) {
+        kernels_.saturate_s32_to_s16(accumulator_.data(), reinterpret_cast<int16_t *>(out), samples);
+    }
+    if (finished) {
+        Promote();
+    }
+}
+
+void AudioMixer::StopAll(MixerEvent::Type reason) {
+    for (Voice &voice : voices_) {
+        if (voice.active) {
+            Retire(voice, reason);
+        }
+    }
+}
+
+void AudioMixer::DropPending() {
+    for (std::size_t i = 0; i < pending_count_; ++i) {
+        PostEvent({MixerEvent::Type::kDropped, pending_[i].id, pending_[i].category});
+        ReleaseSound(retired_, pending_[i].sound);
+    }
+    pending_count_ = 0;
+}
+
+void AudioMixer::ApplyPlay(MixerCommand &&command) {
+    if (command.sound == nullptr || command.sound->frames() == 0) {
+        PostEvent({MixerEvent::Type::kFinished, command.id, command.category});
+        ReleaseSound(retired_, command.sound);
+        return;
+    }
+
+    const SoundCategory category = command.category;
+    if (category == SoundCategory::kBell && policy_.bell_priority == BellPriority::kPreempt) {
+        for (Voice &voice : voices_) {
+            if (voice.active && voice.category != SoundCategory::kBell) {
+                Retire(voice, MixerEvent::Type::kPreempted);
+            }
+        }
+    }
+
+    const OverlapPolicy overlap = policy_.ForCategory(category);
+    if (overlap == OverlapPolicy::kReplace) {
+        for (Voice &voice : voices_) {
+            if (voice.active && voice.category == category) {
+                Retire(voice, MixerEvent::Type::kReplaced);
+            }
+        }
+        for (std::size_t i = pending_count_; i-- > 0;) {
+            if (pending_[i].category == category) {
+                PostEvent({MixerEvent::Type::kReplaced, pending_[i].id, category});
+                ReleaseSound(retired_, pending_[i].sound);
+                RemovePending(i);
+            }
+        }
+    } else if (overlap == OverlapPolicy::kQueue) {
+        const auto pending_end = pending_.begin() + static_cast<std::ptrdiff_t>(pending_count_);
+        const bool waiting = std::any_of(pending_.begin(), pending_end, [category](const MixerCommand &pending) {
+            return pending.category == category;
+        });
+        if (waiting || CategoryActive(category)) {
+            Enqueue(std::move(command), MixerEvent::Type::kQueued);
+            return;
+        }
+    }
+
+    if (!CanStart(command)) {
+        const bool format_change = !output_format_.valid() || !(FormatOf(*command.sound) == output_format_);
+        Enqueue(std::move(command), format_change ? MixerEvent::Type::kDeferred : MixerEvent::Type::kQueued);
+        return;
+    }
+    if (!StartVoice(std::move(command))) {
+        Enqueue(std::move(command), MixerEvent::Type::kQueued);
+    }
+}
+
+bool AudioMixer::CanStart(const MixerCommand &command) const {
+    if (!output_format_.valid() || !(FormatOf(*command.sound) == output_format_)) {
+        return false;
+    }
+    return command.category == SoundCategory::kBell || policy_.bell_priority != BellPriority::kPreempt ||
+           !CategoryActive(SoundCategory::kBell);
+}
+
+// Takes ownership of the command only when it returns true. When every voice
+// is busy the oldest voice of the lowest category is stolen, but never one
+// that outranks the new sound.
+bool AudioMixer::StartVoice(MixerCommand &&command) {
+    Voice *slot = nullptr;
+    for (Voice &voice : voices_) {
+        if (!voice.active) {
+            slot = &voice;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        Voice *victim = &voices_[0];
+        for (Voice &voice : voices_) {
+            if (Rank(voice.category) < Rank(victim->category) ||
+                (Rank(voice.category) == Rank(victim->category) && voice.start_order < victim->start_order)) {
+                victim = &voice;
+            }
+        }
+        if (Rank(victim->category) > Rank(command.category)) {
+            return false;
+        }
+        Retire(*victim, MixerEvent::Type::kDropped);
+        slot = victim;
+    }
+
+    slot->sound = std::move(command.sound);
+    slot->id = command.id;
+    slot->category = command.category;
+    slot->gain_q15 = std::clamp(command.gain_q15, 0, kQ15Unity);
+    slot->requested_at_ns = command.requested_at_ns;
+    slot->start_order = next_start_order_++;
+    slot->frame = 0;
+    slot->active = true;
+    slot->started = false;
+    UpdateActiveCount();
+    return true;
+}
+
+// A full pending list evicts its oldest lowest-ranked entry, or rejects the
+// new sound when everything already waiting outranks it.
+void AudioMixer::Enqueue(MixerCommand &&command, MixerEvent::Type reason) {
+    if (pending_count_ == kMaxPending) {
+        std::size_t victim = 0;
+        for (std::size_t i = 1; i < pending_count_; ++i) {
+            if (Rank(pending_[i].category) < Rank(pending_[victim].category)) {
+                victim = i;
+            }
+        }
+        if (Rank(pending_[victim].category) > Rank(command.category)) {
+            PostEvent({MixerEvent::Type::kDropped, command.id, command.category});
+            ReleaseSound(retired_, command.sound);
+            return;
+        }
+        PostEvent({MixerEvent::Type::kDropped, pending_[victim].id, pending_[victim].category});
+        ReleaseSound(retired_, pending_[victim].sound);
+        RemovePending(victim);
+    }
+
+    PostEvent({reason, command.id, command.category});
+    pending_[pending_count_++] = std::move(command);
+}
+
+void AudioMixer::RemovePending(std::size_t index) {
+    for (std::size_t i = index; i + 1 < pending_count_; ++i) {
+        pending_[i] = std::move(pending_[i + 1]);
+    }
+    --pending_count_;
+    pending_[pending_count_] = MixerCommand{};
+}
+
+// Starts waiting sounds that are now allowed to play, bells first. Waiting
+// sounds only take free voices; they never steal from playing ones.
+void AudioMixer::Promote() {
+    for (const bool bells : {true, false}) {
+        std::size_t i = 0;
+        while (i < pending_count_) {
+            MixerCommand &command = pending_[i];
+            const bool is_bell = command.category == SoundCategory::kBell;
+            const bool free_voice = ActiveVoices() < kMaxVoices;
+            const bool blocked = policy_.ForCategory(command.category) == OverlapPolicy::kQueue &&
+                                 CategoryActive(command.category);
+            if (is_bell != bells || !free_voice || blocked || !CanStart(command) || !StartVoice(std::move(command))) {
+                ++i;
+                continue;
+            }
+            RemovePending(i);
+        }
+    }
+}
+
+void AudioMixer::Retire(Voice &voice, MixerEvent::Type reason) {
+    const int64_t value =
+        reason == MixerEvent::Type::kFinished ? (NowNs() - voice.requested_at_ns) / 1000000 : 0;
+    PostEvent({reason, voice.id, voice.category, value});
+    ReleaseSound(retired_, voice.sound);
+    voice.active = false;
+    UpdateActiveCount();
+}
+
+bool AudioMixer::CategoryActive(SoundCategory category) const {
+    return std::any_of(voices_.begin(), voices_.end(),
+                       [category](const Voice &voice) { return voice.active && voice.category == category; });
+}
+
+void AudioMixer::UpdateActiveCount() {
+    const auto count = static_cast<uint32_t>(
+        std::count_if(voices_.begin(), voices_.end(), [](const Voice &voice) { return voice.active; }));
+    active_voices_.store(count, std::memory_order_release);
+}
+
+} // namespace chime
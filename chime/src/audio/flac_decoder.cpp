@@ -0,0 +1,118 @@
+#include "chime/sound_decoders.h"
+
+#include <FLAC/stream_decoder.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "chime/sound_cache.h"
+
+namespace chime {
+namespace {
+
+struct DecoderDeleter {
+    void operator()(FLAC__StreamDecoder *decoder) const { FLAC__stream_decoder_delete(decoder); }
+};
+
+struct FlacState {
+    uint32_t sample_rate = 0;
+    uint16_t channels = 0;
+    uint64_t max_frames = 0;
+    std::vector<int16_t> samples;
+    std::string error;
+};
+
+// Scales any FLAC bit depth (4-32) to 16 bits.
+int16_t ToPcm16(FLAC__int32 sample, unsigned bits_per_sample) {
+    if (bits_per_sample > 16) {
+        return static_cast<int16_t>(sample >> (bits_per_sample - 16));
+    }
+    return static_cast<int16_t>(sample * (1 << (16 - bits_per_sample)));
+}
+
+FLAC__StreamDecoderWriteStatus OnWrite(const FLAC__StreamDecoder *, const FLAC__Frame *frame,
+                                       const FLAC__int32 *const buffer[], void *client_data) {
+    auto *state = static_cast<FlacState *>(client_data);
+    if (state->channels == 0) {
+        state->channels = static_cast<uint16_t>(frame->header.channels);
+        state->sample_rate = frame->header.sample_rate;
+        state->max_frames = static_cast<uint64_t>(state->sample_rate) * kMaxDecodedSeconds;
+    }
+    if (frame->header.channels != state->channels) {
+        state->error = "channel count changes mid-stream";
+        return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+    }
+    if ((state->samples.size() / state->channels) + frame->header.blocksize > state->max_frames) {
+        state->error = "longer than " + std::to_string(kMaxDecodedSeconds) + "s";
+        return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+    }
+
+    const unsigned bits = frame->header.bits_per_sample;
+    for (unsigned i = 0; i < frame->header.blocksize; ++i) {
+        for (unsigned channel = 0; channel < state->channels; ++channel) {
+            state->samples.push_back(ToPcm16(buffer[channel][i], bits));
+        }
+    }
+    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+void OnMetadata(const FLAC__StreamDecoder *, const FLAC__StreamMetadata *metadata, void *client_data) {
+    if (metadata->type != FLAC__METADATA_TYPE_STREAMINFO) {
+        return;
+    }
+    auto *state = static_cast<FlacState *>(client_data);
+    const FLAC__StreamMetadata_StreamInfo &info = metadata->data.stream_info;
+    const uint64_t max_frames = static_cast<uint64_t>(info.sample_rate) * kMaxDecodedSeconds;
+    if (info.total_samples > 0 && info.total_samples <= max_frames) {
+        state->samples.reserve(static_cast<std::size_t>(info.total_samples * info.channels));
+    }
+}
+
+void OnError(const FLAC__StreamDecoder *, FLAC__StreamDecoderErrorStatus status, void *client_data) {
+    auto *state = static_cast<FlacState *>(client_data);
+    if (state->error.empty()) {
+        state->error = FLAC__StreamDecoderErrorStatusString[status];
+    }
+}
+
+} // namespace
+
+bool FlacDecoderAvailable() {
+    return true;
+}
+
+bool DecodeFlacFile(const std::string &path, CachedSound *sound, std::string *error) {
+    const std::unique_ptr<FLAC__StreamDecoder, DecoderDeleter> decoder(FLAC__stream_decoder_new());
+    if (decoder == nullptr) {
+        *error = "failed to create flac decoder";
+        return false;
+    }
+
+    FlacState state;
+    const FLAC__StreamDecoderInitStatus init_status =
+        FLAC__stream_decoder_init_file(decoder.get(), path.c_str(), OnWrite, OnMetadata, OnError, &state);
+    if (init_status != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+        *error = "flac init failed: " + std::string(FLAC__StreamDecoderInitStatusString[init_status]);
+        return false;
+    }
+
+    const bool decoded = FLAC__stream_decoder_process_until_end_of_stream(decoder.get());
+    const FLAC__StreamDecoderState end_state = FLAC__stream_decoder_get_state(decoder.get());
+    FLAC__stream_decoder_finish(decoder.get());
+    if (!decoded || end_state != FLAC__STREAM_DECODER_END_OF_STREAM || !state.error.empty()) {
+        *error = "flac decode failed: " +
+                 (state.error.empty() ? std::string(FLAC__StreamDecoderStateString[end_state]) : state.error);
+        return false;
+    }
+    if (state.samples.empty()) {
+        *error = "flac stream has no audio";
+        return false;
+    }
+
+    AssignPcm16(state.samples, state.channels, state.sample_rate, sound);
+    return true;
+}
+
+} // namespace chime
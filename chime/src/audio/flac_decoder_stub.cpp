@@ -0,0 +1,14 @@
+#include "chime/sound_decoders.h"
+
+namespace chime {
+
+bool FlacDecoderAvailable() {
+    return false;
+}
+
+bool DecodeFlacFile(const std::string &, CachedSound *, std::string *error) {
+    *error = "flac support not available in this build";
+    return false;
+}
+
+} // namespace chime
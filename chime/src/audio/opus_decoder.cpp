@@ -0,0 +1,77 @@
+#include "chime/sound_decoders.h"
+
+#include <opusfile.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "chime/sound_cache.h"
+
+namespace chime {
+namespace {
+
+constexpr uint32_t kOpusSampleRate = 48000;
+// op_read() buffer; 120 ms of stereo is the largest packet opusfile returns.
+constexpr int kReadBufferSamples = 5760 * 2;
+
+struct OpusFileDeleter {
+    void operator()(OggOpusFile *file) const { op_free(file); }
+};
+
+} // namespace
+
+bool OpusDecoderAvailable() {
+    return true;
+}
+
+bool DecodeOpusFile(const std::string &path, CachedSound *sound, std::string *error) {
+    int open_error = 0;
+    const std::unique_ptr<OggOpusFile, OpusFileDeleter> file(op_open_file(path.c_str(), &open_error));
+    if (file == nullptr) {
+        *error = "not an ogg opus file (opusfile error " + std::to_string(open_error) + ")";
+        return false;
+    }
+
+    const bool stereo = op_channel_count(file.get(), -1) > 1;
+    const uint16_t channels = stereo ? 2 : 1;
+    const uint64_t max_samples = static_cast<uint64_t>(kOpusSampleRate) * kMaxDecodedSeconds * channels;
+
+    std::vector<int16_t> samples;
+    const ogg_int64_t total_frames = op_pcm_total(file.get(), -1);
+    if (total_frames > 0 && static_cast<uint64_t>(total_frames) * channels <= max_samples) {
+        samples.reserve(static_cast<std::size_t>(total_frames) * channels);
+    }
+
+    std::vector<opus_int16> buffer(kReadBufferSamples);
+    while (true) {
+        const int frames = stereo ? op_read_stereo(file.get(), buffer.data(), kReadBufferSamples)
+                                  : op_read(file.get(), buffer.data(), kReadBufferSamples, nullptr);
+        if (frames == OP_HOLE) {
+            continue;
+        }
+        if (frames < 0) {
+            *error = "opus decode failed (opusfile error " + std::to_string(frames) + ")";
+            return false;
+        }
+        if (frames == 0) {
+            break;
+        }
+        const std::size_t count = static_cast<std::size_t>(frames) * channels;
+        if (samples.size() + count > max_samples) {
+            *error = "longer than " + std::to_string(kMaxDecodedSeconds) + "s";
+            return false;
+        }
+        samples.insert(samples.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    if (samples.empty()) {
+        *error = "opus stream has no audio";
+        return false;
+    }
+
+    AssignPcm16(samples, channels, kOpusSampleRate, sound);
+    return true;
+}
+
+} // namespace chime
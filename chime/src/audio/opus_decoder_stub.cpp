@@ -0,0 +1,14 @@
+#include "chime/sound_decoders.h"
+
+namespace chime {
+
+bool OpusDecoderAvailable() {
+    return false;
+}
+
+bool DecodeOpusFile(const std::string &, CachedSound *, std::string *error) {
+    *error = "opus support not available in this build";
+    return false;
+}
+
+} // namespace chime
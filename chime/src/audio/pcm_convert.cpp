@@ -0,0 +1,305 @@
+#include "chime/pcm_convert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "chime/sound_cache.h"
+
+namespace chime {
+namespace {
+
+constexpr uint16_t kWavFormatPcm = 1;
+constexpr uint16_t kWavFormatFloat = 3;
+
+// Filter shape: zero crossings on each side of the sinc at the passband
+// edge, the fraction of the lower Nyquist frequency that is kept, and the
+// Kaiser window beta (about 90 dB stopband).
+constexpr int kZeroCrossings = 16;
+constexpr double kPassband = 0.95;
+constexpr double kKaiserBeta = 9.0;
+// Phase tables larger than this (odd rate pairs with a tiny common divisor)
+// are not stored; taps are computed per output frame instead.
+constexpr uint64_t kMaxTablePhases = 4096;
+constexpr double kPi = 3.14159265358979323846;
+
+int32_t ReadLe24(const uint8_t *data) {
+    const uint32_t raw = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                         (static_cast<uint32_t>(data[2]) << 16);
+    return static_cast<int32_t>(raw << 8) >> 8;
+}
+
+template <typename T> T ReadLe(const uint8_t *data) {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+std::size_t BytesPerSample(PcmEncoding encoding) {
+    switch (encoding) {
+    case PcmEncoding::kU8:
+        return 1;
+    case PcmEncoding::kS16:
+        return 2;
+    case PcmEncoding::kS24:
+        return 3;
+    case PcmEncoding::kS32:
+    case PcmEncoding::kFloat32:
+        return 4;
+    case PcmEncoding::kFloat64:
+        return 8;
+    }
+    return 0;
+}
+
+// Float WAVs can carry NaN or infinity; one of those would smear across
+// every output frame the filter touches, so they decode as silence.
+float FiniteOrZero(float value) {
+    return std::isfinite(value) ? value : 0.0F;
+}
+
+float SampleToFloat(const uint8_t *data, PcmEncoding encoding) {
+    switch (encoding) {
+    case PcmEncoding::kU8:
+        return (static_cast<float>(data[0]) - 128.0F) / 128.0F;
+    case PcmEncoding::kS16:
+        return static_cast<float>(ReadLe<int16_t>(data)) / 32768.0F;
+    case PcmEncoding::kS24:
+        return static_cast<float>(ReadLe24(data)) / 8388608.0F;
+    case PcmEncoding::kS32:
+        return static_cast<float>(static_cast<double>(ReadLe<int32_t>(data)) / 2147483648.0);
+    case PcmEncoding::kFloat32:
+        return FiniteOrZero(ReadLe<float>(data));
+    case PcmEncoding::kFloat64:
+        return FiniteOrZero(static_cast<float>(ReadLe<double>(data)));
+    }
+    return 0.0F;
+}
+
+// Decodes and remaps channels in one pass.
+std::vector<float> DecodeAndRemap(const PcmSource &source, uint16_t out_channels) {
+    const std::size_t sample_bytes = BytesPerSample(source.encoding);
+    const std::size_t frame_bytes = sample_bytes * source.channels;
+    const uint16_t in_channels = source.channels;
+
+    std::vector<float> frame(in_channels);
+    std::vector<float> out(source.frames * out_channels);
+    for (std::size_t i = 0; i < source.frames; ++i) {
+        const uint8_t *in = source.data + i * frame_bytes;
+        for (uint16_t c = 0; c < in_channels; ++c) {
+            frame[c] = SampleToFloat(in + c * sample_bytes, source.encoding);
+        }
+        float *dst = out.data() + i * out_channels;
+        if (out_channels >= in_channels) {
+            // Identity, or mono duplicated / channels repeated round-robin.
+            for (uint16_t c = 0; c < out_channels; ++c) {
+                dst[c] = frame[c % in_channels];
+            }
+            continue;
+        }
+        // Fewer outputs: each output averages the inputs that fold onto it.
+        for (uint16_t c = 0; c < out_channels; ++c) {
+            float sum = 0.0F;
+            int count = 0;
+            for (uint16_t in_c = c; in_c < in_channels; in_c = static_cast<uint16_t>(in_c + out_channels)) {
+                sum += frame[in_c];
+                ++count;
+            }
+            dst[c] = sum / static_cast<float>(count);
+        }
+    }
+    return out;
+}
+
+double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double half_x = x / 2.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (half_x / k) * (half_x / k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Rational resampler: conceptually upsamples by `up`, low-pass filters and
+// keeps every `down`-th sample. Each output frame only evaluates the taps of
+// its phase, so the cost is taps * channels per output frame.
+class PolyphaseResampler {
+  public:
+    PolyphaseResampler(uint32_t in_rate, uint32_t out_rate) {
+        const uint32_t divisor = std::gcd(in_rate, out_rate);
+        up_ = out_rate / divisor;
+        down_ = in_rate / divisor;
+        // Cutoff relative to the input Nyquist frequency.
+        cutoff_ = kPassband * std::min(1.0, static_cast<double>(out_rate) / in_rate);
+        half_taps_ = static_cast<int>(std::ceil(kZeroCrossings / cutoff_));
+        window_norm_ = BesselI0(kKaiserBeta);
+
+        if (up_ <= kMaxTablePhases) {
+            table_.resize(up_ * Taps());
+            for (uint64_t phase = 0; phase < up_; ++phase) {
+                ComputeTaps(phase, table_.data() + phase * Taps());
+            }
+        }
+    }
+
+    std::size_t OutputFrames(std::size_t in_frames) const { return (in_frames * up_ + down_ - 1) / down_; }
+
+    std::vector<float> Process(const std::vector<float> &in, std::size_t in_frames, uint16_t channels) const {
+        const std::size_t out_frames = OutputFrames(in_frames);
+        const std::size_t taps = Taps();
+        std::vector<float> out(out_frames * channels, 0.0F);
+        std::vector<float> scratch(table_.empty() ? taps : 0);
+
+        for (std::size_t j = 0; j < out_frames; ++j) {
+            const uint64_t position = static_cast<uint64_t>(j) * down_;
+            const auto base = static_cast<int64_t>(position / up_);
+            const uint64_t phase = position % up_;
+            const float *coefficients = nullptr;
+            if (table_.empty()) {
+                ComputeTaps(phase, scratch.data());
+                coefficients = scratch.data();
+            } else {
+                coefficients = table_.data() + phase * taps;
+            }
+
+            // Tap i reads input frame base - half_taps + 1 + i; frames outside
+            // the sound are silence.
+            const int64_t first = base - half_taps_ + 1;
+            const std::size_t begin = first < 0 ? static_cast<std::size_t>(-first) : 0;
+            const std::size_t end =
+                std::min<int64_t>(static_cast<int64_t>(taps), static_cast<int64_t>(in_frames) - first);
+            float *dst = out.data() + j * channels;
+            for (std::size_t i = begin; i < end; ++i) {
+                const float *src = in.data() + static_cast<std::size_t>(first + static_cast<int64_t>(i)) * channels;
+                for (uint16_t c = 0; c < channels; ++c) {
+                    dst[c] += coefficients[i] * src[c];
+                }
+            }
+        }
+        return out;
+    }
+
+  private:
+    std::size_t Taps() const { return static_cast<std::size_t>(2 * half_taps_); }
+
+    // Taps for the output instant `phase / up` input frames past an input
+    // frame, normalized to unity gain at DC.
+    void ComputeTaps(uint64_t phase, float *taps) const {
+        const double fraction = static_cast<double>(phase) / static_cast<double>(up_);
+        std::vector<double> values(Taps());
+        double sum = 0.0;
+        for (std::size_t i = 0; i < Taps(); ++i) {
+            const double distance = static_cast<double>(half_taps_ - 1 - static_cast<int>(i)) + fraction;
+            const double x = distance * cutoff_;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+            const double ratio = distance / half_taps_;
+            const double window = ratio >= 1.0 || ratio <= -1.0
+                                      ? 0.0
+                                      : BesselI0(kKaiserBeta * std::sqrt(1.0 - ratio * ratio)) / window_norm_;
+            values[i] = cutoff_ * sinc * window;
+            sum += values[i];
+        }
+        for (std::size_t i = 0; i < Taps(); ++i) {
+            taps[i] = static_cast<float>(values[i] / sum);
+        }
+    }
+
+    uint64_t up_ = 1;
+    uint64_t down_ = 1;
+    double cutoff_ = 1.0;
+    int half_taps_ = kZeroCrossings;
+    double window_norm_ = 1.0;
+    std::vector<float> table_;
+};
+
+int16_t FloatToS16(float value) {
+    // NaN passes through std::clamp and its integer conversion is undefined.
+    if (!std::isfinite(value)) {
+        return 0;
+    }
+    const float scaled = std::nearbyint(value * 32768.0F);
+    return static_cast<int16_t>(std::clamp(scaled, -32768.0F, 32767.0F));
+}
+
+void SetError(std::string *error, const std::string &message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+}
+
+} // namespace
+
+std::optional<PcmEncoding> PcmEncodingOf(uint16_t audio_format, uint16_t bytes_per_sample) {
+    if (audio_format == kWavFormatPcm) {
+        switch (bytes_per_sample) {
+        case 1:
+            return PcmEncoding::kU8;
+        case 2:
+            return PcmEncoding::kS16;
+        case 3:
+            return PcmEncoding::kS24;
+        case 4:
+            return PcmEncoding::kS32;
+        default:
+            return std::nullopt;
+        }
+    }
+    if (audio_format == kWavFormatFloat) {
+        if (bytes_per_sample == 4) {
+            return PcmEncoding::kFloat32;
+        }
+        if (bytes_per_sample == 8) {
+            return PcmEncoding::kFloat64;
+        }
+    }
+    return std::nullopt;
+}
+
+bool ConvertPcm(const PcmSource &source, const PcmOutputFormat &target, CachedSound *sound, std::string *error) {
+    if (sound == nullptr || source.data == nullptr) {
+        SetError(error, "internal error");
+        return false;
+    }
+    if (source.channels == 0 || source.sample_rate == 0 || target.channels == 0 || target.sample_rate == 0) {
+        SetError(error, "invalid sample format");
+        return false;
+    }
+
+    sound->channels = target.channels;
+    sound->sample_rate = target.sample_rate;
+    sound->bits_per_sample = 16;
+    sound->block_align = static_cast<uint16_t>(target.channels * sizeof(int16_t));
+
+    // Already in the output format: plain copy, bit-exact.
+    if (source.encoding == PcmEncoding::kS16 && source.channels == target.channels &&
+        source.sample_rate == target.sample_rate) {
+        const std::size_t bytes = source.frames * sound->block_align;
+        sound->samples = AlignedPcmBuffer(bytes);
+        std::memcpy(sound->samples.data(), source.data, bytes);
+        return true;
+    }
+
+    std::vector<float> remapped = DecodeAndRemap(source, target.channels);
+    std::size_t frames = source.frames;
+    if (source.sample_rate != target.sample_rate) {
+        const PolyphaseResampler resampler(source.sample_rate, target.sample_rate);
+        remapped = resampler.Process(remapped, frames, target.channels);
+        frames = resampler.OutputFrames(frames);
+    }
+
+    sound->samples = AlignedPcmBuffer(frames * sound->block_align);
+    auto *out = reinterpret_cast<int16_t *>(sound->samples.data());
+    for (std::size_t i = 0; i < remapped.size(); ++i) {
+        out[i] = FloatToS16(remapped[i]);
+    }
+    return true;
+}
+
+} // namespace chime
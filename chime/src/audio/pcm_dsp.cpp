@@ -0,0 +1,472 @@
+#include "chime/pcm_dsp.h"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define CHIME_PCM_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define CHIME_PCM_NEON 1
+#include <arm_neon.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little, "PCM kernels assume little-endian samples");
+
+namespace chime {
+namespace {
+
+constexpr int32_t kQ15Round = 1 << 14;
+
+int32_t ScaleQ15(int32_t sample, int32_t gain_q15) {
+    return (sample * gain_q15 + kQ15Round) >> 15;
+}
+
+int16_t SaturateS16(int32_t value) {
+    return static_cast<int16_t>(std::clamp(value, -32768, 32767));
+}
+
+uint8_t SaturateU8(int32_t centered) {
+    return static_cast<uint8_t>(std::clamp(centered, -128, 127) + 128);
+}
+
+// Scalar reference. Vector variants fall back to these for their tails.
+
+void GainS16Scalar(int16_t *samples, std::size_t count, int32_t gain_q15) {
+    for (std::size_t i = 0; i < count; ++i) {
+        samples[i] = SaturateS16(ScaleQ15(samples[i], gain_q15));
+    }
+}
+
+void GainU8Scalar(uint8_t *samples, std::size_t count, int32_t gain_q15) {
+    for (std::size_t i = 0; i < count; ++i) {
+        samples[i] = SaturateU8(ScaleQ15(static_cast<int32_t>(samples[i]) - 128, gain_q15));
+    }
+}
+
+void MixS16Scalar(int16_t *dst, const int16_t *src, std::size_t count, int32_t gain_q15) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = SaturateS16(dst[i] + ScaleQ15(src[i], gain_q15));
+    }
+}
+
+void MixU8Scalar(uint8_t *dst, const uint8_t *src, std::size_t count, int32_t gain_q15) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const int32_t mixed =
+            (static_cast<int32_t>(dst[i]) - 128) + ScaleQ15(static_cast<int32_t>(src[i]) - 128, gain_q15);
+        dst[i] = SaturateU8(mixed);
+    }
+}
+
+void AccumulateS16Scalar(int32_t *acc, const int16_t *src, std::size_t count, int32_t gain_q15) {
+    for (std::size_t i = 0; i < count; ++i) {
+        acc[i] += ScaleQ15(src[i], gain_q15);
+    }
+}
+
+void SaturateS32ToS16Scalar(const int32_t *src, int16_t *dst, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = SaturateS16(src[i]);
+    }
+}
+
+constexpr PcmKernels kScalarKernels{"scalar",     GainS16Scalar,       GainU8Scalar,          MixS16Scalar,
+                                    MixU8Scalar, AccumulateS16Scalar, SaturateS32ToS16Scalar};
+
+#if defined(CHIME_PCM_X86)
+
+// SSE2 has no rounding high multiply, so the Q15 product is formed from the
+// 32-bit mullo/mulhi halves. Gains below unity keep every product in range.
+__m128i ScaleQ15Sse2(__m128i samples, __m128i gain, __m128i round) {
+    const __m128i lo = _mm_mullo_epi16(samples, gain);
+    const __m128i hi = _mm_mulhi_epi16(samples, gain);
+    const __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+    const __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+    return _mm_packs_epi32(p0, p1);
+}
+
+// Widens offset-binary u8 to centered s16 (low or high eight lanes).
+__m128i CenterU8LoSse2(__m128i samples) {
+    return _mm_srai_epi16(_mm_unpacklo_epi8(_mm_setzero_si128(), samples), 8);
+}
+
+__m128i CenterU8HiSse2(__m128i samples) {
+    return _mm_srai_epi16(_mm_unpackhi_epi8(_mm_setzero_si128(), samples), 8);
+}
+
+void GainS16Sse2(int16_t *samples, std::size_t count, int32_t gain_q15) {
+    if (gain_q15 >= kQ15Unity) {
+        return;
+    }
+    const __m128i gain = _mm_set1_epi16(static_cast<int16_t>(gain_q15));
+    const __m128i round = _mm_set1_epi32(kQ15Round);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto *ptr = reinterpret_cast<__m128i *>(samples + i);
+        _mm_storeu_si128(ptr, ScaleQ15Sse2(_mm_loadu_si128(ptr), gain, round));
+    }
+    GainS16Scalar(samples + i, count - i, gain_q15);
+}
+
+void GainU8Sse2(uint8_t *samples, std::size_t count, int32_t gain_q15) {
+    if (gain_q15 >= kQ15Unity) {
+        return;
+    }
+    const __m128i gain = _mm_set1_epi16(static_cast<int16_t>(gain_q15));
+    const __m128i round = _mm_set1_epi32(kQ15Round);
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        auto *ptr = reinterpret_cast<__m128i *>(samples + i);
+        const __m128i centered = _mm_xor_si128(_mm_loadu_si128(ptr), bias);
+        const __m128i lo = ScaleQ15Sse2(CenterU8LoSse2(centered), gain, round);
+        const __m128i hi = ScaleQ15Sse2(CenterU8HiSse2(centered), gain, round);
+        _mm_storeu_si128(ptr, _mm_xor_si128(_mm_packs_epi16(lo, hi), bias));
+    }
+    GainU8Scalar(samples + i, count - i, gain_q15);
+}
+
+void MixS16Sse2(int16_t *dst, const int16_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const __m128i gain = _mm_set1_epi16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    const __m128i round = _mm_set1_epi32(kQ15Round);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto *out = reinterpret_cast<__m128i *>(dst + i);
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        if (!unity) {
+            in = ScaleQ15Sse2(in, gain, round);
+        }
+        _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), in));
+    }
+    MixS16Scalar(dst + i, src + i, count - i, gain_q15);
+}
+
+void MixU8Sse2(uint8_t *dst, const uint8_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const __m128i gain = _mm_set1_epi16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    const __m128i round = _mm_set1_epi32(kQ15Round);
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        auto *out = reinterpret_cast<__m128i *>(dst + i);
+        const __m128i d = _mm_xor_si128(_mm_loadu_si128(out), bias);
+        const __m128i s = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), bias);
+        __m128i s_lo = CenterU8LoSse2(s);
+        __m128i s_hi = CenterU8HiSse2(s);
+        if (!unity) {
+            s_lo = ScaleQ15Sse2(s_lo, gain, round);
+            s_hi = ScaleQ15Sse2(s_hi, gain, round);
+        }
+        const __m128i lo = _mm_add_epi16(CenterU8LoSse2(d), s_lo);
+        const __m128i hi = _mm_add_epi16(CenterU8HiSse2(d), s_hi);
+        _mm_storeu_si128(out, _mm_xor_si128(_mm_packs_epi16(lo, hi), bias));
+    }
+    MixU8Scalar(dst + i, src + i, count - i, gain_q15);
+}
+
+void AccumulateS16Sse2(int32_t *acc, const int16_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const __m128i gain = _mm_set1_epi16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    const __m128i round = _mm_set1_epi32(kQ15Round);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        if (!unity) {
+            in = ScaleQ15Sse2(in, gain, round);
+        }
+        // Interleaving a lane with itself and shifting right by 16 sign-extends it.
+        auto *lo = reinterpret_cast<__m128i *>(acc + i);
+        auto *hi = reinterpret_cast<__m128i *>(acc + i + 4);
+        _mm_storeu_si128(lo, _mm_add_epi32(_mm_loadu_si128(lo), _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16)));
+        _mm_storeu_si128(hi, _mm_add_epi32(_mm_loadu_si128(hi), _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16)));
+    }
+    AccumulateS16Scalar(acc + i, src + i, count - i, gain_q15);
+}
+
+void SaturateS32ToS16Sse2(const int32_t *src, int16_t *dst, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(a, b));
+    }
+    SaturateS32ToS16Scalar(src + i, dst + i, count - i);
+}
+
+constexpr PcmKernels kSse2Kernels{"sse2",    GainS16Sse2,       GainU8Sse2,          MixS16Sse2,
+                                  MixU8Sse2, AccumulateS16Sse2, SaturateS32ToS16Sse2};
+
+// AVX2 is selected at runtime, so these are compiled with a target attribute
+// rather than requiring -mavx2 for the whole binary. _mm256_mulhrs_epi16
+// computes (a * b + 0x4000) >> 15, which is the scalar rounding exactly.
+// Unpack and pack both work per 128-bit lane, so element order survives.
+#define CHIME_PCM_AVX2 __attribute__((target("avx2")))
+
+CHIME_PCM_AVX2 __m256i CenterU8LoAvx2(__m256i samples) {
+    return _mm256_srai_epi16(_mm256_unpacklo_epi8(_mm256_setzero_si256(), samples), 8);
+}
+
+CHIME_PCM_AVX2 __m256i CenterU8HiAvx2(__m256i samples) {
+    return _mm256_srai_epi16(_mm256_unpackhi_epi8(_mm256_setzero_si256(), samples), 8);
+}
+
+CHIME_PCM_AVX2 void GainS16Avx2(int16_t *samples, std::size_t count, int32_t gain_q15) {
+    if (gain_q15 >= kQ15Unity) {
+        return;
+    }
+    const __m256i gain = _mm256_set1_epi16(static_cast<int16_t>(gain_q15));
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        auto *ptr = reinterpret_cast<__m256i *>(samples + i);
+        _mm256_storeu_si256(ptr, _mm256_mulhrs_epi16(_mm256_loadu_si256(ptr), gain));
+    }
+    GainS16Scalar(samples + i, count - i, gain_q15);
+}
+
+CHIME_PCM_AVX2 void GainU8Avx2(uint8_t *samples, std::size_t count, int32_t gain_q15) {
+    if (gain_q15 >= kQ15Unity) {
+        return;
+    }
+    const __m256i gain = _mm256_set1_epi16(static_cast<int16_t>(gain_q15));
+    const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+    std::size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        auto *ptr = reinterpret_cast<__m256i *>(samples + i);
+        const __m256i centered = _mm256_xor_si256(_mm256_loadu_si256(ptr), bias);
+        const __m256i lo = _mm256_mulhrs_epi16(CenterU8LoAvx2(centered), gain);
+        const __m256i hi = _mm256_mulhrs_epi16(CenterU8HiAvx2(centered), gain);
+        _mm256_storeu_si256(ptr, _mm256_xor_si256(_mm256_packs_epi16(lo, hi), bias));
+    }
+    GainU8Scalar(samples + i, count - i, gain_q15);
+}
+
+CHIME_PCM_AVX2 void MixS16Avx2(int16_t *dst, const int16_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const __m256i gain = _mm256_set1_epi16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        auto *out = reinterpret_cast<__m256i *>(dst + i);
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        if (!unity) {
+            in = _mm256_mulhrs_epi16(in, gain);
+        }
+        _mm256_storeu_si256(out, _mm256_adds_epi16(_mm256_loadu_si256(out), in));
+    }
+    MixS16Scalar(dst + i, src + i, count - i, gain_q15);
+}
+
+CHIME_PCM_AVX2 void MixU8Avx2(uint8_t *dst, const uint8_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const __m256i gain = _mm256_set1_epi16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+    std::size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        auto *out = reinterpret_cast<__m256i *>(dst + i);
+        const __m256i d = _mm256_xor_si256(_mm256_loadu_si256(out), bias);
+        const __m256i s = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)), bias);
+        __m256i s_lo = CenterU8LoAvx2(s);
+        __m256i s_hi = CenterU8HiAvx2(s);
+        if (!unity) {
+            s_lo = _mm256_mulhrs_epi16(s_lo, gain);
+            s_hi = _mm256_mulhrs_epi16(s_hi, gain);
+        }
+        const __m256i lo = _mm256_add_epi16(CenterU8LoAvx2(d), s_lo);
+        const __m256i hi = _mm256_add_epi16(CenterU8HiAvx2(d), s_hi);
+        _mm256_storeu_si256(out, _mm256_xor_si256(_mm256_packs_epi16(lo, hi), bias));
+    }
+    MixU8Scalar(dst + i, src + i, count - i, gain_q15);
+}
+
+CHIME_PCM_AVX2 void AccumulateS16Avx2(int32_t *acc, const int16_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const __m256i gain = _mm256_set1_epi16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        if (!unity) {
+            in = _mm256_mulhrs_epi16(in, gain);
+        }
+        auto *lo = reinterpret_cast<__m256i *>(acc + i);
+        auto *hi = reinterpret_cast<__m256i *>(acc + i + 8);
+        const __m256i in_lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(in));
+        const __m256i in_hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(in, 1));
+        _mm256_storeu_si256(lo, _mm256_add_epi32(_mm256_loadu_si256(lo), in_lo));
+        _mm256_storeu_si256(hi, _mm256_add_epi32(_mm256_loadu_si256(hi), in_hi));
+    }
+    AccumulateS16Scalar(acc + i, src + i, count - i, gain_q15);
+}
+
+CHIME_PCM_AVX2 void SaturateS32ToS16Avx2(const int32_t *src, int16_t *dst, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 8));
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), packed);
+    }
+    SaturateS32ToS16Scalar(src + i, dst + i, count - i);
+}
+
+constexpr PcmKernels kAvx2Kernels{"avx2",    GainS16Avx2,       GainU8Avx2,          MixS16Avx2,
+                                  MixU8Avx2, AccumulateS16Avx2, SaturateS32ToS16Avx2};
+
+#elif defined(CHIME_PCM_NEON)
+
+// vqrdmulhq_s16 computes sat((2 * a * b + 0x8000) >> 16), i.e. the scalar
+// (a * b + 0x4000) >> 15 rounding; it cannot saturate for gains below unity.
+int16x8_t CenterU8Lo(uint8x16_t samples) {
+    return vmovl_s8(vget_low_s8(vreinterpretq_s8_u8(veorq_u8(samples, vdupq_n_u8(0x80)))));
+}
+
+int16x8_t CenterU8Hi(uint8x16_t samples) {
+    return vmovl_s8(vget_high_s8(vreinterpretq_s8_u8(veorq_u8(samples, vdupq_n_u8(0x80)))));
+}
+
+uint8x16_t UncenterU8(int16x8_t lo, int16x8_t hi) {
+    return veorq_u8(vreinterpretq_u8_s8(vcombine_s8(vqmovn_s16(lo), vqmovn_s16(hi))), vdupq_n_u8(0x80));
+}
+
+void GainS16Neon(int16_t *samples, std::size_t count, int32_t gain_q15) {
+    if (gain_q15 >= kQ15Unity) {
+        return;
+    }
+    const int16x8_t gain = vdupq_n_s16(static_cast<int16_t>(gain_q15));
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(samples + i, vqrdmulhq_s16(vld1q_s16(samples + i), gain));
+    }
+    GainS16Scalar(samples + i, count - i, gain_q15);
+}
+
+void GainU8Neon(uint8_t *samples, std::size_t count, int32_t gain_q15) {
+    if (gain_q15 >= kQ15Unity) {
+        return;
+    }
+    const int16x8_t gain = vdupq_n_s16(static_cast<int16_t>(gain_q15));
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t in = vld1q_u8(samples + i);
+        vst1q_u8(samples + i, UncenterU8(vqrdmulhq_s16(CenterU8Lo(in), gain), vqrdmulhq_s16(CenterU8Hi(in), gain)));
+    }
+    GainU8Scalar(samples + i, count - i, gain_q15);
+}
+
+void MixS16Neon(int16_t *dst, const int16_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const int16x8_t gain = vdupq_n_s16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t in = vld1q_s16(src + i);
+        if (!unity) {
+            in = vqrdmulhq_s16(in, gain);
+        }
+        vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), in));
+    }
+    MixS16Scalar(dst + i, src + i, count - i, gain_q15);
+}
+
+void MixU8Neon(uint8_t *dst, const uint8_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const int16x8_t gain = vdupq_n_s16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t d = vld1q_u8(dst + i);
+        const uint8x16_t s = vld1q_u8(src + i);
+        int16x8_t s_lo = CenterU8Lo(s);
+        int16x8_t s_hi = CenterU8Hi(s);
+        if (!unity) {
+            s_lo = vqrdmulhq_s16(s_lo, gain);
+            s_hi = vqrdmulhq_s16(s_hi, gain);
+        }
+        vst1q_u8(dst + i, UncenterU8(vaddq_s16(CenterU8Lo(d), s_lo), vaddq_s16(CenterU8Hi(d), s_hi)));
+    }
+    MixU8Scalar(dst + i, src + i, count - i, gain_q15);
+}
+
+void AccumulateS16Neon(int32_t *acc, const int16_t *src, std::size_t count, int32_t gain_q15) {
+    const bool unity = gain_q15 >= kQ15Unity;
+    const int16x8_t gain = vdupq_n_s16(static_cast<int16_t>(std::min(gain_q15, kQ15Unity - 1)));
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t in = vld1q_s16(src + i);
+        if (!unity) {
+            in = vqrdmulhq_s16(in, gain);
+        }
+        vst1q_s32(acc + i, vaddw_s16(vld1q_s32(acc + i), vget_low_s16(in)));
+        vst1q_s32(acc + i + 4, vaddw_s16(vld1q_s32(acc + i + 4), vget_high_s16(in)));
+    }
+    AccumulateS16Scalar(acc + i, src + i, count - i, gain_q15);
+}
+
+void SaturateS32ToS16Neon(const int32_t *src, int16_t *dst, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vld1q_s32(src + i)), vqmovn_s32(vld1q_s32(src + i + 4))));
+    }
+    SaturateS32ToS16Scalar(src + i, dst + i, count - i);
+}
+
+constexpr PcmKernels kNeonKernels{"neon",    GainS16Neon,       GainU8Neon,          MixS16Neon,
+                                  MixU8Neon, AccumulateS16Neon, SaturateS32ToS16Neon};
+
+#endif
+
+const PcmKernels &SelectKernels() {
+#if defined(CHIME_PCM_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return kAvx2Kernels;
+    }
+    return kSse2Kernels;
+#elif defined(CHIME_PCM_NEON)
+    return kNeonKernels;
+#else
+    return kScalarKernels;
+#endif
+}
+
+} // namespace
+
+int32_t GainQ15FromPercent(int volume_percent) {
+    const int32_t percent = std::clamp(volume_percent, 0, 100);
+    return (percent * kQ15Unity + 50) / 100;
+}
+
+const PcmKernels &ScalarPcmKernels() {
+    return kScalarKernels;
+}
+
+const PcmKernels &ActivePcmKernels() {
+    static const PcmKernels &kernels = SelectKernels();
+    return kernels;
+}
+
+std::vector<const PcmKernels *> SupportedPcmKernels() {
+    std::vector<const PcmKernels *> kernels = {&kScalarKernels};
+#if defined(CHIME_PCM_X86)
+    kernels.push_back(&kSse2Kernels);
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(&kAvx2Kernels);
+    }
+#elif defined(CHIME_PCM_NEON)
+    kernels.push_back(&kNeonKernels);
+#endif
+    return kernels;
+}
+
+bool ApplyGainQ15(uint8_t *samples, std::size_t size, uint16_t bits_per_sample, int32_t gain_q15) {
+    const int32_t gain = std::clamp(gain_q15, 0, kQ15Unity);
+    if (bits_per_sample == 16) {
+        ActivePcmKernels().gain_s16(reinterpret_cast<int16_t *>(samples), size / 2, gain);
+        return true;
+    }
+    if (bits_per_sample == 8) {
+        ActivePcmKernels().gain_u8(samples, size, gain);
+        return true;
+    }
+    return false;
+}
+
+} // namespace chime
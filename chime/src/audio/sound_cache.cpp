@@ -0,0 +1,350 @@
+#include "chime/sound_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <optional>
+#include <system_error>
+
+#include "chime/sound_decoders.h"
+#include "chime/wav.h"
+#include "vc/logging/logger.h"
+
+namespace chime {
+namespace {
+
+struct FileStamp {
+    int64_t mtime = 0;
+    uint64_t size = 0;
+};
+
+bool StatFile(const std::string &path, FileStamp *stamp) {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec) || ec) {
+        return false;
+    }
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    stamp->mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    stamp->size = static_cast<uint64_t>(size);
+    return true;
+}
+
+bool IsSoundFileName(const std::string &name) {
+    std::string extension = std::filesystem::path(name).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".wav" || extension == ".flac" || extension == ".opus" || extension == ".ogg";
+}
+
+enum class Container { kWav, kFlac, kOgg };
+
+Container SniffContainer(const std::string &path) {
+    std::array<char, 4> magic{};
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(magic.data(), static_cast<std::streamsize>(magic.size()))) {
+        return Container::kWav;
+    }
+    if (std::memcmp(magic.data(), "fLaC", magic.size()) == 0) {
+        return Container::kFlac;
+    }
+    if (std::memcmp(magic.data(), "OggS", magic.size()) == 0) {
+        return Container::kOgg;
+    }
+    return Container::kWav;
+}
+
+} // namespace
+
+AlignedPcmBuffer::AlignedPcmBuffer(std::size_t size) : size_(size) {
+    const std::size_t blocks = (size + kAlignment - 1) / kAlignment;
+    const std::size_t capacity = std::max<std::size_t>(blocks, 1) * kAlignment;
+    auto *raw = static_cast<uint8_t *>(::operator new[](capacity, std::align_val_t{kAlignment}));
+    std::memset(raw, 0, capacity);
+    data_.reset(raw);
+}
+
+void AlignedPcmBuffer::Deleter::operator()(uint8_t *ptr) const {
+    ::operator delete[](ptr, std::align_val_t{kAlignment});
+}
+
+bool LoadSoundFile(const std::string &path, const PcmOutputFormat &format, CachedSound *sound, std::string *error) {
+    if (sound == nullptr) {
+        if (error != nullptr) {
+            *error = "internal error";
+        }
+        return false;
+    }
+
+    const Container container = SniffContainer(path);
+    if (container != Container::kWav) {
+        CachedSound decoded;
+        std::string decode_error;
+        const bool ok = container == Container::kFlac ? DecodeFlacFile(path, &decoded, &decode_error)
+                                                      : DecodeOpusFile(path, &decoded, &decode_error);
+        if (!ok) {
+            if (error != nullptr) {
+                *error = decode_error;
+            }
+            return false;
+        }
+        const PcmSource source{decoded.samples.data(), decoded.frames(), decoded.channels, decoded.sample_rate,
+                               PcmEncoding::kS16};
+        if (!ConvertPcm(source, format, sound, error)) {
+            return false;
+        }
+        sound->path = path;
+        sound->source_format = std::string(container == Container::kFlac ? "flac" : "opus") + " " +
+                               std::to_string(decoded.sample_rate) + "Hz " + std::to_string(decoded.channels) + "ch";
+        return true;
+    }
+
+    std::vector<uint8_t> wav_bytes;
+    WavInfo info;
+    if (!ReadWavFile(path, &wav_bytes, &info, error)) {
+        return false;
+    }
+    const std::optional<PcmEncoding> encoding =
+        info.block_align % info.channels == 0
+            ? PcmEncodingOf(info.audio_format, static_cast<uint16_t>(info.block_align / info.channels))
+            : std::nullopt;
+    if (!encoding.has_value()) {
+        if (error != nullptr) {
+            *error = "unsupported wav format (format=" + std::to_string(info.audio_format) +
+                     " bits=" + std::to_string(info.bits_per_sample) + ")";
+        }
+        return false;
+    }
+
+    const PcmSource source{wav_bytes.data() + info.data_offset, info.data_size / info.block_align, info.channels,
+                           info.sample_rate, *encoding};
+    if (!ConvertPcm(source, format, sound, error)) {
+        return false;
+    }
+    sound->path = path;
+    const bool is_float = *encoding == PcmEncoding::kFloat32 || *encoding == PcmEncoding::kFloat64;
+    sound->source_format = std::string(is_float ? "wav float" : "wav") + " " +
+                           std::to_string(info.bits_per_sample) + "-bit " + std::to_string(info.sample_rate) +
+                           "Hz " + std::to_string(info.channels) + "ch";
+    return true;
+}
+
+void AssignPcm16(const std::vector<int16_t> &samples, uint16_t channels, uint32_t sample_rate, CachedSound *sound) {
+    sound->channels = channels;
+    sound->sample_rate = sample_rate;
+    sound->bits_per_sample = 16;
+    sound->block_align = static_cast<uint16_t>(channels * sizeof(int16_t));
+    sound->samples = AlignedPcmBuffer(samples.size() * sizeof(int16_t));
+    std::memcpy(sound->samples.data(), samples.data(), samples.size() * sizeof(int16_t));
+}
+
+SoundCache::SoundCache(vc::logging::Logger &logger, const PcmOutputFormat &output_format)
+    : logger_(logger), output_format_(output_format) {
+    loader_thread_ = std::thread([this]() { LoaderLoop(); });
+}
+
+SoundCache::~SoundCache() {
+    {
+        const std::lock_guard<std::mutex> lock(jobs_mutex_);
+        stopping_ = true;
+    }
+    jobs_cv_.notify_all();
+    loader_thread_.join();
+}
+
+void SoundCache::Preload(const std::vector<std::string> &paths) {
+    for (const auto &path : paths) {
+        if (path.empty()) {
+            continue;
+        }
+        if (std::find(watched_paths_.begin(), watched_paths_.end(), path) == watched_paths_.end()) {
+            watched_paths_.push_back(path);
+        }
+        LoadIfChanged(path);
+    }
+    logger_.Info("audio", "sound cache holds " + std::to_string(Count()) + " sounds (" +
+                              std::to_string(TotalBytes() / 1024) + " KiB)");
+}
+
+void SoundCache::PreloadDirectory(const std::string &directory) {
+    if (directory.empty()) {
+        return;
+    }
+    if (std::find(directories_.begin(), directories_.end(), directory) == directories_.end()) {
+        directories_.push_back(directory);
+    }
+    for (const auto &path : ListDirectory(directory)) {
+        LoadIfChanged(path);
+    }
+}
+
+void SoundCache::Refresh() {
+    std::vector<std::string> paths = watched_paths_;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &[path, _] : sounds_) {
+            if (std::find(watched_paths_.begin(), watched_paths_.end(), path) == watched_paths_.end()) {
+                paths.push_back(path);
+            }
+        }
+    }
+    for (const auto &directory : directories_) {
+        for (auto &path : ListDirectory(directory)) {
+            if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+                paths.push_back(std::move(path));
+            }
+        }
+    }
+
+    Stamp stamp;
+    for (const auto &path : paths) {
+        if (NeedsLoad(path, &stamp)) {
+            QueueRefresh(path);
+        }
+    }
+}
+
+std::shared_ptr<const CachedSound> SoundCache::Find(const std::string &path) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = sounds_.find(path);
+    if (it == sounds_.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void SoundCache::LoadAsync(const std::string &path, LoadCallback done) {
+    {
+        const std::lock_guard<std::mutex> lock(jobs_mutex_);
+        jobs_.push_back(LoadJob{path, std::move(done)});
+    }
+    jobs_cv_.notify_one();
+}
+
+std::size_t SoundCache::Count() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return sounds_.size();
+}
+
+std::size_t SoundCache::TotalBytes() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t total = 0;
+    for (const auto &[_, sound] : sounds_) {
+        total += sound->samples.size();
+    }
+    return total;
+}
+
+// Stats `path` and reports whether it differs from the cached copy and from
+// the last version that failed to load. A missing file is dropped from the
+// cache here, since that needs no decoding.
+bool SoundCache::NeedsLoad(const std::string &path, Stamp *stamp) {
+    FileStamp file;
+    const bool exists = StatFile(path, &file);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!exists) {
+        if (sounds_.erase(path) > 0) {
+            logger_.Warn("audio", "sound removed from cache (file missing): " + path);
+        }
+        return false;
+    }
+    *stamp = {file.mtime, file.size};
+    if (const auto cached = sounds_.find(path); cached != sounds_.end()) {
+        if (cached->second->mtime == file.mtime && cached->second->file_size == file.size) {
+            return false;
+        }
+    }
+    const auto rejected = rejected_stamps_.find(path);
+    return rejected == rejected_stamps_.end() || rejected->second != *stamp;
+}
+
+// Decodes and converts `path` without holding the lock, then swaps it in.
+bool SoundCache::Load(const std::string &path, const Stamp &stamp) {
+    auto sound = std::make_shared<CachedSound>();
+    std::string error;
+    if (!LoadSoundFile(path, output_format_, sound.get(), &error)) {
+        logger_.Warn("audio", "failed to cache '" + path + "': " + error);
+        const std::lock_guard<std::mutex> lock(mutex_);
+        rejected_stamps_[path] = stamp;
+        return false;
+    }
+    sound->mtime = stamp.first;
+    sound->file_size = stamp.second;
+
+    logger_.Info("audio", "cached '" + path + "' (" + sound->source_format + ") as rate=" +
+                              std::to_string(sound->sample_rate) + " channels=" + std::to_string(sound->channels) +
+                              " frames=" + std::to_string(sound->frames()));
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    rejected_stamps_.erase(path);
+    sounds_[path] = std::move(sound);
+    return true;
+}
+
+bool SoundCache::LoadIfChanged(const std::string &path) {
+    Stamp stamp;
+    return NeedsLoad(path, &stamp) && Load(path, stamp);
+}
+
+std::vector<std::string> SoundCache::ListDirectory(const std::string &directory) const {
+    std::error_code ec;
+    std::vector<std::string> paths;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (ec) {
+            break;
+        }
+        if (entry.is_regular_file(ec) && IsSoundFileName(entry.path().filename().string())) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+// A refresh job is queued at most once; a file that changes again while it
+// waits is picked up by the stat the loader does before decoding.
+void SoundCache::QueueRefresh(const std::string &path) {
+    {
+        const std::lock_guard<std::mutex> lock(jobs_mutex_);
+        if (!queued_refreshes_.insert(path).second) {
+            return;
+        }
+        jobs_.push_back(LoadJob{path, {}});
+    }
+    jobs_cv_.notify_one();
+}
+
+void SoundCache::LoaderLoop() {
+    while (true) {
+        LoadJob job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex_);
+            jobs_cv_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            if (!job.done) {
+                queued_refreshes_.erase(job.path);
+            }
+        }
+
+        LoadIfChanged(job.path);
+        if (job.done) {
+            job.done(Find(job.path));
+        }
+    }
+}
+
+} // namespace chime
@@ -0,0 +1,154 @@
+#include "chime/wav.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace chime {
+namespace {
+
+constexpr uint16_t kWavFormatExtensible = 0xFFFE;
+
+uint16_t ReadLe16(const std::vector<uint8_t> &data, std::size_t offset) {
+    return static_cast<uint16_t>(data[offset]) | (static_cast<uint16_t>(data[offset + 1]) << 8);
+}
+
+uint32_t ReadLe32(const std::vector<uint8_t> &data, std::size_t offset) {
+    return static_cast<uint32_t>(data[offset]) | (static_cast<uint32_t>(data[offset + 1]) << 8) |
+           (static_cast<uint32_t>(data[offset + 2]) << 16) | (static_cast<uint32_t>(data[offset + 3]) << 24);
+}
+
+void AppendLe16(std::vector<uint8_t> *data, uint16_t value) {
+    data->push_back(static_cast<uint8_t>(value & 0xFF));
+    data->push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+}
+
+void AppendLe32(std::vector<uint8_t> *data, uint32_t value) {
+    AppendLe16(data, static_cast<uint16_t>(value & 0xFFFF));
+    AppendLe16(data, static_cast<uint16_t>((value >> 16) & 0xFFFF));
+}
+
+void SetError(std::string *error, const std::string &message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+}
+
+} // namespace
+
+bool ParseWavHeader(const std::vector<uint8_t> &wav_bytes, WavInfo *info, std::string *error) {
+    if (info == nullptr) {
+        SetError(error, "internal error");
+        return false;
+    }
+    if (wav_bytes.size() < 44) {
+        SetError(error, "wav too small");
+        return false;
+    }
+
+    const std::string riff(reinterpret_cast<const char *>(wav_bytes.data()), 4);
+    const std::string wave(reinterpret_cast<const char *>(wav_bytes.data() + 8), 4);
+    if (riff != "RIFF" || wave != "WAVE") {
+        SetError(error, "not a RIFF/WAVE file");
+        return false;
+    }
+
+    WavInfo parsed;
+    bool have_fmt = false;
+    bool have_data = false;
+
+    std::size_t cursor = 12;
+    while (cursor <= wav_bytes.size() - 8) {
+        const std::size_t chunk_header = cursor;
+        const uint32_t chunk_size = ReadLe32(wav_bytes, chunk_header + 4);
+        const std::size_t chunk_data = chunk_header + 8;
+        if (static_cast<std::size_t>(chunk_size) > wav_bytes.size() - chunk_data) {
+            SetError(error, "corrupt wav chunk size");
+            return false;
+        }
+        const std::size_t chunk_end = chunk_data + static_cast<std::size_t>(chunk_size);
+
+        const std::string chunk_id(reinterpret_cast<const char *>(wav_bytes.data() + chunk_header), 4);
+        if (chunk_id == "fmt ") {
+            if (chunk_size < 16) {
+                SetError(error, "invalid fmt chunk");
+                return false;
+            }
+            parsed.audio_format = ReadLe16(wav_bytes, chunk_data + 0);
+            parsed.channels = ReadLe16(wav_bytes, chunk_data + 2);
+            parsed.sample_rate = ReadLe32(wav_bytes, chunk_data + 4);
+            parsed.block_align = ReadLe16(wav_bytes, chunk_data + 12);
+            parsed.bits_per_sample = ReadLe16(wav_bytes, chunk_data + 14);
+            // WAVE_FORMAT_EXTENSIBLE carries the real format tag in the first
+            // two bytes of its SubFormat GUID.
+            if (parsed.audio_format == kWavFormatExtensible && chunk_size >= 40) {
+                parsed.audio_format = ReadLe16(wav_bytes, chunk_data + 24);
+            }
+            have_fmt = true;
+        } else if (chunk_id == "data") {
+            parsed.data_offset = chunk_data;
+            parsed.data_size = static_cast<std::size_t>(chunk_size);
+            have_data = true;
+        }
+
+        const std::size_t padding = (chunk_size % 2 == 1) ? 1 : 0;
+        if (padding > wav_bytes.size() - chunk_end) {
+            SetError(error, "corrupt wav chunk padding");
+            return false;
+        }
+        cursor = chunk_end + padding;
+    }
+
+    if (!have_fmt || !have_data) {
+        SetError(error, "missing fmt or data chunk");
+        return false;
+    }
+    if (parsed.channels == 0 || parsed.sample_rate == 0 || parsed.block_align == 0) {
+        SetError(error, "invalid fmt chunk");
+        return false;
+    }
+
+    *info = parsed;
+    return true;
+}
+
+bool ReadWavFile(const std::string &path, std::vector<uint8_t> *wav_bytes, WavInfo *info, std::string *error) {
+    if (wav_bytes == nullptr) {
+        SetError(error, "internal error");
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        SetError(error, "failed to open wav");
+        return false;
+    }
+    wav_bytes->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof()) {
+        SetError(error, "failed to read wav");
+        return false;
+    }
+    return ParseWavHeader(*wav_bytes, info, error);
+}
+
+std::vector<uint8_t> BuildWavHeader(uint16_t channels, uint32_t sample_rate, uint16_t bits_per_sample,
+                                    std::size_t data_size) {
+    const auto block_align = static_cast<uint16_t>(channels * ((bits_per_sample + 7) / 8));
+    const auto data_bytes = static_cast<uint32_t>(data_size);
+
+    std::vector<uint8_t> header;
+    header.reserve(44);
+    header.insert(header.end(), {'R', 'I', 'F', 'F'});
+    AppendLe32(&header, 36 + data_bytes);
+    header.insert(header.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    AppendLe32(&header, 16);
+    AppendLe16(&header, 1);
+    AppendLe16(&header, channels);
+    AppendLe32(&header, sample_rate);
+    AppendLe32(&header, sample_rate * block_align);
+    AppendLe16(&header, block_align);
+    AppendLe16(&header, bits_per_sample);
+    header.insert(header.end(), {'d', 'a', 't', 'a'});
+    AppendLe32(&header, data_bytes);
+    return header;
+}
+
+} // namespace chime
@@ -1,7 +1,62 @@
 #include "chime/chime_config.h"
 
+#include <cstdlib>
+#include <string_view>
+#include <utility>
+
 namespace chime {
 namespace {
+constexpr int kMaxRingRouteCooldownMs = 3600 * 1000;
+
+bool ParseRouteInt(std::string_view value, int min_val, int max_val, int *out) {
+    if (value.empty()) {
+        return true;
+    }
+    const std::string text(value);
+    char *end = nullptr;
+    const long parsed = std::strtol(text.c_str(), &end, 10);
+    if (end == nullptr || *end != '\0' || parsed < min_val || parsed > max_val) {
+        return false;
+    }
+    *out = static_cast<int>(parsed);
+    return true;
+}
+
+// ring_routes=<filter>|<sound>[|<volume>[|<priority>[|<cooldown_ms>]]],...
+// Empty optional fields keep their defaults. Any malformed entry rejects the
+// whole key, like an out-of-range number does for other keys.
+bool ParseRingRoutes(ChimeConfig &target, std::string_view value) {
+    std::vector<RingRoute> routes;
+    for (const std::string &entry : vc::config::split_csv(value)) {
+        std::vector<std::string> fields;
+        std::string_view rest = entry;
+        while (true) {
+            const auto pos = rest.find('|');
+            fields.push_back(vc::config::trim(rest.substr(0, pos)));
+            if (pos == std::string_view::npos) {
+                break;
+            }
+            rest = rest.substr(pos + 1);
+        }
+        if (fields.size() < 2 || fields.size() > 5 || fields[0].empty() || fields[1].empty()) {
+            return false;
+        }
+
+        RingRoute route;
+        route.topic_filter = fields[0];
+        route.sound = fields[1];
+        fields.resize(5);
+        if (!ParseRouteInt(fields[2], 0, 100, &route.volume) ||
+            !ParseRouteInt(fields[3], -1000, 1000, &route.priority) ||
+            !ParseRouteInt(fields[4], 0, kMaxRingRouteCooldownMs, &route.cooldown_ms)) {
+            return false;
+        }
+        routes.push_back(std::move(route));
+    }
+    target.ring_routes = std::move(routes);
+    return true;
+}
+
 constexpr vc::config::Field<ChimeConfig> kConfigFields[] = {
     {"mqtt_host", vc::config::parse_string<ChimeConfig, &ChimeConfig::host>, true},
     {"mqtt_port", vc::config::parse_int<ChimeConfig, &ChimeConfig::port>, true},
@@ -24,12 +79,34 @@ constexpr vc::config::Field<ChimeConfig> kConfigFields[] = {
      vc::config::parse_string<ChimeConfig, &ChimeConfig::notification_success_sound_path>, false},
     {"notification_failure_sound_path",
      vc::config::parse_string<ChimeConfig, &ChimeConfig::notification_failure_sound_path>, false},
+    {"ring_sounds_dir", vc::config::parse_string<ChimeConfig, &ChimeConfig::ring_sounds_dir>, false},
+    {"ring_routes", ParseRingRoutes, false},
+    {"ring_dedup_window_ms", vc::config::parse_int<ChimeConfig, &ChimeConfig::ring_dedup_window_ms, 0, 60000>, false},
     {"volume_bell", vc::config::parse_int<ChimeConfig, &ChimeConfig::volume_bell, 0, 100>, false},
     {"volume_notifications", vc::config::parse_int<ChimeConfig, &ChimeConfig::volume_notifications, 0, 100>, false},
     {"volume_other", vc::config::parse_int<ChimeConfig, &ChimeConfig::volume_other, 0, 100>, false},
     {"audio_enabled", vc::config::parse_bool<ChimeConfig, &ChimeConfig::audio_enabled>, false},
+    {"audio_backend", vc::config::parse_string<ChimeConfig, &ChimeConfig::audio_backend>, false},
+    {"audio_device", vc::config::parse_string<ChimeConfig, &ChimeConfig::audio_device>, false},
+    {"audio_mixer_card", vc::config::parse_string<ChimeConfig, &ChimeConfig::audio_mixer_card>, false},
+    {"audio_hardware_volume", vc::config::parse_int<ChimeConfig, &ChimeConfig::audio_hardware_volume, 0, 100>, false},
+    {"audio_output_rate", vc::config::parse_int<ChimeConfig, &ChimeConfig::audio_output_rate, 8000, 192000>, false},
+    {"audio_output_channels", vc::config::parse_int<ChimeConfig, &ChimeConfig::audio_output_channels, 1, 8>, false},
+    {"audio_policy_bell", vc::config::parse_string<ChimeConfig, &ChimeConfig::audio_policy_bell>, false},
+    {"audio_policy_notification", vc::config::parse_string<ChimeConfig, &ChimeConfig::audio_policy_notification>,
+     false},
+    {"audio_policy_other", vc::config::parse_string<ChimeConfig, &ChimeConfig::audio_policy_other>, false},
+    {"audio_bell_priority", vc::config::parse_string<ChimeConfig, &ChimeConfig::audio_bell_priority>, false},
+    {"audio_duck_percent", vc::config::parse_int<ChimeConfig, &ChimeConfig::audio_duck_percent, 0, 100>, false},
+    {"audio_realtime_priority", vc::config::parse_int<ChimeConfig, &ChimeConfig::audio_realtime_priority, 0, 99>,
+     false},
     {"wifi_interface", vc::config::parse_string<ChimeConfig, &ChimeConfig::wifi_interface>, false},
     {"wifi_check_interval", vc::config::parse_int<ChimeConfig, &ChimeConfig::wifi_check_interval, 0, 3600>, false},
+    {"observed_topics_path", vc::config::parse_string<ChimeConfig, &ChimeConfig::observed_topics_path>, false},
+    {"metrics_interval", vc::config::parse_int<ChimeConfig, &ChimeConfig::metrics_interval, 0, 3600>, false},
+    {"metrics_topic", vc::config::parse_string<ChimeConfig, &ChimeConfig::metrics_topic>, false},
+    {"metrics_path", vc::config::parse_string<ChimeConfig, &ChimeConfig::metrics_path>, false},
+    {"stats_segment_path", vc::config::parse_string<ChimeConfig, &ChimeConfig::stats_segment_path>, false},
 };
 } // namespace
 
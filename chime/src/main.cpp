@@ -1,12 +1,21 @@
+#include <csignal>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 
+#include "chime/audio_mixer.h"
 #include "chime/audio_player.h"
 #include "chime/chime_config.h"
 #include "chime/chime_service.h"
+#include "chime/pcm_convert.h"
+#include "chime/pcm_dsp.h"
+#include "chime/sound_cache.h"
+#include "chime/volume_control.h"
 #include "chime/wifi_monitor.h"
 #include "vc/logging/logger.h"
+#include "vc/metrics/metrics.h"
 #include "vc/runtime/signal_handler.h"
 #include "vc/util/environment.h"
 
@@ -47,6 +56,70 @@ std::string ReadReleaseValue(const std::string& key) {
   return "";
 }
 
+chime::OverlapPolicy OverlapPolicyFromConfig(const std::string& key,
+                                             const std::string& value,
+                                             chime::OverlapPolicy fallback,
+                                             vc::logging::Logger& logger) {
+  const auto policy = chime::ParseOverlapPolicy(value);
+  if (!policy.has_value()) {
+    logger.Warn("audio", "unknown " + key + " '" + value +
+                             "', expected mix, queue or replace");
+    return fallback;
+  }
+  return *policy;
+}
+
+chime::MixerPolicy MixerPolicyFromConfig(const chime::ChimeConfig& config,
+                                         vc::logging::Logger& logger) {
+  chime::MixerPolicy policy;
+  policy.bell = OverlapPolicyFromConfig(
+      "audio_policy_bell", config.audio_policy_bell, policy.bell, logger);
+  policy.notification = OverlapPolicyFromConfig(
+      "audio_policy_notification", config.audio_policy_notification,
+      policy.notification, logger);
+  policy.other = OverlapPolicyFromConfig(
+      "audio_policy_other", config.audio_policy_other, policy.other, logger);
+
+  const auto bell_priority =
+      chime::ParseBellPriority(config.audio_bell_priority);
+  if (bell_priority.has_value()) {
+    policy.bell_priority = *bell_priority;
+  } else {
+    logger.Warn("audio", "unknown audio_bell_priority '" +
+                             config.audio_bell_priority +
+                             "', expected mix, duck or preempt");
+  }
+  policy.duck_gain_q15 = chime::GainQ15FromPercent(config.audio_duck_percent);
+  return policy;
+}
+
+std::unique_ptr<chime::AudioPlayer> CreateAudioPlayer(
+    const chime::ChimeConfig& config, vc::logging::Logger& logger,
+    chime::SoundCache& sounds, vc::metrics::Registry& metrics) {
+  const chime::MixerPolicy policy = MixerPolicyFromConfig(config, logger);
+  if (config.audio_backend == "aplay") {
+    logger.Info("audio", "backend=aplay");
+    return std::make_unique<chime::AplayAudioPlayer>(
+        logger, sounds, policy, config.audio_realtime_priority, metrics);
+  }
+
+  if (config.audio_backend != "alsa") {
+    logger.Warn("audio", "unknown audio_backend '" + config.audio_backend +
+                             "', using alsa");
+  }
+  if (!chime::AlsaAudioPlayer::Available()) {
+    logger.Warn("audio",
+                "alsa backend not available in this build, using aplay");
+    return std::make_unique<chime::AplayAudioPlayer>(
+        logger, sounds, policy, config.audio_realtime_priority, metrics);
+  }
+
+  logger.Info("audio", "backend=alsa device=" + config.audio_device);
+  return std::make_unique<chime::AlsaAudioPlayer>(
+      logger, sounds, config.audio_device, policy,
+      config.audio_realtime_priority, metrics);
+}
+
 void PrintUsage(const char* program) {
   std::cout << "Usage: " << program << " [--version]\n";
 }
@@ -104,6 +177,10 @@ int main(int argc, char* argv[]) {
   vc::logging::StderrLogger logger;
   vc::runtime::SignalHandler signal_handler;
   signal_handler.Install();
+#if !defined(_WIN32)
+  // The aplay backend streams into a pipe; a dying aplay must not kill us.
+  std::signal(SIGPIPE, SIG_IGN);
+#endif
 
   const std::string config_env = vc::util::GetEnv("CHIME_CONFIG");
   const std::string config_path =
@@ -137,9 +214,24 @@ int main(int argc, char* argv[]) {
 
   logger.Info("chime", "loaded config from " + config_path);
 
-  chime::AplayAudioPlayer audio_player(logger);
+  chime::VolumeControl volume_control(logger, result.config.audio_mixer_card);
+  if (volume_control.Open()) {
+    volume_control.SetPercent(result.config.audio_hardware_volume);
+  }
+
+  chime::PcmOutputFormat output_format;
+  output_format.channels =
+      static_cast<uint16_t>(result.config.audio_output_channels);
+  output_format.sample_rate =
+      static_cast<uint32_t>(result.config.audio_output_rate);
+  chime::SoundCache sound_cache(logger, output_format);
+  vc::metrics::Registry metrics;
+  const auto audio_player =
+      CreateAudioPlayer(result.config, logger, sound_cache, metrics);
   chime::LinuxWifiMonitor wifi_monitor;
-  chime::ChimeService service(result.config, logger, audio_player, wifi_monitor);
+  chime::ChimeService service(result.config, logger, *audio_player,
+                              sound_cache, volume_control, wifi_monitor,
+                              metrics);
 
   return service.Run(signal_handler);
 }
@@ -3,12 +3,11 @@
 #include <algorithm>
 #include <chrono>
 #include <ctime>
-#include <filesystem>
 #include <fstream>
 #include <string_view>
-#include <thread>
 #include <unistd.h>
 
+#include "chime/pcm_dsp.h"
 #include "vc/config/kv_config.h"
 #include "vc/logging/logger.h"
 #include "vc/runtime/signal_handler.h"
@@ -19,15 +18,31 @@
 
 namespace chime {
 namespace {
-constexpr int kMqttLoopTimeoutMs = 100;
+constexpr int kMqttKeepaliveSeconds = 60;
+// mosquitto_loop_misc() sends keepalive pings; a quarter of the keepalive
+// keeps a late ping well inside the broker's 1.5x grace period.
+constexpr int kMqttMiscIntervalSeconds = kMqttKeepaliveSeconds / 4;
+// Longest one wakeup spends handling queued MQTT packets before timers and
+// the write side get a turn; the socket stays readable, so the rest follows
+// on the next wakeup.
+constexpr std::chrono::milliseconds kMqttReadBudget{10};
 constexpr int kReconnectDelaySeconds = 1;
+constexpr int kStartupCheckIntervalMs = 1000;
 constexpr int kHealthLogIntervalSeconds = 60;
+constexpr int kSoundCacheRefreshIntervalSeconds = 5;
+constexpr int kStatsSegmentIntervalSeconds = 1;
 constexpr int kStartupNotificationTimeoutSeconds = 10;
 constexpr int kStartupUnknownWifiTimeoutSeconds = 30;
 constexpr std::time_t kMinimumSaneEpoch = 1704067200;
 constexpr std::size_t kMaxPayloadLogBytes = 256;
 constexpr std::size_t kMaxObservedTopics = 256;
-constexpr const char *kObservedTopicsPath = "/var/lib/chime/observed_topics.txt";
+// Newly observed topics are written to disk at most this often, off the
+// event loop thread; a wildcard subscription on a busy broker turns up many
+// topics at once.
+constexpr std::chrono::seconds kObservedTopicsFlushDelay{5};
+// Topics beyond this many share one "other" series in the per-topic
+// metrics, which keeps the published snapshot small.
+constexpr std::size_t kMaxMetricTopics = 64;
 
 const char *MqttConnackString(int rc) {
     return rc == 0 ? "Connection Accepted" : "Connection Refused";
@@ -37,51 +52,40 @@ const char *MqttErrorString(int rc) {
     return rc == 0 ? "No error" : "MQTT error";
 }
 
-std::vector<std::string> SplitTopic(std::string_view topic) {
-    std::vector<std::string> levels;
-    std::size_t start = 0;
-    while (start <= topic.size()) {
-        const std::size_t slash = topic.find('/', start);
-        if (slash == std::string_view::npos) {
-            levels.emplace_back(topic.substr(start));
-            break;
-        }
-        levels.emplace_back(topic.substr(start, slash - start));
-        start = slash + 1;
-        if (start == topic.size()) {
-            levels.emplace_back("");
-            break;
-        }
-    }
-    return levels;
-}
-
-bool TopicMatchesFilter(std::string_view filter, std::string_view topic) {
-    const auto filter_levels = SplitTopic(filter);
-    const auto topic_levels = SplitTopic(topic);
-
-    std::size_t topic_index = 0;
-    for (std::size_t filter_index = 0; filter_index < filter_levels.size(); ++filter_index) {
-        const std::string &filter_level = filter_levels[filter_index];
-        if (filter_level == "#") {
-            return filter_index + 1 == filter_levels.size();
-        }
-        if (topic_index >= topic_levels.size()) {
-            return false;
-        }
-        if (filter_level != "+" && filter_level != topic_levels[topic_index]) {
-            return false;
-        }
-        ++topic_index;
-    }
-    return topic_index == topic_levels.size();
-}
 } // namespace
 
 ChimeService::ChimeService(const ChimeConfig &config, vc::logging::Logger &logger, AudioPlayer &audio_player,
-                           const WifiMonitor &wifi_monitor)
+                           SoundCache &sound_cache, const VolumeControl &volume_control,
+                           const WifiMonitor &wifi_monitor, vc::metrics::Registry &metrics)
     : config_(config), logger_(logger), mqtt_client_(logger, *this), audio_player_(audio_player),
-      wifi_monitor_(wifi_monitor) {}
+      sound_cache_(sound_cache), volume_control_(volume_control), wifi_monitor_(wifi_monitor),
+      ring_dedup_(std::chrono::milliseconds(config.ring_dedup_window_ms)), metrics_(metrics),
+      messages_received_(metrics.AddCounter("mqtt_messages", "messages received")),
+      ring_messages_received_(metrics.AddCounter("ring_messages", "messages matching a ring route")),
+      loop_errors_(metrics.AddCounter("mqtt_loop_errors", "broker connection errors")),
+      reconnect_attempts_(metrics.AddCounter("mqtt_reconnects", "reconnect attempts")),
+      heartbeats_sent_(metrics.AddCounter("mqtt_heartbeats", "heartbeats published")),
+      topic_messages_(
+          metrics.AddCounterFamily("mqtt_topic_messages", "messages received per topic", "topic", kMaxMetricTopics)),
+      topic_bytes_(
+          metrics.AddCounterFamily("mqtt_topic_bytes", "payload bytes received per topic", "topic", kMaxMetricTopics)),
+      message_bytes_(metrics.AddHistogram("mqtt_message_bytes", "payload size",
+                                          {16, 64, 256, 1024, 4096, 16384, 65536})),
+      dispatch_us_(metrics.AddHistogram("mqtt_dispatch_us", "time spent handling one message",
+                                        {50, 100, 250, 500, 1000, 2500, 10000, 50000})),
+      mqtt_connected_gauge_(metrics.AddGauge("mqtt_connected", "1 while connected to the broker")),
+      mqtt_backlog_gauge_(metrics.AddGauge("mqtt_backlog_bytes", "bytes left unread after the last wakeup")),
+      cached_sounds_gauge_(metrics.AddGauge("cached_sounds", "sounds held in the sound cache")),
+      observed_topics_gauge_(metrics.AddGauge("observed_topics", "topics in the observed topic list")),
+      observed_topics_(kMaxObservedTopics),
+      observed_topics_file_(logger, config.observed_topics_path, kObservedTopicsFlushDelay),
+      metrics_file_(logger, config.metrics_path, std::chrono::milliseconds(0)) {
+    std::vector<std::string> route_errors;
+    ring_router_.Build(config_, &route_errors);
+    for (const auto &error : route_errors) {
+        logger_.Error("chime", "ring route skipped: " + error);
+    }
+}
 
 int ChimeService::Run(vc::runtime::SignalHandler &signal_handler) {
     clock_was_unsynced_ = !vc::util::ClockIsSane(kMinimumSaneEpoch);
@@ -106,12 +110,23 @@ int ChimeService::Run(vc::runtime::SignalHandler &signal_handler) {
     logger_.Info("mqtt", "heartbeat interval=" + std::to_string(config_.heartbeat_interval) +
                              "s topic=" + config_.heartbeat_topic);
     logger_.Info("audio", "enabled=" + vc::util::BoolToString(config_.audio_enabled) +
-                              " ring_topic=" + config_.ring_topic + " sound_path=" + config_.sound_path);
+                              " ring_routes=" + std::to_string(ring_router_.routes().size()) +
+                              " dedup_window_ms=" + std::to_string(config_.ring_dedup_window_ms));
+    for (const auto &route : ring_router_.routes()) {
+        logger_.Info("audio", "ring route topic=" + route.topic_filter + " sound_path=" + route.sound_path +
+                                  " volume=" + std::to_string(route.volume) +
+                                  " priority=" + std::to_string(route.priority) +
+                                  " cooldown_ms=" + std::to_string(route.cooldown.count()));
+    }
     logger_.Info("audio", "notifications success_path=" + config_.notification_success_sound_path +
                               " failure_path=" + config_.notification_failure_sound_path +
                               " volume=" + std::to_string(config_.volume_notifications));
     logger_.Info("wifi", "monitor interface=" + config_.wifi_interface +
                              " interval=" + std::to_string(config_.wifi_check_interval) + "s");
+    logger_.Info("metrics",
+                 "interval=" + std::to_string(config_.metrics_interval) + "s topic=" + config_.metrics_topic +
+                     " path=" + config_.metrics_path + " stats_segment=" +
+                     (config_.stats_segment_path.empty() ? "<none>" : config_.stats_segment_path));
 
     if (config_.audio_enabled && vc::util::IsLinux()) {
         const auto validate_audio_file = [this](const std::string &path, const std::string &label) {
@@ -119,11 +134,24 @@ int ChimeService::Run(vc::runtime::SignalHandler &signal_handler) {
                 logger_.Warn("audio", "configured " + label + " file does not exist or is not readable: " + path);
             }
         };
-        validate_audio_file(config_.sound_path, "ring sound");
+        for (const auto &route : ring_router_.routes()) {
+            validate_audio_file(route.sound_path, "ring sound");
+        }
         validate_audio_file(config_.notification_success_sound_path, "notification success sound");
         validate_audio_file(config_.notification_failure_sound_path, "notification failure sound");
     }
 
+    if (config_.audio_enabled) {
+        logger_.Info("audio", std::string("pcm kernels=") + ActivePcmKernels().name);
+        sound_cache_.PreloadDirectory(config_.ring_sounds_dir);
+        std::vector<std::string> preload = {config_.notification_success_sound_path,
+                                            config_.notification_failure_sound_path};
+        for (const auto &route : ring_router_.routes()) {
+            preload.push_back(route.sound_path);
+        }
+        sound_cache_.Preload(preload);
+    }
+
     vc::mqtt::ConnectOptions options;
     options.client_id = config_.client_id;
     options.username = config_.mqtt_username;
@@ -133,7 +161,7 @@ int ChimeService::Run(vc::runtime::SignalHandler &signal_handler) {
     options.tls_ca_file = config_.mqtt_tls_ca_file;
     options.tls_cert_file = config_.mqtt_tls_cert_file;
     options.tls_key_file = config_.mqtt_tls_key_file;
-    options.keepalive_seconds = 60;
+    options.keepalive_seconds = kMqttKeepaliveSeconds;
     options.reconnect_min_seconds = 2;
     options.reconnect_max_seconds = 10;
     options.reconnect_exponential_backoff = true;
@@ -144,9 +172,37 @@ int ChimeService::Run(vc::runtime::SignalHandler &signal_handler) {
         return 1;
     }
 
-    auto last_heartbeat = std::chrono::steady_clock::now();
-    auto last_health = last_heartbeat;
-    auto last_wifi_check = last_heartbeat;
+    std::string loop_error;
+    if (!event_loop_.Open(&loop_error)) {
+        logger_.Error("chime", "event loop unavailable: " + loop_error);
+        return 1;
+    }
+    if (signal_handler.WakeFd() >= 0 &&
+        !event_loop_.Watch(
+            signal_handler.WakeFd(), vc::runtime::EventLoop::kReadable,
+            [&signal_handler](uint32_t) { signal_handler.DrainWakeFd(); }, &loop_error)) {
+        logger_.Error("chime", "event loop unavailable: " + loop_error);
+        return 1;
+    }
+    const auto add_timer = [this](vc::runtime::EventLoop::TimerCallback callback) {
+        std::string error;
+        const vc::runtime::EventLoop::TimerId id = event_loop_.AddTimer(std::move(callback), &error);
+        if (id < 0) {
+            logger_.Error("chime", "timer setup failed: " + error);
+        }
+        return id;
+    };
+    const auto start_timer = [this, &add_timer](std::chrono::milliseconds interval,
+                                                vc::runtime::EventLoop::TimerCallback callback) {
+        const vc::runtime::EventLoop::TimerId id = add_timer(std::move(callback));
+        std::string error;
+        if (id >= 0 && !event_loop_.ArmTimer(id, interval, interval, &error)) {
+            logger_.Error("chime", "timer setup failed: " + error);
+            return -1;
+        }
+        return id;
+    };
+
     std::optional<WifiState> last_wifi_state;
 
     const auto startup_wifi_state = wifi_monitor_.ReadState(config_.wifi_interface);
@@ -179,103 +235,139 @@ int ChimeService::Run(vc::runtime::SignalHandler &signal_handler) {
         }
     };
 
-    while (!signal_handler.ShouldStop()) {
-        const int loop_rc = mqtt_client_.Loop(kMqttLoopTimeoutMs, 1);
-        if (signal_handler.ShouldStop()) {
-            break;
-        }
+    // Nothing below polls: the broker socket, the signal wake-up pipe and one
+    // timer per periodic job are all the process waits on.
+    WatchMqttSocket();
+    reconnect_timer_ = add_timer([this]() { ReconnectMqtt(); });
+    if (reconnect_timer_ < 0 ||
+        start_timer(std::chrono::seconds(kMqttMiscIntervalSeconds), [this]() {
+            if (mqtt_socket_ < 0) {
+                return;
+            }
+            if (mqtt_client_.LoopMisc() != 0) {
+                HandleMqttLoopError();
+                return;
+            }
+            UpdateMqttWriteInterest();
+        }) < 0) {
+        return 1;
+    }
 
-        if (loop_rc != 0) {
-            loop_errors_.fetch_add(1, std::memory_order_relaxed);
-            logger_.Warn("mqtt", mqtt_client_.LastError() + " (reconnecting)");
-            std::this_thread::sleep_for(std::chrono::seconds(kReconnectDelaySeconds));
-            reconnect_attempts_.fetch_add(1, std::memory_order_relaxed);
-            if (mqtt_client_.Reconnect()) {
-                logger_.Info("mqtt", "reconnect attempt started");
+    if (config_.heartbeat_interval > 0 &&
+        start_timer(std::chrono::seconds(config_.heartbeat_interval), [this]() {
+            const std::string payload = mqtt_connected_.load() ? "alive" : "degraded";
+            if (mqtt_client_.Publish(config_.heartbeat_topic, payload, 0, false)) {
+                heartbeats_sent_.Add();
+                logger_.Info("mqtt", "heartbeat topic='" + config_.heartbeat_topic + "' payload='" + payload + "'");
             } else {
-                logger_.Error("mqtt", mqtt_client_.LastError());
+                logger_.Warn("mqtt", mqtt_client_.LastError());
             }
-        }
+            UpdateMqttWriteInterest();
+        }) < 0) {
+        return 1;
+    }
+
+    if (config_.wifi_check_interval > 0 &&
+        start_timer(std::chrono::seconds(config_.wifi_check_interval), refresh_wifi_state) < 0) {
+        return 1;
+    }
 
+    vc::runtime::EventLoop::TimerId startup_timer = -1;
+    const auto check_startup = [&]() {
+        refresh_wifi_state();
         const auto now = std::chrono::steady_clock::now();
-        bool wifi_state_refreshed = false;
-
-        if (config_.heartbeat_interval > 0) {
-            const auto heartbeat_elapsed =
-                std::chrono::duration_cast<std::chrono::seconds>(now - last_heartbeat).count();
-            if (heartbeat_elapsed >= config_.heartbeat_interval) {
-                const std::string payload = mqtt_connected_.load() ? "alive" : "degraded";
-                if (mqtt_client_.Publish(config_.heartbeat_topic, payload, 0, false)) {
-                    heartbeats_sent_.fetch_add(1, std::memory_order_relaxed);
-                    logger_.Info("mqtt", "heartbeat topic='" + config_.heartbeat_topic + "' payload='" + payload + "'");
-                } else {
-                    logger_.Warn("mqtt", mqtt_client_.LastError());
+        const bool wifi_state_known = last_wifi_state.has_value();
+        const bool wifi_connected = wifi_state_known && WifiStateIsConnected(last_wifi_state);
+        const bool mqtt_connected = mqtt_connected_.load();
+        const auto startup_elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - startup_begin).count();
+
+        if (wifi_connected && mqtt_connected) {
+            logger_.Info("audio", "startup checks passed (wifi + mqtt), playing success notification");
+            PlayNotification(NotificationSoundType::kSuccess);
+            startup_notification_played = true;
+        } else if (startup_elapsed >= kStartupNotificationTimeoutSeconds) {
+            if (!wifi_state_known) {
+                if (!startup_notification_unknown_logged) {
+                    logger_.Info("audio", "startup checks deferred: wifi state unknown");
+                    startup_notification_unknown_logged = true;
+                    startup_unknown_wifi_begin = now;
                 }
-                last_heartbeat = now;
+
+                if (startup_unknown_wifi_begin.has_value()) {
+                    const auto unknown_wifi_elapsed =
+                        std::chrono::duration_cast<std::chrono::seconds>(now - *startup_unknown_wifi_begin).count();
+                    if (unknown_wifi_elapsed >= kStartupUnknownWifiTimeoutSeconds) {
+                        logger_.Warn("audio", "startup wifi state remained unknown for " +
+                                                 std::to_string(kStartupUnknownWifiTimeoutSeconds) +
+                                                 "s after startup timeout, playing failure notification");
+                        PlayNotification(NotificationSoundType::kFailure);
+                        startup_notification_played = true;
+                    }
+                }
+            } else {
+                startup_unknown_wifi_begin = std::nullopt;
+                logger_.Warn("audio", "startup checks incomplete within " +
+                                         std::to_string(kStartupNotificationTimeoutSeconds) +
+                                         "s, playing failure notification");
+                PlayNotification(NotificationSoundType::kFailure);
+                startup_notification_played = true;
             }
         }
 
-        if (config_.wifi_check_interval > 0) {
-            const auto wifi_elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_wifi_check).count();
-            if (wifi_elapsed >= config_.wifi_check_interval) {
-                refresh_wifi_state();
-                wifi_state_refreshed = true;
-                last_wifi_check = now;
-            }
+        if (startup_notification_played) {
+            event_loop_.DisarmTimer(startup_timer);
         }
+    };
+    if (!startup_notification_played) {
+        startup_timer = start_timer(std::chrono::milliseconds(kStartupCheckIntervalMs), check_startup);
+        if (startup_timer < 0) {
+            return 1;
+        }
+    }
 
-        if (!startup_notification_played) {
-            if (!wifi_state_refreshed) {
-                refresh_wifi_state();
-            }
-            const bool wifi_state_known = last_wifi_state.has_value();
-            const bool wifi_connected = wifi_state_known && WifiStateIsConnected(last_wifi_state);
-            const bool mqtt_connected = mqtt_connected_.load();
-            const auto startup_elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - startup_begin).count();
-
-            if (wifi_connected && mqtt_connected) {
-                logger_.Info("audio", "startup checks passed (wifi + mqtt), playing success notification");
-                PlayNotification(NotificationSoundType::kSuccess);
-                startup_notification_played = true;
-            } else if (startup_elapsed >= kStartupNotificationTimeoutSeconds) {
-                if (!wifi_state_known) {
-                    if (!startup_notification_unknown_logged) {
-                        logger_.Info("audio", "startup checks deferred: wifi state unknown");
-                        startup_notification_unknown_logged = true;
-                        startup_unknown_wifi_begin = now;
-                    }
+    if (config_.audio_enabled &&
+        start_timer(std::chrono::seconds(kSoundCacheRefreshIntervalSeconds), [this]() { sound_cache_.Refresh(); }) <
+            0) {
+        return 1;
+    }
 
-                    if (startup_unknown_wifi_begin.has_value()) {
-                        const auto unknown_wifi_elapsed =
-                            std::chrono::duration_cast<std::chrono::seconds>(now - *startup_unknown_wifi_begin).count();
-                        if (unknown_wifi_elapsed >= kStartupUnknownWifiTimeoutSeconds) {
-                            logger_.Warn("audio", "startup wifi state remained unknown for " +
-                                                     std::to_string(kStartupUnknownWifiTimeoutSeconds) +
-                                                     "s after startup timeout, playing failure notification");
-                            PlayNotification(NotificationSoundType::kFailure);
-                            startup_notification_played = true;
-                        }
-                    }
-                } else {
-                    startup_unknown_wifi_begin = std::nullopt;
-                    logger_.Warn("audio", "startup checks incomplete within " +
-                                             std::to_string(kStartupNotificationTimeoutSeconds) +
-                                             "s, playing failure notification");
-                    PlayNotification(NotificationSoundType::kFailure);
-                    startup_notification_played = true;
-                }
-            }
+    if (config_.metrics_interval > 0 &&
+        start_timer(std::chrono::seconds(config_.metrics_interval), [this]() { PublishMetrics(); }) < 0) {
+        return 1;
+    }
+
+    if (!config_.stats_segment_path.empty()) {
+        std::string stats_error;
+        if (!stats_segment_.Open(config_.stats_segment_path, &stats_error)) {
+            logger_.Warn("metrics", "stats segment unavailable: " + stats_error);
+        } else if (start_timer(std::chrono::seconds(kStatsSegmentIntervalSeconds), [this]() {
+                       UpdateMetricGauges();
+                       stats_segment_.Publish(metrics_);
+                   }) < 0) {
+            return 1;
         }
+    }
 
-        const auto health_elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_health).count();
-        if (health_elapsed >= kHealthLogIntervalSeconds) {
+    if (start_timer(std::chrono::seconds(kHealthLogIntervalSeconds), [this]() {
             const bool clock_sane = vc::util::ClockIsSane(kMinimumSaneEpoch);
             if (clock_was_unsynced_ && clock_sane) {
                 logger_.Info("time", "system clock synchronized");
                 clock_was_unsynced_ = false;
             }
             LogHealth(clock_sane);
-            last_health = now;
+            // Message counts and last-seen times are saved at this pace; new
+            // topics are queued as soon as they show up.
+            if (observed_topics_dirty_) {
+                QueueObservedTopicsWrite();
+            }
+        }) < 0) {
+        return 1;
+    }
+
+    while (!signal_handler.ShouldStop()) {
+        if (!event_loop_.RunOnce(-1, &loop_error)) {
+            logger_.Error("chime", loop_error);
+            break;
         }
     }
 
@@ -289,11 +381,114 @@ int ChimeService::Run(vc::runtime::SignalHandler &signal_handler) {
     if (!mqtt_client_.Disconnect()) {
         logger_.Warn("mqtt", mqtt_client_.LastError());
     }
+    if (observed_topics_dirty_) {
+        QueueObservedTopicsWrite();
+    }
+    observed_topics_file_.Stop();
+    metrics_file_.Stop();
 
     logger_.Info("chime", "service stopped");
     return 0;
 }
 
+void ChimeService::WatchMqttSocket() {
+    if (mqtt_socket_ >= 0) {
+        event_loop_.Unwatch(mqtt_socket_);
+        mqtt_socket_ = -1;
+    }
+    const int socket = mqtt_client_.Socket();
+    if (socket < 0) {
+        return;
+    }
+    mqtt_want_write_ = mqtt_client_.WantWrite();
+    const uint32_t events =
+        vc::runtime::EventLoop::kReadable | (mqtt_want_write_ ? vc::runtime::EventLoop::kWritable : 0);
+    std::string error;
+    if (!event_loop_.Watch(
+            socket, events, [this](uint32_t ready) { OnMqttSocketReady(ready); }, &error)) {
+        logger_.Error("mqtt", "cannot watch broker socket: " + error);
+        return;
+    }
+    mqtt_socket_ = socket;
+}
+
+void ChimeService::OnMqttSocketReady(uint32_t events) {
+    int rc = 0;
+    if ((events & (vc::runtime::EventLoop::kReadable | vc::runtime::EventLoop::kError)) != 0) {
+        rc = mqtt_client_.DrainRead(kMqttReadBudget);
+        ReportMqttBacklog();
+    }
+    if (rc == 0 && (events & vc::runtime::EventLoop::kWritable) != 0) {
+        rc = mqtt_client_.LoopWrite();
+    }
+    if (rc != 0) {
+        HandleMqttLoopError();
+        return;
+    }
+    UpdateMqttWriteInterest();
+}
+
+void ChimeService::ReportMqttBacklog() {
+    const std::size_t backlog = mqtt_client_.read_stats().backlog_bytes;
+    if (backlog > 0 && !mqtt_falling_behind_) {
+        mqtt_falling_behind_ = true;
+        logger_.Warn("mqtt", "falling behind broker: " + std::to_string(backlog) + " bytes queued after " +
+                                 std::to_string(kMqttReadBudget.count()) + "ms of packet handling");
+    } else if (backlog == 0 && mqtt_falling_behind_) {
+        mqtt_falling_behind_ = false;
+        logger_.Info("mqtt", "caught up with broker");
+    }
+}
+
+void ChimeService::UpdateMqttWriteInterest() {
+    if (mqtt_socket_ < 0) {
+        return;
+    }
+    const bool want_write = mqtt_client_.WantWrite();
+    if (want_write == mqtt_want_write_) {
+        return;
+    }
+    const uint32_t events =
+        vc::runtime::EventLoop::kReadable | (want_write ? vc::runtime::EventLoop::kWritable : 0);
+    std::string error;
+    if (!event_loop_.SetEvents(mqtt_socket_, events, &error)) {
+        logger_.Warn("mqtt", "cannot update broker socket interest: " + error);
+        return;
+    }
+    mqtt_want_write_ = want_write;
+}
+
+void ChimeService::HandleMqttLoopError() {
+    loop_errors_.Add();
+    logger_.Warn("mqtt", mqtt_client_.LastError() + " (reconnecting)");
+    // mosquitto has closed the socket (or will reopen it on reconnect).
+    if (mqtt_socket_ >= 0) {
+        event_loop_.Unwatch(mqtt_socket_);
+        mqtt_socket_ = -1;
+    }
+    ScheduleMqttReconnect();
+}
+
+void ChimeService::ScheduleMqttReconnect() {
+    std::string error;
+    if (!event_loop_.ArmTimer(reconnect_timer_, std::chrono::seconds(kReconnectDelaySeconds),
+                              std::chrono::milliseconds(0), &error)) {
+        logger_.Error("mqtt", "cannot schedule reconnect: " + error);
+    }
+}
+
+void ChimeService::ReconnectMqtt() {
+    reconnect_attempts_.Add();
+    if (!mqtt_client_.Reconnect()) {
+        loop_errors_.Add();
+        logger_.Error("mqtt", mqtt_client_.LastError());
+        ScheduleMqttReconnect();
+        return;
+    }
+    logger_.Info("mqtt", "reconnect attempt started");
+    WatchMqttSocket();
+}
+
 void ChimeService::OnConnect(int rc) {
     if (rc != 0) {
         logger_.Error("mqtt",
@@ -322,31 +517,53 @@ void ChimeService::OnDisconnect(int rc) {
     logger_.Warn("mqtt", "unexpected disconnect: code=" + std::to_string(rc) + " '" + MqttErrorString(rc) + "'");
 }
 
-void ChimeService::OnMessage(const vc::mqtt::Message &message) {
-    messages_received_.fetch_add(1, std::memory_order_relaxed);
+void ChimeService::OnMessage(const vc::mqtt::MessageView &message) {
+    const auto received_at = std::chrono::steady_clock::now();
+    messages_received_.Add();
+    topic_messages_.Get(message.topic).Add();
+    topic_bytes_.Get(message.topic).Add(message.payload.size());
+    message_bytes_.Observe(message.payload.size());
     RecordObservedTopic(message.topic);
 
-    std::string payload_for_log = vc::util::SanitizePayloadForLog(message.payload);
-    if (payload_for_log.size() > kMaxPayloadLogBytes) {
-        payload_for_log = payload_for_log.substr(0, kMaxPayloadLogBytes) + "...";
-    }
-
-    logger_.Info("mqtt", "message topic='" + message.topic + "' qos=" + std::to_string(message.qos) +
-                             " retain=" + vc::util::BoolToString(message.retain) +
-                             " bytes=" + std::to_string(message.payload.size()) + " payload='" + payload_for_log + "'");
-
-    if (config_.audio_enabled && RingTopicMatches(message.topic)) {
-        ring_messages_received_.fetch_add(1, std::memory_order_relaxed);
-        logger_.Info("chime", "ring received");
-        audio_player_.Play(config_.sound_path, config_.volume_bell);
-    }
+    // Built in a reused buffer: once it has grown, logging a message does
+    // not allocate.
+    message_log_.clear();
+    message_log_.append("message topic='").append(message.topic);
+    message_log_.append("' qos=").append(std::to_string(message.qos));
+    message_log_.append(" retain=").append(message.retain ? "true" : "false");
+    message_log_.append(" bytes=").append(std::to_string(message.payload.size()));
+    message_log_.append(" payload='");
+    vc::util::AppendPayloadForLog(message.payload, kMaxPayloadLogBytes, &message_log_);
+    message_log_.push_back('\'');
+    logger_.Info("mqtt", message_log_);
+
+    if (config_.audio_enabled) {
+        HandleRing(message, received_at);
+    }
+    dispatch_us_.Observe(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - received_at)
+            .count()));
 }
 
-bool ChimeService::RingTopicMatches(const std::string &message_topic) const {
-    return TopicMatchesFilter(config_.ring_topic, message_topic);
+void ChimeService::HandleRing(const vc::mqtt::MessageView &message, std::chrono::steady_clock::time_point now) {
+    const RingRouter::Route *route = ring_router_.Match(message.topic);
+    if (route == nullptr) {
+        return;
+    }
+    ring_messages_received_.Add();
+    if (ring_dedup_.IsDuplicate(message.topic, message.payload, now)) {
+        logger_.Info("chime", "ring ignored route='" + route->topic_filter + "' (duplicate)");
+        return;
+    }
+    if (!ring_router_.Admit(*route, now)) {
+        logger_.Info("chime", "ring ignored route='" + route->topic_filter + "' (cooldown)");
+        return;
+    }
+    logger_.Info("chime", "ring received route='" + route->topic_filter + "'");
+    audio_player_.Play(route->sound_path, route->volume, SoundCategory::kBell);
 }
 
-void ChimeService::RecordObservedTopic(const std::string &topic) {
+void ChimeService::RecordObservedTopic(std::string_view topic) {
     if (topic.empty()) {
         return;
     }
@@ -354,87 +571,52 @@ void ChimeService::RecordObservedTopic(const std::string &topic) {
         LoadObservedTopics();
     }
 
-    const auto [_, inserted] = observed_topics_set_.insert(topic);
-    if (!inserted) {
+    const std::time_t now = std::time(nullptr);
+    if (ObservedTopicStats *stats = observed_topics_.Touch(topic); stats != nullptr) {
+        stats->last_seen = now;
+        ++stats->messages;
+        observed_topics_dirty_ = true;
         return;
     }
-    observed_topics_.push_back(topic);
-    logger_.Info("mqtt", "observed topic discovered='" + topic + "'");
-    while (observed_topics_.size() > kMaxObservedTopics) {
-        observed_topics_set_.erase(observed_topics_.front());
-        observed_topics_.erase(observed_topics_.begin());
-    }
-
-    std::string error;
-    if (!PersistObservedTopics(&error)) {
-        logger_.Warn("mqtt", "failed to persist observed topics: " + error);
-    }
+    // Only a new topic is copied; a full map reuses its least recently seen
+    // entry.
+    observed_topics_.Emplace(topic, ObservedTopicStats{now, now, 1});
+    logger_.Info("mqtt", "observed topic discovered='" + std::string(topic) + "'");
+    QueueObservedTopicsWrite();
 }
 
 void ChimeService::LoadObservedTopics() {
     observed_topics_loaded_ = true;
-    observed_topics_.clear();
-    observed_topics_set_.clear();
+    observed_topics_.Clear();
 
-    std::ifstream file(kObservedTopicsPath);
+    std::ifstream file(config_.observed_topics_path);
     if (!file.is_open()) {
         return;
     }
 
+    // The file lists the most recently seen topic first; insert oldest first
+    // so recency survives a restart.
+    std::vector<std::pair<std::string, ObservedTopicStats>> entries;
     std::string line;
+    std::string topic;
+    ObservedTopicStats stats;
     while (std::getline(file, line)) {
-        const std::string topic = vc::config::trim(line);
-        if (topic.empty()) {
-            continue;
-        }
-        if (observed_topics_set_.insert(topic).second) {
-            observed_topics_.push_back(topic);
+        if (ParseObservedTopicLine(line, &topic, &stats)) {
+            entries.emplace_back(topic, stats);
         }
     }
-    while (observed_topics_.size() > kMaxObservedTopics) {
-        observed_topics_set_.erase(observed_topics_.front());
-        observed_topics_.erase(observed_topics_.begin());
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        observed_topics_.Emplace(it->first, it->second);
     }
 }
 
-bool ChimeService::PersistObservedTopics(std::string *error) const {
-    if (error == nullptr) {
-        return false;
-    }
-
-    const std::filesystem::path topics_path(kObservedTopicsPath);
-    const std::filesystem::path parent = topics_path.parent_path();
-    std::error_code ec;
-    std::filesystem::create_directories(parent, ec);
-    if (ec) {
-        *error = "create directories failed: " + ec.message();
-        return false;
-    }
-
-    const std::filesystem::path temp_path = topics_path.string() + ".tmp";
-    std::ofstream out(temp_path, std::ios::trunc);
-    if (!out.is_open()) {
-        *error = "failed to open temp topics file";
-        return false;
-    }
-
-    for (const auto &topic : observed_topics_) {
-        out << topic << "\n";
-    }
-    out.flush();
-    if (!out.good()) {
-        *error = "failed writing topics";
-        return false;
-    }
-    out.close();
-
-    std::filesystem::rename(temp_path, topics_path, ec);
-    if (ec) {
-        std::filesystem::remove(temp_path, ec);
-        *error = "rename temp topics file failed: " + ec.message();
-        return false;
+void ChimeService::QueueObservedTopicsWrite() {
+    std::string contents;
+    for (const auto &entry : observed_topics_) {
+        AppendObservedTopicLine(entry.key, entry.value, &contents);
     }
-    return true;
+    observed_topics_file_.Update(std::move(contents));
+    observed_topics_dirty_ = false;
 }
 
 bool ChimeService::WifiStateIsConnected(const std::optional<WifiState> &state) const {
@@ -450,11 +632,13 @@ void ChimeService::PlayNotification(NotificationSoundType type) {
     }
 
     if (type == NotificationSoundType::kSuccess) {
-        audio_player_.Play(config_.notification_success_sound_path, config_.volume_notifications);
+        audio_player_.Play(config_.notification_success_sound_path, config_.volume_notifications,
+                           SoundCategory::kNotification);
         return;
     }
 
-    audio_player_.Play(config_.notification_failure_sound_path, config_.volume_notifications);
+    audio_player_.Play(config_.notification_failure_sound_path, config_.volume_notifications,
+                       SoundCategory::kNotification);
 }
 
 void ChimeService::LogWifiState(const WifiState &state) const {
@@ -476,14 +660,47 @@ void ChimeService::LogWifiState(const WifiState &state) const {
 }
 
 void ChimeService::LogHealth(bool clock_sane) {
+    const std::string &mixer_control = volume_control_.control_name();
+    const vc::mqtt::ReadStats &mqtt_reads = mqtt_client_.read_stats();
     logger_.Info("health", "clock_sane=" + vc::util::BoolToString(clock_sane) +
                                " mqtt_connected=" + vc::util::BoolToString(mqtt_connected_.load()) +
-                               " messages=" + std::to_string(messages_received_.load(std::memory_order_relaxed)) +
-                               " rings=" + std::to_string(ring_messages_received_.load(std::memory_order_relaxed)) +
-                               " loop_errors=" + std::to_string(loop_errors_.load(std::memory_order_relaxed)) +
-                               " reconnects=" + std::to_string(reconnect_attempts_.load(std::memory_order_relaxed)) +
-                               " heartbeats=" + std::to_string(heartbeats_sent_.load(std::memory_order_relaxed)) +
-                               " audio_playing=" + vc::util::BoolToString(audio_player_.IsPlaying()));
+                               " messages=" + std::to_string(messages_received_.value()) +
+                               " rings=" + std::to_string(ring_messages_received_.value()) +
+                               " ring_dedup_hits=" + std::to_string(ring_dedup_.hits()) +
+                               " ring_dedup_misses=" + std::to_string(ring_dedup_.misses()) +
+                               " loop_errors=" + std::to_string(loop_errors_.value()) +
+                               " reconnects=" + std::to_string(reconnect_attempts_.value()) +
+                               " heartbeats=" + std::to_string(heartbeats_sent_.value()) +
+                               " loop_wakeups=" + std::to_string(event_loop_.wakeups()) +
+                               " mqtt_backlog_bytes=" + std::to_string(mqtt_reads.backlog_bytes) +
+                               " mqtt_backlog_max=" + std::to_string(mqtt_reads.max_backlog_bytes) +
+                               " mqtt_max_batch=" + std::to_string(mqtt_reads.max_batch) +
+                               " mqtt_budget_hits=" + std::to_string(mqtt_reads.budget_exhausted) +
+                               " audio_playing=" + vc::util::BoolToString(audio_player_.IsPlaying()) +
+                               " cached_sounds=" + std::to_string(sound_cache_.Count()) +
+                               " mixer_control=" + (mixer_control.empty() ? "none" : mixer_control));
+}
+
+void ChimeService::UpdateMetricGauges() {
+    mqtt_connected_gauge_.Set(mqtt_connected_.load() ? 1 : 0);
+    mqtt_backlog_gauge_.Set(static_cast<int64_t>(mqtt_client_.read_stats().backlog_bytes));
+    cached_sounds_gauge_.Set(static_cast<int64_t>(sound_cache_.Count()));
+    observed_topics_gauge_.Set(static_cast<int64_t>(observed_topics_.size()));
+}
+
+void ChimeService::PublishMetrics() {
+    UpdateMetricGauges();
+    std::string payload = "{\"timestamp\":" + std::to_string(static_cast<long long>(std::time(nullptr))) +
+                          ",\"metrics\":" + metrics_.ToJson() + "}";
+    if (mqtt_connected_.load() && !config_.metrics_topic.empty()) {
+        if (!mqtt_client_.Publish(config_.metrics_topic, payload, 0, true)) {
+            logger_.Warn("metrics", mqtt_client_.LastError());
+        }
+        UpdateMqttWriteInterest();
+    }
+    if (!config_.metrics_path.empty()) {
+        metrics_file_.Update(std::move(payload));
+    }
 }
 
 } // namespace chime
@@ -0,0 +1,47 @@
+#include "chime/ring_dedup.h"
+
+#include <functional>
+
+namespace chime {
+namespace {
+
+uint64_t RingKey(std::string_view topic, std::string_view payload) {
+    const uint64_t topic_hash = std::hash<std::string_view>{}(topic);
+    const uint64_t payload_hash = std::hash<std::string_view>{}(payload);
+    // Order matters: a payload equal to another message's topic is a
+    // different ring.
+    return topic_hash ^ (payload_hash + 0x9e3779b97f4a7c15ULL + (topic_hash << 6) + (topic_hash >> 2));
+}
+
+} // namespace
+
+RingDeduplicator::RingDeduplicator(std::chrono::milliseconds window) : window_(window) {}
+
+bool RingDeduplicator::IsDuplicate(std::string_view topic, std::string_view payload,
+                                   std::chrono::steady_clock::time_point now) {
+    if (window_.count() <= 0) {
+        ++misses_;
+        return false;
+    }
+
+    const uint64_t key = RingKey(topic, payload);
+    for (std::size_t i = 0; i < used_; ++i) {
+        const Entry &entry = entries_[i];
+        if (entry.key == key && now - entry.accepted < window_) {
+            ++hits_;
+            return true;
+        }
+    }
+
+    // Oldest slot goes first; with kCapacity distinct rings inside one window
+    // the oldest may ring again early, which beats growing without bound.
+    entries_[next_] = Entry{key, now};
+    next_ = (next_ + 1) % kCapacity;
+    if (used_ < kCapacity) {
+        ++used_;
+    }
+    ++misses_;
+    return false;
+}
+
+} // namespace chime
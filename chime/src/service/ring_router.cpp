@@ -0,0 +1,65 @@
+#include "chime/ring_router.h"
+
+#include <utility>
+
+#include "chime/chime_config.h"
+
+namespace chime {
+
+void RingRouter::Build(const ChimeConfig &config, std::vector<std::string> *errors) {
+    routes_.clear();
+    last_fired_.clear();
+    matcher_.Clear();
+
+    std::vector<RingRoute> table = config.ring_routes;
+    if (table.empty()) {
+        table.push_back(RingRoute{config.ring_topic, config.sound_path, config.volume_bell, 0, 0});
+    }
+
+    for (const RingRoute &entry : table) {
+        std::string error;
+        if (!matcher_.Add(entry.topic_filter, routes_.size(), &error)) {
+            if (errors != nullptr) {
+                errors->push_back(error);
+            }
+            continue;
+        }
+
+        Route route;
+        route.topic_filter = entry.topic_filter;
+        route.sound_path = entry.sound.empty() || entry.sound.front() == '/'
+                               ? entry.sound
+                               : config.ring_sounds_dir + "/" + entry.sound;
+        route.volume = entry.volume < 0 ? config.volume_bell : entry.volume;
+        route.priority = entry.priority;
+        route.cooldown = std::chrono::milliseconds(entry.cooldown_ms);
+        routes_.push_back(std::move(route));
+    }
+    last_fired_.resize(routes_.size());
+}
+
+const RingRouter::Route *RingRouter::Match(std::string_view topic) const {
+    const Route *best = nullptr;
+    std::size_t best_index = 0;
+    matcher_.ForEachMatch(topic, [&](std::size_t index) {
+        const Route &route = routes_[index];
+        if (best == nullptr || route.priority > best->priority ||
+            (route.priority == best->priority && index < best_index)) {
+            best = &route;
+            best_index = index;
+        }
+    });
+    return best;
+}
+
+bool RingRouter::Admit(const Route &route, std::chrono::steady_clock::time_point now) {
+    const std::size_t index = static_cast<std::size_t>(&route - routes_.data());
+    auto &last = last_fired_[index];
+    if (route.cooldown.count() > 0 && last != std::chrono::steady_clock::time_point{} && now - last < route.cooldown) {
+        return false;
+    }
+    last = now;
+    return true;
+}
+
+} // namespace chime
@@ -21,6 +21,7 @@
 #include "chime/chime_config.h"
 #include "vc/config/kv_config.h"
 #include "vc/logging/logger.h"
+#include "vc/mqtt/topic_matcher.h"
 
 namespace chime::webd {
 namespace {
@@ -322,7 +323,8 @@ bool IsTopicValid(const std::string& topic) {
   if (topic.find('\t') != std::string::npos) {
     return false;
   }
-  return true;
+  // Topics are subscription filters; chime rejects malformed wildcards.
+  return vc::mqtt::IsValidTopicFilter(topic);
 }
 
 }  // namespace
@@ -333,9 +335,13 @@ ConfigStore::ConfigStore(vc::logging::Logger& logger, std::string chime_config_p
       chime_config_path_(std::move(chime_config_path)),
       wpa_supplicant_path_(std::move(wpa_supplicant_path)) {}
 
-SaveResult ConfigStore::LoadCoreConfig() const { return LoadCoreConfigInternal(); }
+SaveResult ConfigStore::LoadCoreConfig() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return LoadCoreConfigInternal();
+}
 
 SaveResult ConfigStore::SaveCoreConfig(const SaveRequest& request) {
+  std::lock_guard<std::mutex> lock(mutex_);
   SaveResult result;
   result.validation_errors = ValidateRequest(request);
   if (!result.validation_errors.empty()) {
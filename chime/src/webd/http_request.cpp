@@ -0,0 +1,154 @@
+#include "chime/webd_http_request.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#include "chime/webd_string_utils.h"
+#include "vc/config/kv_config.h"
+
+namespace chime::webd {
+namespace {
+
+constexpr std::size_t kMaxRequestBytes = 65536;
+constexpr std::size_t kMaxBodyBytes = 2 * 1024 * 1024;
+
+} // namespace
+
+bool ReadHttpRequest(const HttpReadFunction &read, std::chrono::steady_clock::time_point deadline,
+                     std::string *buffered, HttpRequest *request, std::string *error) {
+    if (!read || buffered == nullptr || request == nullptr || error == nullptr) {
+        return false;
+    }
+
+    std::string &data = *buffered;
+    data.reserve(2048);
+
+    std::size_t headers_end = data.find("\r\n\r\n");
+    while (headers_end == std::string::npos) {
+        if (data.size() >= kMaxRequestBytes) {
+            *error = "request too large";
+            return false;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            *error = "request timed out";
+            return false;
+        }
+
+        std::array<char, 2048> buffer{};
+        const int bytes = read(buffer.data(), static_cast<int>(buffer.size()));
+        if (bytes <= 0) {
+            // A client closing an idle connection is not an error.
+            *error = data.empty() ? "" : "failed to read request";
+            return false;
+        }
+
+        data.append(buffer.data(), static_cast<std::size_t>(bytes));
+        headers_end = data.find("\r\n\r\n");
+    }
+
+    const std::string header_blob = data.substr(0, headers_end);
+    std::istringstream header_stream(header_blob);
+
+    std::string request_line;
+    if (!std::getline(header_stream, request_line)) {
+        *error = "missing request line";
+        return false;
+    }
+    if (!request_line.empty() && request_line.back() == '\r') {
+        request_line.pop_back();
+    }
+
+    std::istringstream request_line_stream(request_line);
+    std::string method;
+    std::string path;
+    std::string version;
+    request_line_stream >> method >> path >> version;
+    if (method.empty() || path.empty() || version.empty()) {
+        *error = "invalid request line";
+        return false;
+    }
+
+    std::map<std::string, std::string> headers;
+    std::string header_line;
+    while (std::getline(header_stream, header_line)) {
+        if (!header_line.empty() && header_line.back() == '\r') {
+            header_line.pop_back();
+        }
+        const auto sep = header_line.find(':');
+        if (sep == std::string::npos) {
+            continue;
+        }
+        const std::string key = ToLower(vc::config::trim(header_line.substr(0, sep)));
+        const std::string value = vc::config::trim(header_line.substr(sep + 1));
+        headers[key] = value;
+    }
+
+    std::size_t content_length = 0;
+    const auto content_length_it = headers.find("content-length");
+    if (content_length_it != headers.end()) {
+        char *end = nullptr;
+        const long parsed = std::strtol(content_length_it->second.c_str(), &end, 10);
+        if (end == nullptr || *end != '\0' || parsed < 0) {
+            *error = "invalid Content-Length";
+            return false;
+        }
+        content_length = static_cast<std::size_t>(parsed);
+    }
+
+    if (content_length > kMaxBodyBytes) {
+        *error = "request body too large";
+        return false;
+    }
+    // Without a length the end of a chunked body is unknown, and so is where
+    // the next request starts.
+    if (headers.find("transfer-encoding") != headers.end()) {
+        *error = "Transfer-Encoding not supported";
+        return false;
+    }
+
+    const std::size_t body_begin = headers_end + 4;
+    while (data.size() - body_begin < content_length) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            *error = "request timed out";
+            return false;
+        }
+        std::array<char, 2048> buffer{};
+        const int bytes = read(buffer.data(), static_cast<int>(buffer.size()));
+        if (bytes <= 0) {
+            *error = "failed to read request body";
+            return false;
+        }
+        data.append(buffer.data(), static_cast<std::size_t>(bytes));
+    }
+
+    std::string body = data.substr(body_begin, content_length);
+    // Anything after the body is the start of a pipelined request.
+    data.erase(0, body_begin + content_length);
+
+    const auto query = path.find('?');
+    if (query != std::string::npos) {
+        path = path.substr(0, query);
+    }
+
+    request->method = method;
+    request->path = path;
+    request->body = std::move(body);
+    const auto content_type_it = headers.find("content-type");
+    request->has_content_type = content_type_it != headers.end();
+    request->content_type = content_type_it != headers.end() ? content_type_it->second : "";
+    const auto connection_it = headers.find("connection");
+    const std::string connection = connection_it != headers.end() ? ToLower(connection_it->second) : "";
+    const auto accept_encoding_it = headers.find("accept-encoding");
+    request->accept_encoding = accept_encoding_it != headers.end() ? accept_encoding_it->second : "";
+    const auto if_none_match_it = headers.find("if-none-match");
+    request->if_none_match = if_none_match_it != headers.end() ? if_none_match_it->second : "";
+    request->keep_alive = version == "HTTP/1.1" ? connection.find("close") == std::string::npos
+                                                : connection.find("keep-alive") != std::string::npos;
+    return true;
+}
+
+} // namespace chime::webd
@@ -24,7 +24,9 @@ constexpr const char *kChimeConfigPath = "/etc/chime.conf";
 constexpr const char *kWpaSupplicantPath = "/etc/wpa_supplicant/wpa_supplicant.conf";
 constexpr const char *kTlsCertPath = "/etc/chime-web/tls/cert.pem";
 constexpr const char *kTlsKeyPath = "/etc/chime-web/tls/key.pem";
-constexpr const char *kUiDistDir = "/usr/local/share/chime-web-ui/dist";
+constexpr const char *kTlsKeyType = "rsa";
+// Empty: serve the web UI embedded at build time.
+constexpr const char *kUiDistDir = "";
 constexpr const char *kBindAddress = "0.0.0.0";
 constexpr int kListenPort = 8443;
 constexpr const char *kHostLabel = "chime";
@@ -33,6 +35,8 @@ constexpr const char *kChimeRestartCommand = "/etc/init.d/S99chime restart >/dev
 constexpr const char *kObservedTopicsPath = "/var/lib/chime/observed_topics.txt";
 constexpr const char *kRingSoundsDir = "/var/lib/chime/ring_sounds";
 constexpr const char *kActiveRingSoundPath = "/usr/local/share/chime/ring.wav";
+constexpr const char *kMetricsPath = "/var/run/chime_metrics.json";
+constexpr const char *kStatsSegmentPath = "/dev/shm/chime_stats";
 
 std::string EnvOrDefault(const char *key, const char *fallback) {
     const std::string value = vc::util::GetEnv(key);
@@ -145,10 +149,13 @@ int main(int argc, char *argv[]) {
     const std::string wpa_supplicant_path = EnvOrDefault("CHIME_WEBD_WPA_SUPPLICANT", kWpaSupplicantPath);
     const std::string tls_cert_path = EnvOrDefault("CHIME_WEBD_TLS_CERT", kTlsCertPath);
     const std::string tls_key_path = EnvOrDefault("CHIME_WEBD_TLS_KEY", kTlsKeyPath);
+    const std::string tls_key_type_name = EnvOrDefault("CHIME_WEBD_TLS_KEY_TYPE", kTlsKeyType);
     const std::string ui_dist_dir = EnvOrDefault("CHIME_WEBD_UI_DIST_DIR", kUiDistDir);
     const std::string observed_topics_path = EnvOrDefault("CHIME_WEBD_OBSERVED_TOPICS_PATH", kObservedTopicsPath);
     const std::string ring_sounds_dir = EnvOrDefault("CHIME_WEBD_RING_SOUNDS_DIR", kRingSoundsDir);
     const std::string active_ring_sound_path = EnvOrDefault("CHIME_WEBD_ACTIVE_RING_SOUND", kActiveRingSoundPath);
+    const std::string metrics_path = EnvOrDefault("CHIME_WEBD_METRICS_PATH", kMetricsPath);
+    const std::string stats_segment_path = EnvOrDefault("CHIME_WEBD_STATS_SEGMENT_PATH", kStatsSegmentPath);
     const std::string bind_address = EnvOrDefault("CHIME_WEBD_BIND_ADDRESS", kBindAddress);
     const int listen_port = EnvIntOrDefault("CHIME_WEBD_PORT", kListenPort);
     const std::string host_label = EnvOrDefault("CHIME_WEBD_HOST_LABEL", kHostLabel);
@@ -159,12 +166,19 @@ int main(int argc, char *argv[]) {
     const std::string chime_restart_command = EnvOrDefault("CHIME_WEBD_CHIME_RESTART_CMD", kChimeRestartCommand);
     const bool mdns_enabled = EnvBoolOrDefault("CHIME_WEBD_MDNS_ENABLED", true);
 
+    chime::webd::TlsKeyType tls_key_type = chime::webd::TlsKeyType::kRsa2048;
+    if (tls_key_type_name == "ecdsa") {
+        tls_key_type = chime::webd::TlsKeyType::kEcdsaP256;
+    } else if (tls_key_type_name != "rsa") {
+        logger.Warn("webd", "unknown CHIME_WEBD_TLS_KEY_TYPE '" + tls_key_type_name + "', using rsa");
+    }
+
     chime::webd::ConfigStore config_store(logger, chime_config_path, wpa_supplicant_path);
     chime::webd::WifiScanner wifi_scanner(logger, wifi_interface);
     chime::webd::ApplyManager apply_manager(logger, network_restart_command, chime_restart_command);
     chime::webd::WebServer web_server(logger, config_store, wifi_scanner, apply_manager, bind_address, listen_port,
-                                      tls_cert_path, tls_key_path, ui_dist_dir, observed_topics_path, ring_sounds_dir,
-                                      active_ring_sound_path);
+                                      tls_cert_path, tls_key_path, tls_key_type, ui_dist_dir, observed_topics_path,
+                                      ring_sounds_dir, active_ring_sound_path, metrics_path, stats_segment_path);
     chime::webd::MdnsResponder mdns(logger, host_label, wifi_interface);
 
     if (!web_server.Start()) {
@@ -2,6 +2,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+
+#include "vc/config/kv_config.h"
 
 namespace chime::webd {
 
@@ -12,4 +17,44 @@ std::string ToLower(const std::string &value) {
     return lowered;
 }
 
+bool AcceptsEncoding(const std::string &header, const std::string &coding) {
+    std::optional<bool> wildcard;
+    std::stringstream stream(header);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const std::size_t semicolon = item.find(';');
+        const std::string name = ToLower(vc::config::trim(item.substr(0, semicolon)));
+        bool acceptable = true;
+        if (semicolon != std::string::npos) {
+            const std::string params = ToLower(item.substr(semicolon + 1));
+            const std::size_t q = params.find("q=");
+            if (q != std::string::npos) {
+                acceptable = std::strtod(params.c_str() + q + 2, nullptr) > 0.0;
+            }
+        }
+        if (name == coding) {
+            return acceptable;
+        }
+        if (name == "*") {
+            wildcard = acceptable;
+        }
+    }
+    return wildcard.value_or(false);
+}
+
+bool EtagListMatches(const std::string &header, std::string_view etag) {
+    std::stringstream stream(header);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::string tag = vc::config::trim(item);
+        if (tag.rfind("W/", 0) == 0) {
+            tag = tag.substr(2);
+        }
+        if (tag == "*" || tag == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
 } // namespace chime::webd
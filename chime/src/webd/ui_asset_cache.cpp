@@ -0,0 +1,262 @@
+#include "chime/webd_ui_asset_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <utility>
+
+#include <zlib.h>
+
+#include "chime/webd_string_utils.h"
+
+namespace chime::webd {
+namespace {
+
+// A compressed copy is kept only if it saves at least this fraction of the
+// original; otherwise decompressing it costs the client more than it saves.
+constexpr std::size_t kMinSavingsDivisor = 10;
+
+std::string ContentTypeForPath(const std::filesystem::path &path) {
+    const std::string extension = ToLower(path.extension().string());
+    if (extension == ".html") {
+        return "text/html; charset=utf-8";
+    }
+    if (extension == ".css") {
+        return "text/css; charset=utf-8";
+    }
+    if (extension == ".js") {
+        return "application/javascript; charset=utf-8";
+    }
+    if (extension == ".json") {
+        return "application/json; charset=utf-8";
+    }
+    if (extension == ".svg") {
+        return "image/svg+xml";
+    }
+    if (extension == ".ico") {
+        return "image/x-icon";
+    }
+    if (extension == ".png") {
+        return "image/png";
+    }
+    if (extension == ".jpg" || extension == ".jpeg") {
+        return "image/jpeg";
+    }
+    if (extension == ".webp") {
+        return "image/webp";
+    }
+    if (extension == ".woff2") {
+        return "font/woff2";
+    }
+    if (extension == ".woff") {
+        return "font/woff";
+    }
+    return "application/octet-stream";
+}
+
+std::string CacheControlForPath(const std::string &request_path, const std::filesystem::path &path) {
+    if (ToLower(path.extension().string()) == ".html") {
+        return "no-cache";
+    }
+    if (request_path.rfind("/assets/", 0) == 0) {
+        return "public, max-age=31536000, immutable";
+    }
+    return "public, max-age=3600";
+}
+
+// Images and fonts other than SVG and icons are compressed already.
+bool IsCompressible(const std::string &content_type) {
+    return content_type.rfind("text/", 0) == 0 || content_type.rfind("application/javascript", 0) == 0 ||
+           content_type.rfind("application/json", 0) == 0 || content_type == "image/svg+xml" ||
+           content_type == "image/x-icon";
+}
+
+bool WorthKeeping(const std::string &compressed, const std::string &original) {
+    return !compressed.empty() && compressed.size() < original.size() - original.size() / kMinSavingsDivisor;
+}
+
+bool ReadFile(const std::filesystem::path &path, std::string *body) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    *body = stream.str();
+    return true;
+}
+
+bool Gzip(const std::string &input, std::string *output) {
+    z_stream stream{};
+    // 16 on top of the window bits selects the gzip wrapper.
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    output->resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef *>(output->data());
+    stream.avail_out = static_cast<uInt>(output->size());
+    const int result = deflate(&stream, Z_FINISH);
+    output->resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+std::string ContentHash(const std::string &data) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+bool HasSuffix(const std::string &value, const std::string &suffix) {
+    return value.size() > suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// `<file>.br` and `<file>.gz` next to `<file>` are its precompressed
+// variants, not assets of their own.
+bool IsPrecompressedCopy(const std::string &request_path, const std::set<std::string> &files) {
+    for (const std::string suffix : {".br", ".gz"}) {
+        if (HasSuffix(request_path, suffix) &&
+            files.count(request_path.substr(0, request_path.size() - suffix.size())) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool UiAssetCache::Load(const std::string &dist_dir, std::string *error) {
+    entries_.clear();
+    totals_ = Totals{};
+
+    const std::filesystem::path root(dist_dir);
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec)) {
+        return true;
+    }
+
+    std::set<std::string> files;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            files.insert("/" + it->path().lexically_relative(root).generic_string());
+        }
+    }
+    if (ec) {
+        if (error != nullptr) {
+            *error = "failed to list " + dist_dir + ": " + ec.message();
+        }
+        return false;
+    }
+
+    auto read = [&](const std::string &request_path, std::string *body) {
+        if (ReadFile(root / request_path.substr(1), body)) {
+            return true;
+        }
+        if (error != nullptr) {
+            *error = "failed to read " + (root / request_path.substr(1)).string();
+        }
+        entries_.clear();
+        totals_ = Totals{};
+        return false;
+    };
+
+    for (const std::string &request_path : files) {
+        if (IsPrecompressedCopy(request_path, files)) {
+            continue;
+        }
+        const std::filesystem::path file_path(request_path);
+        Entry &entry = entries_[request_path];
+        entry.content_type = ContentTypeForPath(file_path);
+        entry.cache_control = CacheControlForPath(request_path, file_path);
+        if (!read(request_path, &entry.identity)) {
+            return false;
+        }
+        const std::string hash = ContentHash(entry.identity);
+        entry.identity_etag = "\"" + hash + "\"";
+
+        if (IsCompressible(entry.content_type)) {
+            if (files.count(request_path + ".br") != 0 && !read(request_path + ".br", &entry.brotli)) {
+                return false;
+            }
+            if (files.count(request_path + ".gz") != 0) {
+                if (!read(request_path + ".gz", &entry.gzip)) {
+                    return false;
+                }
+            } else if (!Gzip(entry.identity, &entry.gzip)) {
+                entry.gzip.clear();
+            }
+            if (!WorthKeeping(entry.brotli, entry.identity)) {
+                entry.brotli.clear();
+            }
+            if (!WorthKeeping(entry.gzip, entry.identity)) {
+                entry.gzip.clear();
+            }
+        }
+        if (!entry.gzip.empty()) {
+            entry.gzip_etag = "\"" + hash + "-gzip\"";
+        }
+        if (!entry.brotli.empty()) {
+            entry.brotli_etag = "\"" + hash + "-br\"";
+        }
+
+        ++totals_.files;
+        totals_.identity_bytes += entry.identity.size();
+        totals_.gzip_bytes += entry.gzip.size();
+        totals_.brotli_bytes += entry.brotli.size();
+    }
+
+    for (auto &[path, entry] : entries_) {
+        entry.asset = UiAsset{path,
+                              entry.content_type,
+                              entry.cache_control,
+                              {entry.identity, entry.identity_etag},
+                              {entry.gzip, entry.gzip_etag},
+                              {entry.brotli, entry.brotli_etag}};
+    }
+    return true;
+}
+
+const UiAsset *UiAssetCache::Find(std::string_view request_path) const {
+    const auto it = entries_.find(std::string(request_path == "/" ? "/index.html" : request_path));
+    return it != entries_.end() ? &it->second.asset : nullptr;
+}
+
+void UiAssetCache::ForEach(const std::function<void(const UiAsset &)> &visit) const {
+    for (const auto &[path, entry] : entries_) {
+        visit(entry.asset);
+    }
+}
+
+UiAssetChoice ChooseUiAssetVariant(const UiAsset &asset, const std::string &accept_encoding,
+                                   const std::string &if_none_match) {
+    UiAssetChoice choice;
+    choice.variant = &asset.identity;
+    if (!asset.brotli.body.empty() && AcceptsEncoding(accept_encoding, "br")) {
+        choice.variant = &asset.brotli;
+        choice.content_encoding = "br";
+    } else if (!asset.gzip.body.empty() && AcceptsEncoding(accept_encoding, "gzip")) {
+        choice.variant = &asset.gzip;
+        choice.content_encoding = "gzip";
+    }
+    choice.vary_accept_encoding = !asset.brotli.body.empty() || !asset.gzip.body.empty();
+
+    // Any encoding of the same bytes will do; the client has the content.
+    choice.not_modified = !if_none_match.empty() &&
+                          (EtagListMatches(if_none_match, asset.identity.etag) ||
+                           (!asset.gzip.etag.empty() && EtagListMatches(if_none_match, asset.gzip.etag)) ||
+                           (!asset.brotli.etag.empty() && EtagListMatches(if_none_match, asset.brotli.etag)));
+    return choice;
+}
+
+} // namespace chime::webd
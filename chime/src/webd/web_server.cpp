@@ -6,45 +6,73 @@
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 #include <openssl/bn.h>
+#include <openssl/ec.h>
 #include <openssl/err.h>
 #include <openssl/pem.h>
 #include <openssl/ssl.h>
 #include <openssl/x509.h>
 
+#include "chime/observed_topics.h"
 #include "chime/webd_apply_manager.h"
 #include "chime/webd_config_store.h"
+#include "chime/webd_embedded_ui.h"
+#include "chime/webd_http_request.h"
 #include "chime/webd_json.h"
 #include "chime/webd_string_utils.h"
+#include "chime/webd_ui_asset_cache.h"
 #include "chime/webd_ui_assets.h"
 #include "chime/webd_wifi_scan.h"
 #include "vc/config/kv_config.h"
 #include "vc/logging/logger.h"
+#include "vc/metrics/prometheus.h"
+#include "vc/metrics/stats_segment.h"
 
 namespace chime::webd {
 namespace {
 
-constexpr std::size_t kMaxRequestBytes = 65536;
-constexpr std::size_t kMaxBodyBytes = 2 * 1024 * 1024;
+constexpr std::size_t kWorkerThreads = 4;
+// Connections beyond this many waiting for a worker are closed at once.
+constexpr std::size_t kMaxPendingConnections = 16;
+// Longest a socket read or write may block.
+constexpr std::chrono::seconds kSocketTimeout{5};
+// Time a client gets to complete the TLS handshake and deliver a complete
+// request, counted from accept() or, on a kept-alive connection, from its
+// first byte.
+constexpr std::chrono::seconds kRequestDeadline{15};
+// Keep-alive limits. An idle connection is also closed as soon as another
+// connection is waiting for a worker.
+constexpr int kMaxRequestsPerConnection = 100;
+constexpr std::chrono::seconds kKeepAliveIdleTimeout{5};
+constexpr std::chrono::milliseconds kIdlePollSlice{100};
+// Sessions for the handful of browsers that talk to one chime; resumed
+// sessions skip the certificate signature.
+constexpr long kTlsSessionCacheSize = 128;
+constexpr long kTlsSessionLifetimeSeconds = 12 * 60 * 60;
 constexpr const char *kDefaultRingSoundName = "ring-default.wav";
 constexpr const char *kReleaseInfoPath = "/etc/virtualchime-release";
 constexpr const char *kAppVersionPath = "/etc/chime-app-version";
@@ -68,6 +96,29 @@ bool IsSafeRelativePath(const std::filesystem::path &path) {
     return true;
 }
 
+bool HasSoundExtension(const std::string &lowered) {
+    for (const std::string extension : {".wav", ".flac", ".opus", ".ogg"}) {
+        if (lowered.size() > extension.size() &&
+            lowered.compare(lowered.size() - extension.size(), extension.size(), extension) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsSoundMimeType(const std::string &mime_type) {
+    return mime_type == "audio/wav" || mime_type == "audio/x-wav" || mime_type == "audio/flac" ||
+           mime_type == "audio/x-flac" || mime_type == "audio/ogg" || mime_type == "audio/opus";
+}
+
+// The chime daemon detects the container from these bytes, not the name.
+bool HasSoundMagic(const std::string &body) {
+    if (body.size() >= 12 && body.rfind("RIFF", 0) == 0 && body.compare(8, 4, "WAVE") == 0) {
+        return true;
+    }
+    return body.rfind("fLaC", 0) == 0 || body.rfind("OggS", 0) == 0;
+}
+
 bool IsSafeSoundName(const std::string &file_name) {
     if (file_name.empty() || file_name.size() > 128) {
         return false;
@@ -79,7 +130,7 @@ bool IsSafeSoundName(const std::string &file_name) {
         return false;
     }
     const std::string lowered = ToLower(file_name);
-    if (!StartsWith(lowered, "ring-") || lowered.rfind(".wav") != lowered.size() - 4) {
+    if (!StartsWith(lowered, "ring-") || !HasSoundExtension(lowered)) {
         return false;
     }
     for (const char c : file_name) {
@@ -176,54 +227,6 @@ void TrySeedDefaultRingSound(const std::string &ring_sounds_dir, const std::stri
     }
 }
 
-std::string ContentTypeForPath(const std::filesystem::path &path) {
-    const std::string extension = ToLower(path.extension().string());
-    if (extension == ".html") {
-        return "text/html; charset=utf-8";
-    }
-    if (extension == ".css") {
-        return "text/css; charset=utf-8";
-    }
-    if (extension == ".js") {
-        return "application/javascript; charset=utf-8";
-    }
-    if (extension == ".json") {
-        return "application/json; charset=utf-8";
-    }
-    if (extension == ".svg") {
-        return "image/svg+xml";
-    }
-    if (extension == ".ico") {
-        return "image/x-icon";
-    }
-    if (extension == ".png") {
-        return "image/png";
-    }
-    if (extension == ".jpg" || extension == ".jpeg") {
-        return "image/jpeg";
-    }
-    if (extension == ".webp") {
-        return "image/webp";
-    }
-    if (extension == ".woff2") {
-        return "font/woff2";
-    }
-    if (extension == ".woff") {
-        return "font/woff";
-    }
-    return "application/octet-stream";
-}
-
-std::string CacheControlForPath(const std::string &request_path, const std::filesystem::path &path) {
-    if (ToLower(path.extension().string()) == ".html") {
-        return "no-cache";
-    }
-    if (StartsWith(request_path, "/assets/")) {
-        return "public, max-age=31536000, immutable";
-    }
-    return "public, max-age=3600";
-}
-
 bool ReadFile(const std::filesystem::path &path, std::string *body) {
     if (body == nullptr) {
         return false;
@@ -238,8 +241,14 @@ bool ReadFile(const std::filesystem::path &path, std::string *body) {
     return true;
 }
 
-std::vector<std::string> ReadObservedTopicsFromFile(const std::string &path, std::string *error) {
-    std::vector<std::string> topics;
+struct ObservedTopic {
+    std::string topic;
+    ObservedTopicStats stats;
+};
+
+// Most recently seen first, as chime writes them.
+std::vector<ObservedTopic> ReadObservedTopicsFromFile(const std::string &path, std::string *error) {
+    std::vector<ObservedTopic> topics;
     std::ifstream file(path);
     if (!file.is_open()) {
         if (std::filesystem::exists(path)) {
@@ -252,13 +261,13 @@ std::vector<std::string> ReadObservedTopicsFromFile(const std::string &path, std
 
     std::set<std::string> seen;
     std::string line;
+    ObservedTopic entry;
     while (std::getline(file, line)) {
-        const std::string topic = vc::config::trim(line);
-        if (topic.empty()) {
+        if (!ParseObservedTopicLine(line, &entry.topic, &entry.stats)) {
             continue;
         }
-        if (seen.insert(topic).second) {
-            topics.push_back(topic);
+        if (seen.insert(entry.topic).second) {
+            topics.push_back(entry);
         }
     }
     return topics;
@@ -318,6 +327,8 @@ std::string StatusText(int code) {
     switch (code) {
     case 200:
         return "OK";
+    case 304:
+        return "Not Modified";
     case 400:
         return "Bad Request";
     case 404:
@@ -348,6 +359,48 @@ bool WriteAllSsl(SSL *ssl, const std::string &data) {
     return true;
 }
 
+// Runs the TLS handshake on a non-blocking socket so that a client trickling
+// handshake bytes cannot hold a worker past `deadline`; the socket timeouts
+// alone only bound each read or write. The socket is blocking again on
+// return.
+bool AcceptTls(SSL *ssl, int fd, std::chrono::steady_clock::time_point deadline) {
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return false;
+    }
+
+    bool accepted = false;
+    while (true) {
+        const int rc = SSL_accept(ssl);
+        if (rc == 1) {
+            accepted = true;
+            break;
+        }
+        struct pollfd poll_fd{};
+        poll_fd.fd = fd;
+        const int error = SSL_get_error(ssl, rc);
+        if (error == SSL_ERROR_WANT_READ) {
+            poll_fd.events = POLLIN;
+        } else if (error == SSL_ERROR_WANT_WRITE) {
+            poll_fd.events = POLLOUT;
+        } else {
+            break;
+        }
+
+        const auto remaining =
+            std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+        const int ready = poll(&poll_fd, 1, static_cast<int>(remaining.count()));
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+    }
+
+    return fcntl(fd, F_SETFL, flags) == 0 && accepted;
+}
+
 std::optional<std::string> ReadRequiredString(const JsonValue &object, const std::string &key,
                                               std::vector<ValidationError> *errors) {
     const auto field = GetObjectField(object, key);
@@ -498,6 +551,24 @@ std::string SerializeTopics(const std::vector<std::string> &topics) {
     return output;
 }
 
+std::string SerializeObservedTopics(const std::vector<ObservedTopic> &topics) {
+    std::string names = "[";
+    std::string details = "[";
+    for (std::size_t i = 0; i < topics.size(); ++i) {
+        const ObservedTopic &entry = topics[i];
+        if (i > 0) {
+            names += ",";
+            details += ",";
+        }
+        names += JsonString(entry.topic);
+        details += "{\"topic\":" + JsonString(entry.topic) +
+                   ",\"first_seen\":" + std::to_string(static_cast<long long>(entry.stats.first_seen)) +
+                   ",\"last_seen\":" + std::to_string(static_cast<long long>(entry.stats.last_seen)) +
+                   ",\"messages\":" + std::to_string(entry.stats.messages) + "}";
+    }
+    return "\"topics\":" + names + "],\"details\":" + details + "]";
+}
+
 std::string SerializeApplyStatus(const ApplyStatus &status) {
     std::string output = "{";
     output += "\"job_id\":" + std::to_string(status.job_id) + ",";
@@ -509,22 +580,42 @@ std::string SerializeApplyStatus(const ApplyStatus &status) {
     return output;
 }
 
-bool GenerateSelfSignedCertificate(const std::string &cert_path, const std::string &key_path, std::string *error) {
+const char *TlsKeyTypeName(TlsKeyType type) {
+    return type == TlsKeyType::kEcdsaP256 ? "ECDSA P-256" : "RSA";
+}
+
+std::optional<TlsKeyType> ReadCertificateKeyType(const std::string &cert_path) {
+    FILE *cert_file = fopen(cert_path.c_str(), "r");
+    if (cert_file == nullptr) {
+        return std::nullopt;
+    }
+    X509 *cert = PEM_read_X509(cert_file, nullptr, nullptr, nullptr);
+    fclose(cert_file);
+    if (cert == nullptr) {
+        return std::nullopt;
+    }
+    std::optional<TlsKeyType> type;
+    const EVP_PKEY *pkey = X509_get0_pubkey(cert);
+    if (pkey != nullptr && EVP_PKEY_base_id(pkey) == EVP_PKEY_EC) {
+        type = TlsKeyType::kEcdsaP256;
+    } else if (pkey != nullptr && EVP_PKEY_base_id(pkey) == EVP_PKEY_RSA) {
+        type = TlsKeyType::kRsa2048;
+    }
+    X509_free(cert);
+    return type;
+}
+
+EVP_PKEY *GenerateRsaKey(std::string *error) {
     EVP_PKEY *pkey = EVP_PKEY_new();
     if (pkey == nullptr) {
         if (error != nullptr) {
             *error = "EVP_PKEY_new failed";
         }
-        return false;
+        return nullptr;
     }
 
     RSA *rsa = RSA_new();
     BIGNUM *exponent = BN_new();
-    X509 *cert = nullptr;
-    X509_NAME *name = nullptr;
-    FILE *key_file = nullptr;
-    FILE *cert_file = nullptr;
-
     bool success = false;
 
     if (rsa == nullptr || exponent == nullptr) {
@@ -555,6 +646,50 @@ bool GenerateSelfSignedCertificate(const std::string &cert_path, const std::stri
         goto cleanup;
     }
     rsa = nullptr;
+    success = true;
+
+cleanup:
+    if (rsa != nullptr) {
+        RSA_free(rsa);
+    }
+    if (exponent != nullptr) {
+        BN_free(exponent);
+    }
+    if (!success) {
+        EVP_PKEY_free(pkey);
+        return nullptr;
+    }
+    return pkey;
+}
+
+EVP_PKEY *GenerateEcdsaP256Key(std::string *error) {
+    EVP_PKEY *pkey = nullptr;
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    if (ctx == nullptr || EVP_PKEY_keygen_init(ctx) != 1 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, NID_X9_62_prime256v1) != 1 || EVP_PKEY_keygen(ctx, &pkey) != 1) {
+        if (error != nullptr) {
+            *error = "P-256 key generation failed";
+        }
+        EVP_PKEY_free(pkey);
+        pkey = nullptr;
+    }
+    EVP_PKEY_CTX_free(ctx);
+    return pkey;
+}
+
+bool GenerateSelfSignedCertificate(const std::string &cert_path, const std::string &key_path, TlsKeyType key_type,
+                                   std::string *error) {
+    EVP_PKEY *pkey = key_type == TlsKeyType::kEcdsaP256 ? GenerateEcdsaP256Key(error) : GenerateRsaKey(error);
+    if (pkey == nullptr) {
+        return false;
+    }
+
+    X509 *cert = nullptr;
+    X509_NAME *name = nullptr;
+    FILE *key_file = nullptr;
+    FILE *cert_file = nullptr;
+
+    bool success = false;
 
     cert = X509_new();
     if (cert == nullptr) {
@@ -624,12 +759,6 @@ cleanup:
     if (cert_file != nullptr) {
         fclose(cert_file);
     }
-    if (rsa != nullptr) {
-        RSA_free(rsa);
-    }
-    if (exponent != nullptr) {
-        BN_free(exponent);
-    }
     if (cert != nullptr) {
         X509_free(cert);
     }
@@ -642,13 +771,15 @@ cleanup:
 
 WebServer::WebServer(vc::logging::Logger &logger, ConfigStore &config_store, WifiScanner &wifi_scanner,
                      ApplyManager &apply_manager, std::string bind_address, int port, std::string cert_path,
-                     std::string key_path, std::string ui_dist_dir, std::string observed_topics_path,
-                     std::string ring_sounds_dir, std::string active_ring_sound_path)
+                     std::string key_path, TlsKeyType tls_key_type, std::string ui_dist_dir,
+                     std::string observed_topics_path, std::string ring_sounds_dir, std::string active_ring_sound_path,
+                     std::string metrics_path, std::string stats_segment_path)
     : logger_(logger), config_store_(config_store), wifi_scanner_(wifi_scanner), apply_manager_(apply_manager),
       bind_address_(std::move(bind_address)), port_(port), cert_path_(std::move(cert_path)),
-      key_path_(std::move(key_path)), ui_dist_dir_(std::move(ui_dist_dir)),
+      key_path_(std::move(key_path)), tls_key_type_(tls_key_type), ui_dist_dir_(std::move(ui_dist_dir)),
       observed_topics_path_(std::move(observed_topics_path)), ring_sounds_dir_(std::move(ring_sounds_dir)),
-      active_ring_sound_path_(std::move(active_ring_sound_path)) {}
+      active_ring_sound_path_(std::move(active_ring_sound_path)), metrics_path_(std::move(metrics_path)),
+      stats_segment_path_(std::move(stats_segment_path)) {}
 
 WebServer::~WebServer() {
     Stop();
@@ -665,6 +796,23 @@ bool WebServer::Start() {
         return false;
     }
 
+    if (!ui_dist_dir_.empty()) {
+        if (!ui_assets_.Load(ui_dist_dir_, &error)) {
+            logger_.Warn("webd", "web UI assets not loaded from " + ui_dist_dir_ + ": " + error);
+        } else if (!ui_assets_.empty()) {
+            const UiAssetCache::Totals totals = ui_assets_.totals();
+            logger_.Info("webd", "cached " + std::to_string(totals.files) + " web UI files from " + ui_dist_dir_ +
+                                     ": " + std::to_string(totals.identity_bytes) + " bytes, " +
+                                     std::to_string(totals.gzip_bytes) + " gzip, " +
+                                     std::to_string(totals.brotli_bytes) + " brotli");
+        }
+    }
+    if (ui_assets_.empty()) {
+        logger_.Info("webd", EmbeddedUiAssetCount() > 0
+                                 ? "serving " + std::to_string(EmbeddedUiAssetCount()) + " embedded web UI files"
+                                 : std::string("no web UI embedded, serving fallback page"));
+    }
+
     SSL_load_error_strings();
     OpenSSL_add_ssl_algorithms();
 
@@ -676,6 +824,19 @@ bool WebServer::Start() {
 
     SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
 
+    // Browsers open several connections per page load and reconnect after
+    // every keep-alive timeout; resuming a session skips the certificate
+    // signature, the expensive part of a handshake on this hardware.
+    // TLS 1.3 and ticket-capable TLS 1.2 clients get stateless tickets, the
+    // rest are looked up in the server-side cache. Ticket keys are random
+    // per process, so a restart only costs one full handshake per client.
+    static constexpr unsigned char kSessionIdContext[] = "chime-webd";
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, kTlsSessionCacheSize);
+    SSL_CTX_set_timeout(ctx, kTlsSessionLifetimeSeconds);
+    SSL_CTX_set_session_id_context(ctx, kSessionIdContext, sizeof(kSessionIdContext) - 1);
+    SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+
     if (SSL_CTX_use_certificate_file(ctx, cert_path_.c_str(), SSL_FILETYPE_PEM) != 1) {
         logger_.Error("webd", "failed to load TLS certificate from " + cert_path_);
         SSL_CTX_free(ctx);
@@ -727,6 +888,9 @@ bool WebServer::Start() {
 
     ssl_ctx_ = ctx;
     running_.store(true);
+    for (std::size_t i = 0; i < kWorkerThreads; ++i) {
+        workers_.emplace_back([this]() { WorkerLoop(); });
+    }
     accept_thread_ = std::thread([this]() { AcceptLoop(); });
 
     logger_.Info("webd", "https server listening on " + bind_address_ + ":" + std::to_string(port_));
@@ -748,6 +912,23 @@ void WebServer::Stop() {
         accept_thread_.join();
     }
 
+    {
+        // Taken so a worker cannot miss the wake-up between checking
+        // running_ and starting to wait.
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+    }
+    connections_ready_.notify_all();
+    for (auto &worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    for (const int client_fd : pending_connections_) {
+        close(client_fd);
+    }
+    pending_connections_.clear();
+
     if (ssl_ctx_ != nullptr) {
         SSL_CTX_free(static_cast<SSL_CTX *>(ssl_ctx_));
         ssl_ctx_ = nullptr;
@@ -773,11 +954,42 @@ void WebServer::AcceptLoop() {
             continue;
         }
 
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            if (pending_connections_.size() < kMaxPendingConnections) {
+                pending_connections_.push_back(client_fd);
+                connections_ready_.notify_one();
+                continue;
+            }
+        }
+        logger_.Warn("webd", "all workers busy, dropping connection");
+        close(client_fd);
+    }
+}
+
+void WebServer::WorkerLoop() {
+    while (true) {
+        int client_fd = -1;
+        {
+            std::unique_lock<std::mutex> lock(connections_mutex_);
+            connections_ready_.wait(lock, [this]() { return !running_.load() || !pending_connections_.empty(); });
+            if (!running_.load()) {
+                return;
+            }
+            client_fd = pending_connections_.front();
+            pending_connections_.pop_front();
+        }
         HandleConnection(client_fd);
     }
 }
 
 void WebServer::HandleConnection(int client_fd) {
+    const auto accepted_deadline = std::chrono::steady_clock::now() + kRequestDeadline;
+    struct timeval timeout{};
+    timeout.tv_sec = static_cast<time_t>(kSocketTimeout.count());
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
     SSL *ssl = SSL_new(static_cast<SSL_CTX *>(ssl_ctx_));
     if (ssl == nullptr) {
         close(client_fd);
@@ -785,152 +997,103 @@ void WebServer::HandleConnection(int client_fd) {
     }
 
     SSL_set_fd(ssl, client_fd);
-    if (SSL_accept(ssl) <= 0) {
-        SSL_shutdown(ssl);
+    if (!AcceptTls(ssl, client_fd, accepted_deadline)) {
         SSL_free(ssl);
         close(client_fd);
         return;
     }
 
-    HttpRequest request;
-    std::string read_error;
-    HttpResponse response;
-    if (!ReadHttpRequest(ssl, &request, &read_error)) {
-        response.status = 400;
-        response.body = "{\"error\":\"bad_request\",\"message\":" + JsonString(read_error) + "}";
-    } else {
-        response = Route(request);
-    }
-
-    std::string raw;
-    raw += "HTTP/1.1 " + std::to_string(response.status) + " " + StatusText(response.status) + "\r\n";
-    raw += "Content-Type: " + response.content_type + "\r\n";
-    raw += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
-    raw += "Cache-Control: " + response.cache_control + "\r\n";
-    raw += "Connection: close\r\n";
-    raw += "\r\n";
-    raw += response.body;
-
-    WriteAllSsl(ssl, raw);
-
-    SSL_shutdown(ssl);
-    SSL_free(ssl);
-    close(client_fd);
-}
-
-bool WebServer::ReadHttpRequest(void *ssl_ptr, HttpRequest *request, std::string *error) const {
-    if (ssl_ptr == nullptr || request == nullptr || error == nullptr) {
-        return false;
-    }
-
-    SSL *ssl = static_cast<SSL *>(ssl_ptr);
-
-    std::string data;
-    data.reserve(2048);
-
-    std::size_t headers_end = std::string::npos;
-    while (headers_end == std::string::npos) {
-        if (data.size() >= kMaxRequestBytes) {
-            *error = "request too large";
-            return false;
+    // Bytes read past the end of one request belong to the next
+    // (pipelining), so they stay here between iterations.
+    std::string buffered;
+    auto deadline = accepted_deadline;
+    for (int served = 1; served <= kMaxRequestsPerConnection; ++served) {
+        if (served > 1) {
+            if (!WaitForNextRequest(ssl, client_fd, buffered)) {
+                break;
+            }
+            deadline = std::chrono::steady_clock::now() + kRequestDeadline;
         }
 
-        std::array<char, 2048> buffer{};
-        const int bytes = SSL_read(ssl, buffer.data(), static_cast<int>(buffer.size()));
-        if (bytes <= 0) {
-            *error = "failed to read request";
-            return false;
+        HttpRequest request;
+        std::string read_error;
+        HttpResponse response;
+        bool keep_alive = false;
+        const auto read = [ssl](char *data, int size) { return SSL_read(ssl, data, size); };
+        if (!ReadHttpRequest(read, deadline, &buffered, &request, &read_error)) {
+            if (read_error.empty()) {
+                break;
+            }
+            response.status = 400;
+            response.body = "{\"error\":\"bad_request\",\"message\":" + JsonString(read_error) + "}";
+        } else {
+            response = Route(request);
+            keep_alive = request.keep_alive && served < kMaxRequestsPerConnection && running_.load();
         }
 
-        data.append(buffer.data(), static_cast<std::size_t>(bytes));
-        headers_end = data.find("\r\n\r\n");
-    }
-
-    const std::string header_blob = data.substr(0, headers_end);
-    std::istringstream header_stream(header_blob);
-
-    std::string request_line;
-    if (!std::getline(header_stream, request_line)) {
-        *error = "missing request line";
-        return false;
-    }
-    if (!request_line.empty() && request_line.back() == '\r') {
-        request_line.pop_back();
-    }
-
-    std::istringstream request_line_stream(request_line);
-    std::string method;
-    std::string path;
-    std::string version;
-    request_line_stream >> method >> path >> version;
-    if (method.empty() || path.empty() || version.empty()) {
-        *error = "invalid request line";
-        return false;
-    }
-
-    std::map<std::string, std::string> headers;
-    std::string header_line;
-    while (std::getline(header_stream, header_line)) {
-        if (!header_line.empty() && header_line.back() == '\r') {
-            header_line.pop_back();
+        const std::string_view body = response.cached_body.value_or(response.body);
+        std::string raw;
+        raw.reserve(512 + body.size());
+        raw += "HTTP/1.1 " + std::to_string(response.status) + " " + StatusText(response.status) + "\r\n";
+        // A 304 describes the representation the client already has.
+        if (response.status != 304) {
+            raw += "Content-Type: " + response.content_type + "\r\n";
+            raw += "Content-Length: " + std::to_string(body.size()) + "\r\n";
         }
-        const auto sep = header_line.find(':');
-        if (sep == std::string::npos) {
-            continue;
+        if (!response.content_encoding.empty()) {
+            raw += "Content-Encoding: " + response.content_encoding + "\r\n";
+        }
+        if (!response.etag.empty()) {
+            raw += "ETag: " + response.etag + "\r\n";
+        }
+        if (!response.vary.empty()) {
+            raw += "Vary: " + response.vary + "\r\n";
+        }
+        raw += "Cache-Control: " + response.cache_control + "\r\n";
+        if (keep_alive) {
+            raw += "Connection: keep-alive\r\n";
+            raw += "Keep-Alive: timeout=" + std::to_string(kKeepAliveIdleTimeout.count()) +
+                   ", max=" + std::to_string(kMaxRequestsPerConnection - served) + "\r\n";
+        } else {
+            raw += "Connection: close\r\n";
+        }
+        raw += "\r\n";
+        if (response.status != 304) {
+            raw += body;
         }
-        const std::string key = ToLower(vc::config::trim(header_line.substr(0, sep)));
-        const std::string value = vc::config::trim(header_line.substr(sep + 1));
-        headers[key] = value;
-    }
 
-    std::size_t content_length = 0;
-    const auto content_length_it = headers.find("content-length");
-    if (content_length_it != headers.end()) {
-        char *end = nullptr;
-        const long parsed = std::strtol(content_length_it->second.c_str(), &end, 10);
-        if (end == nullptr || *end != '\0' || parsed < 0) {
-            *error = "invalid Content-Length";
-            return false;
+        if (!WriteAllSsl(ssl, raw) || !keep_alive) {
+            break;
         }
-        content_length = static_cast<std::size_t>(parsed);
     }
 
-    if (content_length > kMaxBodyBytes) {
-        *error = "request body too large";
-        return false;
-    }
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    close(client_fd);
+}
 
-    std::string body = data.substr(headers_end + 4);
-    while (body.size() < content_length) {
-        std::array<char, 2048> buffer{};
-        const int bytes = SSL_read(ssl, buffer.data(), static_cast<int>(buffer.size()));
-        if (bytes <= 0) {
-            *error = "failed to read request body";
+bool WebServer::WaitForNextRequest(void *ssl_ptr, int client_fd, const std::string &buffered) {
+    if (!buffered.empty() || SSL_pending(static_cast<SSL *>(ssl_ptr)) > 0) {
+        return true;
+    }
+    const auto idle_deadline = std::chrono::steady_clock::now() + kKeepAliveIdleTimeout;
+    while (running_.load() && std::chrono::steady_clock::now() < idle_deadline) {
+        struct pollfd poll_fd{};
+        poll_fd.fd = client_fd;
+        poll_fd.events = POLLIN;
+        const int ready = poll(&poll_fd, 1, static_cast<int>(kIdlePollSlice.count()));
+        if (ready > 0) {
+            return true;
+        }
+        if (ready < 0 && errno != EINTR) {
             return false;
         }
-        body.append(buffer.data(), static_cast<std::size_t>(bytes));
-        if (body.size() > kMaxBodyBytes) {
-            *error = "request body too large";
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        if (!pending_connections_.empty()) {
             return false;
         }
     }
-
-    if (body.size() > content_length) {
-        body.resize(content_length);
-    }
-
-    const auto query = path.find('?');
-    if (query != std::string::npos) {
-        path = path.substr(0, query);
-    }
-
-    request->method = method;
-    request->path = path;
-    request->body = std::move(body);
-    const auto content_type_it = headers.find("content-type");
-    request->has_content_type = content_type_it != headers.end();
-    request->content_type = content_type_it != headers.end() ? content_type_it->second : "";
-    return true;
+    return false;
 }
 
 WebServer::HttpResponse WebServer::Route(const HttpRequest &request) {
@@ -1007,13 +1170,33 @@ WebServer::HttpResponse WebServer::Route(const HttpRequest &request) {
         return HandleUploadRingSound(request);
     }
 
+    if (request.path == "/metrics") {
+        if (request.method != "GET") {
+            HttpResponse response;
+            response.status = 405;
+            response.body = "{\"error\":\"method_not_allowed\"}";
+            return response;
+        }
+        return HandleGetPrometheusMetrics();
+    }
+
+    if (request.path == "/api/v1/diagnostics/metrics") {
+        if (request.method != "GET") {
+            HttpResponse response;
+            response.status = 405;
+            response.body = "{\"error\":\"method_not_allowed\"}";
+            return response;
+        }
+        return HandleGetMetrics();
+    }
+
     if (request.path == "/api/v1/system" || request.path == "/api/v1/device" || request.path == "/api/v1/diagnostics" ||
         request.path.rfind("/api/v1/system/", 0) == 0 || request.path.rfind("/api/v1/device/", 0) == 0 ||
         request.path.rfind("/api/v1/diagnostics/", 0) == 0) {
         return ReservedNotImplemented(request.path);
     }
 
-    if (const auto ui_response = TryServeExternalUi(request); ui_response.has_value()) {
+    if (const auto ui_response = TryServeUi(request); ui_response.has_value()) {
         return *ui_response;
     }
 
@@ -1270,7 +1453,7 @@ WebServer::HttpResponse WebServer::HandleGetSystemVersion() {
 WebServer::HttpResponse WebServer::HandleGetObservedTopics() {
     HttpResponse response;
     std::string read_error;
-    const std::vector<std::string> topics = ReadObservedTopicsFromFile(observed_topics_path_, &read_error);
+    const std::vector<ObservedTopic> topics = ReadObservedTopicsFromFile(observed_topics_path_, &read_error);
 
     if (!read_error.empty()) {
         logger_.Warn("webd", read_error + " path=" + observed_topics_path_);
@@ -1278,12 +1461,47 @@ WebServer::HttpResponse WebServer::HandleGetObservedTopics() {
 
     response.status = 200;
     response.body = "{";
-    response.body += "\"topics\":" + SerializeTopics(topics);
+    response.body += SerializeObservedTopics(topics);
     response.body += "}";
     return response;
 }
 
+// chime writes the snapshot every metrics_interval seconds; it is served as
+// written, so `timestamp` tells how old it is.
+WebServer::HttpResponse WebServer::HandleGetMetrics() {
+    HttpResponse response;
+    std::string body;
+    if (!ReadFile(metrics_path_, &body) || body.empty()) {
+        response.status = 503;
+        response.body = "{\"error\":\"metrics_unavailable\",\"path\":" + JsonString(metrics_path_) + "}";
+        return response;
+    }
+
+    response.status = 200;
+    response.body = std::move(body);
+    return response;
+}
+
+// Reads chime's shared stats segment directly; chime is not involved in a
+// scrape.
+WebServer::HttpResponse WebServer::HandleGetPrometheusMetrics() {
+    HttpResponse response;
+    auto segment = std::make_unique<vc::metrics::StatsSegment>();
+    std::string read_error;
+    if (!vc::metrics::ReadStatsSegment(stats_segment_path_, segment.get(), &read_error)) {
+        response.status = 503;
+        response.body = "{\"error\":\"metrics_unavailable\",\"message\":" + JsonString(read_error) + "}";
+        return response;
+    }
+
+    response.status = 200;
+    response.content_type = "text/plain; version=0.0.4; charset=utf-8";
+    response.body = vc::metrics::FormatPrometheus(*segment, "chime_");
+    return response;
+}
+
 WebServer::HttpResponse WebServer::HandleGetRingSounds() {
+    std::lock_guard<std::mutex> lock(ring_sounds_mutex_);
     HttpResponse response;
 
     std::string ensure_error;
@@ -1355,27 +1573,28 @@ WebServer::HttpResponse WebServer::HandleGetRingSounds() {
 }
 
 WebServer::HttpResponse WebServer::HandleUploadRingSound(const HttpRequest &request) {
+    std::lock_guard<std::mutex> lock(ring_sounds_mutex_);
     HttpResponse response;
 
     const std::string prefix = "/api/v1/ring/sounds/";
     const std::string sound_name = request.path.substr(prefix.size());
     if (!IsSafeSoundName(sound_name)) {
         response.status = 400;
-        response.body = "{\"error\":\"invalid_sound_name\",\"message\":\"Use ring-*.wav\"}";
+        response.body = "{\"error\":\"invalid_sound_name\",\"message\":\"Use ring-*.wav, .flac, .opus or .ogg\"}";
         return response;
     }
     if (request.has_content_type) {
         const std::string mime_type = MimeTypeOnly(request.content_type);
-        if (mime_type != "audio/wav" && mime_type != "audio/x-wav") {
+        if (!IsSoundMimeType(mime_type)) {
             response.status = 415;
-            response.body = "{\"error\":\"invalid_payload\",\"message\":\"payload is not a WAV file\"}";
+            response.body = "{\"error\":\"invalid_payload\",\"message\":\"payload is not a WAV, FLAC or Ogg file\"}";
             return response;
         }
     }
 
-    if (request.body.size() < 12 || request.body.rfind("RIFF", 0) != 0 || request.body.compare(8, 4, "WAVE") != 0) {
+    if (!HasSoundMagic(request.body)) {
         response.status = 415;
-        response.body = "{\"error\":\"invalid_payload\",\"message\":\"payload is not a WAV file\"}";
+        response.body = "{\"error\":\"invalid_payload\",\"message\":\"payload is not a WAV, FLAC or Ogg file\"}";
         return response;
     }
 
@@ -1424,6 +1643,7 @@ WebServer::HttpResponse WebServer::HandleUploadRingSound(const HttpRequest &requ
 }
 
 WebServer::HttpResponse WebServer::HandleSelectRingSound(const HttpRequest &request) {
+    std::lock_guard<std::mutex> lock(ring_sounds_mutex_);
     HttpResponse response;
     const JsonParseResult parsed = ParseJson(request.body);
     if (!parsed.success || parsed.value.type() != JsonValue::Type::kObject) {
@@ -1436,7 +1656,7 @@ WebServer::HttpResponse WebServer::HandleSelectRingSound(const HttpRequest &requ
     const auto sound_name = ReadRequiredString(parsed.value, "name", &parse_errors);
     if (!parse_errors.empty() || !sound_name.has_value() || !IsSafeSoundName(*sound_name)) {
         response.status = 400;
-        response.body = "{\"error\":\"invalid_sound_name\",\"message\":\"Use ring-*.wav\"}";
+        response.body = "{\"error\":\"invalid_sound_name\",\"message\":\"Use ring-*.wav, .flac, .opus or .ogg\"}";
         return response;
     }
 
@@ -1526,69 +1746,59 @@ WebServer::HttpResponse WebServer::HandleSelectRingSound(const HttpRequest &requ
     return response;
 }
 
-std::optional<WebServer::HttpResponse> WebServer::TryServeExternalUi(const HttpRequest &request) const {
-    if (ui_dist_dir_.empty() || request.method != "GET") {
+const UiAsset *WebServer::FindUiAsset(std::string_view request_path) const {
+    return ui_assets_.empty() ? FindEmbeddedUiAsset(request_path) : ui_assets_.Find(request_path);
+}
+
+std::optional<WebServer::HttpResponse> WebServer::TryServeUi(const HttpRequest &request) const {
+    if (request.method != "GET") {
         return std::nullopt;
     }
     if (request.path.empty() || request.path[0] != '/' || StartsWith(request.path, "/api/")) {
         return std::nullopt;
     }
 
-    const std::filesystem::path root(ui_dist_dir_);
-    std::error_code ec;
-    if (!std::filesystem::exists(root, ec) || !std::filesystem::is_directory(root, ec)) {
+    const UiAsset *asset = FindUiAsset(request.path);
+    if (asset == nullptr && request.path == "/") {
         return std::nullopt;
     }
-
-    auto response_from_file = [&](const std::filesystem::path &file_path,
-                                  const std::string &request_path) -> std::optional<HttpResponse> {
-        if (!std::filesystem::exists(file_path, ec) || !std::filesystem::is_regular_file(file_path, ec)) {
-            return std::nullopt;
-        }
-        std::string body;
-        if (!ReadFile(file_path, &body)) {
+    if (asset == nullptr) {
+        const std::filesystem::path relative_path = std::filesystem::path(request.path).relative_path();
+        if (relative_path.empty() || !IsSafeRelativePath(relative_path)) {
             HttpResponse response;
-            response.status = 500;
-            response.body = "{\"error\":\"ui_read_failed\"}";
+            response.status = 404;
+            response.body = "{\"error\":\"not_found\"}";
             return response;
         }
-        HttpResponse response;
-        response.status = 200;
-        response.content_type = ContentTypeForPath(file_path);
-        response.cache_control = CacheControlForPath(request_path, file_path);
-        response.body = std::move(body);
-        return response;
-    };
-
-    if (request.path == "/") {
-        const auto index_response = response_from_file(root / "index.html", "/");
-        if (index_response.has_value()) {
-            return index_response;
+        // Client-side routes of the single-page app.
+        if (!StartsWith(request.path, "/assets/") && relative_path.extension().empty()) {
+            asset = FindUiAsset("/");
         }
-        return std::nullopt;
     }
-
-    const std::filesystem::path relative_path = std::filesystem::path(request.path).relative_path();
-    if (relative_path.empty() || !IsSafeRelativePath(relative_path)) {
+    if (asset == nullptr) {
         HttpResponse response;
         response.status = 404;
         response.body = "{\"error\":\"not_found\"}";
         return response;
     }
 
-    if (const auto file_response = response_from_file(root / relative_path, request.path); file_response.has_value()) {
-        return file_response;
-    }
-
-    if (!StartsWith(request.path, "/assets/") && relative_path.extension().empty()) {
-        if (const auto fallback_index = response_from_file(root / "index.html", "/"); fallback_index.has_value()) {
-            return fallback_index;
-        }
+    const UiAssetChoice choice = ChooseUiAssetVariant(*asset, request.accept_encoding, request.if_none_match);
+    HttpResponse response;
+    response.content_encoding = choice.content_encoding;
+    if (choice.vary_accept_encoding) {
+        response.vary = "Accept-Encoding";
+    }
+    response.content_type = asset->content_type;
+    response.cache_control = asset->cache_control;
+    response.etag = choice.variant->etag;
+    response.body.clear();
+    if (choice.not_modified) {
+        response.status = 304;
+        return response;
     }
 
-    HttpResponse response;
-    response.status = 404;
-    response.body = "{\"error\":\"not_found\"}";
+    response.status = 200;
+    response.cached_body = choice.variant->body;
     return response;
 }
 
@@ -1607,6 +1817,12 @@ bool WebServer::EnsureTlsMaterial(std::string *error) const {
     const bool cert_exists = std::filesystem::exists(cert_path_);
     const bool key_exists = std::filesystem::exists(key_path_);
     if (cert_exists && key_exists) {
+        const std::optional<TlsKeyType> existing_type = ReadCertificateKeyType(cert_path_);
+        if (existing_type.has_value() && *existing_type != tls_key_type_) {
+            logger_.Warn("webd", "keeping existing " + std::string(TlsKeyTypeName(*existing_type)) +
+                                     " certificate " + cert_path_ + "; delete it and " + key_path_ +
+                                     " to generate an " + TlsKeyTypeName(tls_key_type_) + " one");
+        }
         return true;
     }
 
@@ -1627,7 +1843,8 @@ bool WebServer::EnsureTlsMaterial(std::string *error) const {
         return false;
     }
 
-    return GenerateSelfSignedCertificate(cert_path_, key_path_, error);
+    logger_.Info("webd", std::string("generating self-signed ") + TlsKeyTypeName(tls_key_type_) + " certificate");
+    return GenerateSelfSignedCertificate(cert_path_, key_path_, tls_key_type_, error);
 }
 
 } // namespace chime::webd
@@ -393,6 +393,7 @@ WifiScanner::WifiScanner(vc::logging::Logger &logger, std::string interface_name
     : logger_(logger), interface_name_(std::move(interface_name)) {}
 
 WifiScanResult WifiScanner::Scan() const {
+    std::lock_guard<std::mutex> lock(scan_mutex_);
 #if defined(__APPLE__)
     WifiScanResult airport_result = ScanWithAirport();
     if (airport_result.success) {
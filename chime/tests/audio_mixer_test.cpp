@@ -0,0 +1,113 @@
+// Renders overlapping voices through AudioMixer and checks that 16-bit
+// voices are summed before saturating, across accumulator chunk boundaries.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "chime/audio_mixer.h"
+#include "chime/sound_cache.h"
+#include "test_check.h"
+
+namespace {
+
+constexpr uint32_t kRate = 48000;
+
+// Mono 16-bit sound holding `frames` copies of `value`.
+std::shared_ptr<const chime::CachedSound> ConstantSound(int16_t value, std::size_t frames) {
+    auto sound = std::make_shared<chime::CachedSound>();
+    sound->channels = 1;
+    sound->sample_rate = kRate;
+    sound->bits_per_sample = 16;
+    sound->block_align = 2;
+    sound->samples = chime::AlignedPcmBuffer(frames * 2);
+    auto *samples = reinterpret_cast<int16_t *>(sound->samples.data());
+    for (std::size_t i = 0; i < frames; ++i) {
+        samples[i] = value;
+    }
+    return sound;
+}
+
+chime::MixerPolicy MixEverything() {
+    chime::MixerPolicy policy;
+    policy.other = chime::OverlapPolicy::kMix;
+    policy.bell_priority = chime::BellPriority::kMix;
+    return policy;
+}
+
+void Play(chime::AudioMixer &mixer, uint32_t id, std::shared_ptr<const chime::CachedSound> sound) {
+    chime::MixerCommand command;
+    command.id = id;
+    command.category = chime::SoundCategory::kOther;
+    command.sound = std::move(sound);
+    VC_CHECK(mixer.Submit(std::move(command)));
+}
+
+std::vector<int16_t> Render(chime::AudioMixer &mixer, std::size_t frames) {
+    std::vector<int16_t> out(frames * mixer.OutputFormat().channels, 0x1234);
+    mixer.Render(reinterpret_cast<uint8_t *>(out.data()), frames);
+    return out;
+}
+
+bool AllEqual(const std::vector<int16_t> &samples, std::size_t begin, std::size_t end, int16_t value) {
+    for (std::size_t i = begin; i < end; ++i) {
+        if (samples[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Two loud voices and one cancelling voice: saturating after each voice
+// would clip at 32767 before the third is subtracted.
+void CheckSaturatesOnce() {
+    chime::AudioMixer mixer(MixEverything());
+    mixer.SetOutputFormat({1, kRate, 16});
+    Play(mixer, 1, ConstantSound(30000, 3000));
+    Play(mixer, 2, ConstantSound(30000, 3000));
+    Play(mixer, 3, ConstantSound(-30000, 1500));
+    mixer.ProcessCommands();
+    VC_CHECK(mixer.ActiveVoices() == 3);
+
+    // Longer than one accumulator pass, with the short voice ending inside it.
+    const std::size_t frames = chime::AudioMixer::kMixChunkSamples * 2 + 100;
+    const std::vector<int16_t> out = Render(mixer, frames);
+    VC_CHECK(AllEqual(out, 0, 1500, 30000));
+    VC_CHECK(AllEqual(out, 1500, frames, 32767));
+    VC_CHECK(mixer.ActiveVoices() == 2);
+
+    const std::vector<int16_t> tail = Render(mixer, 1000);
+    const std::size_t left = 3000 - frames;
+    VC_CHECK(AllEqual(tail, 0, left, 32767));
+    VC_CHECK(AllEqual(tail, left, tail.size(), 0));
+    VC_CHECK(!mixer.Active());
+    VC_CHECK(mixer.ReleaseRetired() == 3);
+}
+
+void CheckNegativeClip() {
+    chime::AudioMixer mixer(MixEverything());
+    mixer.SetOutputFormat({1, kRate, 16});
+    Play(mixer, 1, ConstantSound(-32768, 64));
+    Play(mixer, 2, ConstantSound(-32768, 64));
+    mixer.ProcessCommands();
+    const std::vector<int16_t> out = Render(mixer, 64);
+    VC_CHECK(AllEqual(out, 0, out.size(), -32768));
+}
+
+void CheckSilenceWhenIdle() {
+    chime::AudioMixer mixer(MixEverything());
+    mixer.SetOutputFormat({2, kRate, 16});
+    const std::vector<int16_t> out = Render(mixer, 300);
+    VC_CHECK(AllEqual(out, 0, out.size(), 0));
+}
+
+} // namespace
+
+int main() {
+    CheckSaturatesOnce();
+    CheckNegativeClip();
+    CheckSilenceWhenIdle();
+    return vc::test::ExitCode();
+}
@@ -0,0 +1,20 @@
+export const path0 = "C:\\chime\\0??/";
+export const path1 = "C:\\chime\\1??/";
+export const path2 = "C:\\chime\\2??/";
+export const path3 = "C:\\chime\\3??/";
+export const path4 = "C:\\chime\\4??/";
+export const path5 = "C:\\chime\\5??/";
+export const path6 = "C:\\chime\\6??/";
+export const path7 = "C:\\chime\\7??/";
+export const path8 = "C:\\chime\\8??/";
+export const path9 = "C:\\chime\\9??/";
+export const path10 = "C:\\chime\\10??/";
+export const path11 = "C:\\chime\\11??/";
+export const path12 = "C:\\chime\\12??/";
+export const path13 = "C:\\chime\\13??/";
+export const path14 = "C:\\chime\\14??/";
+export const path15 = "C:\\chime\\15??/";
+export const path16 = "C:\\chime\\16??/";
+export const path17 = "C:\\chime\\17??/";
+export const path18 = "C:\\chime\\18??/";
+export const path19 = "C:\\chime\\19??/";
@@ -0,0 +1,84 @@
+// Linked against the table chime-webd-embed-ui generated from the fixture
+// directory given on the command line, and checks that every embedded body,
+// content type, Cache-Control and ETag matches what UiAssetCache loads from
+// the same files at run time.
+//
+//   embed_ui_assets_test <tests/data/embed_ui>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "chime/webd_embedded_ui.h"
+#include "chime/webd_ui_asset_cache.h"
+#include "test_check.h"
+
+namespace {
+
+using chime::webd::UiAsset;
+using chime::webd::UiAssetVariant;
+
+std::string ReadFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+bool SameVariant(const UiAssetVariant &embedded, const UiAssetVariant &loaded) {
+    return embedded.body == loaded.body && embedded.etag == loaded.etag;
+}
+
+void CheckMatchesFiles(const std::filesystem::path &dist) {
+    chime::webd::UiAssetCache cache;
+    std::string error;
+    VC_CHECK_CTX(cache.Load(dist.string(), &error), error);
+    VC_CHECK(!cache.empty());
+    VC_CHECK(chime::webd::EmbeddedUiAssetCount() == cache.totals().files);
+
+    cache.ForEach([&](const UiAsset &loaded) {
+        const std::string path(loaded.path);
+        const UiAsset *embedded = chime::webd::FindEmbeddedUiAsset(path);
+        VC_CHECK_CTX(embedded != nullptr, path);
+        if (embedded == nullptr) {
+            return;
+        }
+        VC_CHECK_CTX(embedded->path == loaded.path, path);
+        VC_CHECK_CTX(embedded->identity.body == ReadFile(dist / path.substr(1)), path);
+        VC_CHECK_CTX(embedded->content_type == loaded.content_type, path);
+        VC_CHECK_CTX(embedded->cache_control == loaded.cache_control, path);
+        VC_CHECK_CTX(SameVariant(embedded->identity, loaded.identity), path);
+        VC_CHECK_CTX(SameVariant(embedded->gzip, loaded.gzip), path);
+        VC_CHECK_CTX(SameVariant(embedded->brotli, loaded.brotli), path);
+    });
+}
+
+// The fixture is chosen to exercise the literal escaping: quotes,
+// backslashes, trigraph-like "??" runs, NULs followed by digits, and a
+// shipped brotli copy.
+void CheckFixture(const std::filesystem::path &dist) {
+    const UiAsset *index = chime::webd::FindEmbeddedUiAsset("/");
+    VC_CHECK(index != nullptr && index->path == "/index.html");
+    VC_CHECK(index != nullptr && !index->gzip.body.empty());
+
+    const UiAsset *app = chime::webd::FindEmbeddedUiAsset("/assets/app.js");
+    VC_CHECK(app != nullptr && app->brotli.body == ReadFile(dist / "assets/app.js.br"));
+
+    VC_CHECK(chime::webd::FindEmbeddedUiAsset("/assets/app.js.br") == nullptr);
+    VC_CHECK(chime::webd::FindEmbeddedUiAsset("/missing.html") == nullptr);
+    VC_CHECK(chime::webd::FindEmbeddedUiAsset("") == nullptr);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        VC_CHECK(false);
+        return vc::test::ExitCode();
+    }
+    const std::filesystem::path dist = argv[1];
+    CheckMatchesFiles(dist);
+    CheckFixture(dist);
+    return vc::test::ExitCode();
+}
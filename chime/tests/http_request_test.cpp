@@ -0,0 +1,141 @@
+// Feeds ReadHttpRequest canned reads: pipelined requests sharing a buffer
+// are split at the end of each body, a clean close between requests is not
+// an error, and chunked bodies are refused.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "chime/webd_http_request.h"
+#include "test_check.h"
+
+namespace {
+
+using chime::webd::HttpRequest;
+using chime::webd::ReadHttpRequest;
+
+// Hands out one queued chunk per read, then reports the connection closed.
+class CannedReads {
+  public:
+    explicit CannedReads(std::deque<std::string> chunks) : chunks_(std::move(chunks)) {}
+
+    chime::webd::HttpReadFunction Function() {
+        return [this](char *data, int size) {
+            if (chunks_.empty()) {
+                return 0;
+            }
+            std::string &chunk = chunks_.front();
+            const std::size_t count = std::min(chunk.size(), static_cast<std::size_t>(size));
+            std::memcpy(data, chunk.data(), count);
+            chunk.erase(0, count);
+            if (chunk.empty()) {
+                chunks_.pop_front();
+            }
+            ++reads_;
+            return static_cast<int>(count);
+        };
+    }
+
+    int reads() const { return reads_; }
+
+  private:
+    std::deque<std::string> chunks_;
+    int reads_ = 0;
+};
+
+std::chrono::steady_clock::time_point Deadline() { return std::chrono::steady_clock::now() + std::chrono::seconds(5); }
+
+void CheckPipelined() {
+    const std::string post = "POST /api/v1/config/core?x=1 HTTP/1.1\r\n"
+                             "Host: chime\r\n"
+                             "Content-Type: application/json\r\n"
+                             "Content-Length: 11\r\n"
+                             "\r\n"
+                             "{\"a\":\"b\"}\r\n";
+    const std::string get = "GET /index.html HTTP/1.1\r\n"
+                            "Accept-Encoding: gzip, br\r\n"
+                            "If-None-Match: W/\"abc\"\r\n"
+                            "Connection: close\r\n"
+                            "\r\n";
+    CannedReads reads({post + get});
+    std::string buffered;
+    std::string error;
+
+    HttpRequest first;
+    VC_CHECK_CTX(ReadHttpRequest(reads.Function(), Deadline(), &buffered, &first, &error), error);
+    VC_CHECK(first.method == "POST" && first.path == "/api/v1/config/core");
+    VC_CHECK(first.body == "{\"a\":\"b\"}\r\n");
+    VC_CHECK(first.has_content_type && first.content_type == "application/json");
+    VC_CHECK(first.keep_alive);
+    // Everything after the body is the second request, untouched.
+    VC_CHECK(buffered == get);
+
+    HttpRequest second;
+    VC_CHECK_CTX(ReadHttpRequest(reads.Function(), Deadline(), &buffered, &second, &error), error);
+    VC_CHECK(second.method == "GET" && second.path == "/index.html" && second.body.empty());
+    VC_CHECK(!second.has_content_type);
+    VC_CHECK(second.accept_encoding == "gzip, br" && second.if_none_match == "W/\"abc\"");
+    VC_CHECK(!second.keep_alive);
+    VC_CHECK(buffered.empty());
+    VC_CHECK(reads.reads() == 1);
+
+    // The client hung up between requests.
+    HttpRequest third;
+    error = "unset";
+    VC_CHECK(!ReadHttpRequest(reads.Function(), Deadline(), &buffered, &third, &error));
+    VC_CHECK(error.empty());
+}
+
+// The body and the start of the next request arrive in later reads.
+void CheckSplitReads() {
+    CannedReads reads({"PUT /upload HTTP/1.0\r\nContent-Len", "gth: 5\r\nConnection: keep-alive\r\n\r\nab",
+                       "cdeGET / HTTP/1.0\r\n"});
+    std::string buffered;
+    std::string error;
+    HttpRequest request;
+    VC_CHECK_CTX(ReadHttpRequest(reads.Function(), Deadline(), &buffered, &request, &error), error);
+    VC_CHECK(request.method == "PUT" && request.body == "abcde" && request.keep_alive);
+    VC_CHECK(buffered == "GET / HTTP/1.0\r\n");
+
+    // Closed halfway through the next request's headers.
+    VC_CHECK(!ReadHttpRequest(reads.Function(), Deadline(), &buffered, &request, &error));
+    VC_CHECK(error == "failed to read request");
+}
+
+void CheckRejected() {
+    std::string error;
+    HttpRequest request;
+
+    std::string buffered = "POST /x HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n";
+    VC_CHECK(!ReadHttpRequest(CannedReads({}).Function(), Deadline(), &buffered, &request, &error));
+    VC_CHECK(error == "Transfer-Encoding not supported");
+
+    buffered = "POST /x HTTP/1.1\r\nContent-Length: -1\r\n\r\n";
+    VC_CHECK(!ReadHttpRequest(CannedReads({}).Function(), Deadline(), &buffered, &request, &error));
+    VC_CHECK(error == "invalid Content-Length");
+
+    buffered = "POST /x HTTP/1.1\r\nContent-Length: 10\r\n\r\nshort";
+    VC_CHECK(!ReadHttpRequest(CannedReads({}).Function(), Deadline(), &buffered, &request, &error));
+    VC_CHECK(error == "failed to read request body");
+
+    buffered = "GARBAGE\r\n\r\n";
+    VC_CHECK(!ReadHttpRequest(CannedReads({}).Function(), Deadline(), &buffered, &request, &error));
+    VC_CHECK(error == "invalid request line");
+
+    buffered = "GET / HTTP/1.1\r\n";
+    const auto past = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+    VC_CHECK(!ReadHttpRequest(CannedReads({"\r\n"}).Function(), past, &buffered, &request, &error));
+    VC_CHECK(error == "request timed out");
+}
+
+} // namespace
+
+int main() {
+    CheckPipelined();
+    CheckSplitReads();
+    CheckRejected();
+    return vc::test::ExitCode();
+}
@@ -0,0 +1,61 @@
+// Round-trips observed topic lines and checks that ParseObservedTopicLine
+// accepts the older one-topic-per-line format and rejects blank lines.
+
+#include <ctime>
+#include <string>
+
+#include "chime/observed_topics.h"
+#include "test_check.h"
+
+namespace {
+
+void CheckRoundTrip() {
+    const chime::ObservedTopicStats stats{1700000000, 1700000123, 42};
+    for (const std::string topic : {"doorbell/front", "a", "with space/x", "tab\tin/topic", "12\t34"}) {
+        std::string line;
+        chime::AppendObservedTopicLine(topic, stats, &line);
+        VC_CHECK_CTX(line.back() == '\n', topic);
+
+        std::string parsed_topic;
+        chime::ObservedTopicStats parsed;
+        VC_CHECK_CTX(chime::ParseObservedTopicLine(line, &parsed_topic, &parsed), topic);
+        VC_CHECK_CTX(parsed_topic == topic, topic);
+        VC_CHECK_CTX(parsed.first_seen == stats.first_seen && parsed.last_seen == stats.last_seen &&
+                         parsed.messages == stats.messages,
+                     topic);
+    }
+}
+
+void CheckLegacyFormat() {
+    std::string topic;
+    chime::ObservedTopicStats stats{1, 2, 3};
+    VC_CHECK(chime::ParseObservedTopicLine("  doorbell/back \r\n", &topic, &stats));
+    VC_CHECK(topic == "doorbell/back");
+    VC_CHECK(stats.first_seen == 0 && stats.last_seen == 0 && stats.messages == 0);
+
+    // Too few or malformed numeric fields: the whole line is the topic.
+    VC_CHECK(chime::ParseObservedTopicLine("a\t1\t2", &topic, &stats));
+    VC_CHECK(topic == "a\t1\t2" && stats.messages == 0);
+    VC_CHECK(chime::ParseObservedTopicLine("a\t1\tx\t3", &topic, &stats));
+    VC_CHECK(topic == "a\t1\tx\t3");
+    VC_CHECK(chime::ParseObservedTopicLine("a\t1\t2\t-3", &topic, &stats));
+    VC_CHECK(topic == "a\t1\t2\t-3" && stats.messages == 0);
+}
+
+void CheckEmpty() {
+    std::string topic;
+    chime::ObservedTopicStats stats;
+    VC_CHECK(!chime::ParseObservedTopicLine("", &topic, &stats));
+    VC_CHECK(!chime::ParseObservedTopicLine("   \r\n", &topic, &stats));
+    // Stats without a topic.
+    VC_CHECK(!chime::ParseObservedTopicLine("\t1\t2\t3\n", &topic, &stats));
+}
+
+} // namespace
+
+int main() {
+    CheckRoundTrip();
+    CheckLegacyFormat();
+    CheckEmpty();
+    return vc::test::ExitCode();
+}
@@ -0,0 +1,140 @@
+// Runs ConvertPcm over synthetic input: a 44.1 kHz sine resampled to 48 kHz
+// must keep its length, amplitude and phase, and NaN or infinite float
+// samples must come out as silence instead of garbage.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "chime/pcm_convert.h"
+#include "chime/sound_cache.h"
+#include "test_check.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kToneHz = 1000.0;
+constexpr double kAmplitude = 0.5;
+// The filter's edges see the zero padding around the input; amplitude is
+// only judged away from them.
+constexpr std::size_t kEdgeFrames = 1000;
+
+std::vector<uint8_t> FloatBytes(const std::vector<float> &samples) {
+    std::vector<uint8_t> bytes(samples.size() * sizeof(float));
+    std::memcpy(bytes.data(), samples.data(), bytes.size());
+    return bytes;
+}
+
+std::vector<float> Sine(uint32_t rate, std::size_t frames) {
+    std::vector<float> samples(frames);
+    for (std::size_t i = 0; i < frames; ++i) {
+        samples[i] = static_cast<float>(kAmplitude * std::sin(2.0 * kPi * kToneHz * static_cast<double>(i) / rate));
+    }
+    return samples;
+}
+
+bool Convert(const std::vector<float> &mono, uint32_t rate, const chime::PcmOutputFormat &target,
+             chime::CachedSound *sound) {
+    const std::vector<uint8_t> bytes = FloatBytes(mono);
+    chime::PcmSource source;
+    source.data = bytes.data();
+    source.frames = mono.size();
+    source.channels = 1;
+    source.sample_rate = rate;
+    source.encoding = chime::PcmEncoding::kFloat32;
+    std::string error;
+    const bool ok = chime::ConvertPcm(source, target, sound, &error);
+    VC_CHECK_CTX(ok, error);
+    return ok;
+}
+
+const int16_t *Samples(const chime::CachedSound &sound) {
+    return reinterpret_cast<const int16_t *>(sound.samples.data());
+}
+
+void CheckSine(uint32_t from, uint32_t to) {
+    const std::string context = std::to_string(from) + " -> " + std::to_string(to);
+    const std::size_t in_frames = from;
+    chime::CachedSound sound;
+    if (!Convert(Sine(from, in_frames), from, chime::PcmOutputFormat{2, to}, &sound)) {
+        return;
+    }
+
+    // One second in, one second out.
+    const std::size_t expected_frames = (in_frames * to + from - 1) / from;
+    VC_CHECK_CTX(sound.frames() == expected_frames, context);
+    VC_CHECK_CTX(sound.channels == 2 && sound.sample_rate == to && sound.block_align == 4, context);
+    if (sound.frames() != expected_frames) {
+        return;
+    }
+
+    const int16_t *out = Samples(sound);
+    double peak = 0.0;
+    double square_sum = 0.0;
+    double max_error = 0.0;
+    bool channels_equal = true;
+    for (std::size_t i = kEdgeFrames; i < expected_frames - kEdgeFrames; ++i) {
+        const double left = out[i * 2] / 32768.0;
+        channels_equal = channels_equal && out[i * 2] == out[i * 2 + 1];
+        peak = std::max(peak, std::abs(left));
+        square_sum += left * left;
+        const double ideal = kAmplitude * std::sin(2.0 * kPi * kToneHz * static_cast<double>(i) / to);
+        max_error = std::max(max_error, std::abs(left - ideal));
+    }
+    const double rms = std::sqrt(square_sum / static_cast<double>(expected_frames - 2 * kEdgeFrames));
+    VC_CHECK_CTX(channels_equal, context);
+    VC_CHECK_CTX(std::abs(peak - kAmplitude) < kAmplitude * 0.01, context + " peak=" + std::to_string(peak));
+    VC_CHECK_CTX(std::abs(rms - kAmplitude / std::sqrt(2.0)) < kAmplitude * 0.01,
+                 context + " rms=" + std::to_string(rms));
+    // Same tone at the same phase, not just the same level.
+    VC_CHECK_CTX(max_error < 0.002, context + " max_error=" + std::to_string(max_error));
+}
+
+void CheckNonFiniteSameRate() {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    chime::CachedSound sound;
+    if (!Convert({0.25F, nan, inf, -inf, -0.25F, 2.0F}, 48000, chime::PcmOutputFormat{1, 48000}, &sound)) {
+        return;
+    }
+    VC_CHECK(sound.frames() == 6);
+    if (sound.frames() != 6) {
+        return;
+    }
+    const int16_t *out = Samples(sound);
+    VC_CHECK(out[0] == 8192 && out[1] == 0 && out[2] == 0 && out[3] == 0 && out[4] == -8192 && out[5] == 32767);
+}
+
+// A single NaN fed through the resampler would otherwise turn every output
+// frame within the filter's reach into NaN.
+void CheckNonFiniteResampled() {
+    std::vector<float> samples(4410, 0.0F);
+    samples[2000] = std::numeric_limits<float>::quiet_NaN();
+    samples[2001] = std::numeric_limits<float>::infinity();
+    chime::CachedSound sound;
+    if (!Convert(samples, 44100, chime::PcmOutputFormat{1, 48000}, &sound)) {
+        return;
+    }
+    VC_CHECK(sound.frames() == 4800);
+    const int16_t *out = Samples(sound);
+    bool silent = true;
+    for (std::size_t i = 0; i < sound.frames(); ++i) {
+        silent = silent && out[i] == 0;
+    }
+    VC_CHECK(silent);
+}
+
+} // namespace
+
+int main() {
+    CheckSine(44100, 48000);
+    CheckSine(48000, 44100);
+    CheckSine(22050, 48000);
+    CheckNonFiniteSameRate();
+    CheckNonFiniteResampled();
+    return vc::test::ExitCode();
+}
@@ -0,0 +1,208 @@
+// Holds every compiled PCM kernel variant against the scalar reference:
+// random and full-scale samples, edge gains, odd tail lengths and buffers
+// offset from their vector alignment. Outputs must be bit-exact.
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "chime/pcm_dsp.h"
+#include "test_check.h"
+
+namespace {
+
+constexpr std::size_t kLengths[] = {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 257, 1031};
+constexpr std::size_t kOffsets[] = {0, 1, 3};
+constexpr int32_t kEdgeGains[] = {0, 1, 2, 16384, 32766, 32767, chime::kQ15Unity};
+
+enum class Fill { kRandom, kMin, kMax, kAlternating };
+constexpr Fill kFills[] = {Fill::kRandom, Fill::kMin, Fill::kMax, Fill::kAlternating};
+
+std::mt19937 &Rng() {
+    static std::mt19937 rng(0x5eed);
+    return rng;
+}
+
+template <typename T> T Sample(Fill fill, std::size_t i) {
+    constexpr T lo = std::numeric_limits<T>::min();
+    constexpr T hi = std::numeric_limits<T>::max();
+    switch (fill) {
+    case Fill::kMin:
+        return lo;
+    case Fill::kMax:
+        return hi;
+    case Fill::kAlternating:
+        return i % 2 == 0 ? lo : hi;
+    case Fill::kRandom:
+        break;
+    }
+    return static_cast<T>(std::uniform_int_distribution<int32_t>(lo, hi)(Rng()));
+}
+
+// `count` samples starting `offset` elements into the returned buffer.
+template <typename T> std::vector<T> Buffer(Fill fill, std::size_t offset, std::size_t count) {
+    std::vector<T> buffer(offset + count);
+    for (std::size_t i = 0; i < buffer.size(); ++i) {
+        buffer[i] = Sample<T>(fill, i);
+    }
+    return buffer;
+}
+
+std::vector<int32_t> Gains() {
+    std::vector<int32_t> gains(std::begin(kEdgeGains), std::end(kEdgeGains));
+    std::uniform_int_distribution<int32_t> random_gain(0, chime::kQ15Unity);
+    for (int i = 0; i < 4; ++i) {
+        gains.push_back(random_gain(Rng()));
+    }
+    return gains;
+}
+
+std::string Context(const chime::PcmKernels &kernels, const char *kernel, std::size_t count, std::size_t offset,
+                    int32_t gain) {
+    return std::string(kernels.name) + " " + kernel + " count=" + std::to_string(count) +
+           " offset=" + std::to_string(offset) + " gain=" + std::to_string(gain);
+}
+
+template <typename T>
+void CheckGain(const chime::PcmKernels &variant, void (*chime::PcmKernels::*kernel)(T *, std::size_t, int32_t),
+               const char *name, const std::vector<int32_t> &gains) {
+    const chime::PcmKernels &scalar = chime::ScalarPcmKernels();
+    for (const Fill fill : kFills) {
+        for (const std::size_t count : kLengths) {
+            for (const std::size_t offset : kOffsets) {
+                for (const int32_t gain : gains) {
+                    std::vector<T> expected = Buffer<T>(fill, offset, count);
+                    std::vector<T> actual = expected;
+                    (scalar.*kernel)(expected.data() + offset, count, gain);
+                    (variant.*kernel)(actual.data() + offset, count, gain);
+                    VC_CHECK_CTX(actual == expected, Context(variant, name, count, offset, gain));
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void CheckMix(const chime::PcmKernels &variant,
+              void (*chime::PcmKernels::*kernel)(T *, const T *, std::size_t, int32_t), const char *name,
+              const std::vector<int32_t> &gains) {
+    const chime::PcmKernels &scalar = chime::ScalarPcmKernels();
+    for (const Fill dst_fill : kFills) {
+        for (const Fill src_fill : kFills) {
+            for (const std::size_t count : kLengths) {
+                for (const std::size_t offset : kOffsets) {
+                    // The source sits one element further off so dst and src
+                    // are never misaligned by the same amount.
+                    const std::vector<T> src = Buffer<T>(src_fill, offset + 1, count);
+                    for (const int32_t gain : gains) {
+                        std::vector<T> expected = Buffer<T>(dst_fill, offset, count);
+                        std::vector<T> actual = expected;
+                        (scalar.*kernel)(expected.data() + offset, src.data() + offset + 1, count, gain);
+                        (variant.*kernel)(actual.data() + offset, src.data() + offset + 1, count, gain);
+                        VC_CHECK_CTX(actual == expected, Context(variant, name, count, offset, gain));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Accumulates several sources into one int32 buffer, the way the mixer sums
+// its voices, so the running sums leave the int16 range.
+void CheckAccumulate(const chime::PcmKernels &variant, const std::vector<int32_t> &gains) {
+    const chime::PcmKernels &scalar = chime::ScalarPcmKernels();
+    for (const std::size_t count : kLengths) {
+        for (const std::size_t offset : kOffsets) {
+            std::vector<int32_t> expected(offset + count, 0);
+            std::vector<int32_t> actual = expected;
+            for (const Fill fill : kFills) {
+                const std::vector<int16_t> src = Buffer<int16_t>(fill, offset + 1, count);
+                for (const int32_t gain : gains) {
+                    scalar.accumulate_s16(expected.data() + offset, src.data() + offset + 1, count, gain);
+                    variant.accumulate_s16(actual.data() + offset, src.data() + offset + 1, count, gain);
+                }
+            }
+            VC_CHECK_CTX(actual == expected, Context(variant, "accumulate_s16", count, offset, 0));
+        }
+    }
+}
+
+void CheckSaturate(const chime::PcmKernels &variant) {
+    const chime::PcmKernels &scalar = chime::ScalarPcmKernels();
+    constexpr int32_t kEdges[] = {std::numeric_limits<int32_t>::min(),
+                                  -65536,
+                                  -32769,
+                                  -32768,
+                                  -32767,
+                                  -1,
+                                  0,
+                                  1,
+                                  32766,
+                                  32767,
+                                  32768,
+                                  65535,
+                                  std::numeric_limits<int32_t>::max()};
+    std::uniform_int_distribution<int32_t> wide(-4 * 32768, 4 * 32768);
+    for (const std::size_t count : kLengths) {
+        for (const std::size_t offset : kOffsets) {
+            std::vector<int32_t> src(offset + count);
+            for (std::size_t i = 0; i < src.size(); ++i) {
+                src[i] = i % 3 == 0 ? kEdges[i % std::size(kEdges)] : wide(Rng());
+            }
+            std::vector<int16_t> expected(offset + 1 + count, 0x5555);
+            std::vector<int16_t> actual = expected;
+            scalar.saturate_s32_to_s16(src.data() + offset, expected.data() + offset + 1, count);
+            variant.saturate_s32_to_s16(src.data() + offset, actual.data() + offset + 1, count);
+            VC_CHECK_CTX(actual == expected, Context(variant, "saturate_s32_to_s16", count, offset, 0));
+        }
+    }
+}
+
+void CheckScalarReference() {
+    const chime::PcmKernels &scalar = chime::ScalarPcmKernels();
+    int16_t s16[] = {-32768, -32767, -1, 0, 1, 32767};
+    scalar.gain_s16(s16, std::size(s16), 32767);
+    VC_CHECK(s16[0] == -32767 && s16[1] == -32766 && s16[2] == -1 && s16[3] == 0 && s16[4] == 1 && s16[5] == 32766);
+
+    int16_t dst[] = {32767, -32768, 100};
+    const int16_t src[] = {32767, -32768, -50};
+    scalar.mix_s16(dst, src, std::size(dst), chime::kQ15Unity);
+    VC_CHECK(dst[0] == 32767 && dst[1] == -32768 && dst[2] == 50);
+
+    int32_t acc[] = {30000, -30000, 0};
+    const int16_t loud[] = {30000, -30000, -32768};
+    scalar.accumulate_s16(acc, loud, std::size(acc), chime::kQ15Unity);
+    scalar.accumulate_s16(acc, loud, std::size(acc), 16384);
+    VC_CHECK(acc[0] == 75000 && acc[1] == -75000 && acc[2] == -49152);
+
+    uint8_t u8[] = {0, 128, 255};
+    scalar.gain_u8(u8, std::size(u8), 0);
+    VC_CHECK(u8[0] == 128 && u8[1] == 128 && u8[2] == 128);
+
+    VC_CHECK(chime::GainQ15FromPercent(0) == 0);
+    VC_CHECK(chime::GainQ15FromPercent(100) == chime::kQ15Unity);
+    VC_CHECK(chime::GainQ15FromPercent(150) == chime::kQ15Unity);
+}
+
+} // namespace
+
+int main() {
+    CheckScalarReference();
+
+    const std::vector<int32_t> gains = Gains();
+    for (const chime::PcmKernels *variant : chime::SupportedPcmKernels()) {
+        std::cout << "checking " << variant->name << " kernels\n";
+        CheckGain(*variant, &chime::PcmKernels::gain_s16, "gain_s16", gains);
+        CheckGain(*variant, &chime::PcmKernels::gain_u8, "gain_u8", gains);
+        CheckMix(*variant, &chime::PcmKernels::mix_s16, "mix_s16", gains);
+        CheckMix(*variant, &chime::PcmKernels::mix_u8, "mix_u8", gains);
+        CheckAccumulate(*variant, gains);
+        CheckSaturate(*variant);
+    }
+    return vc::test::ExitCode();
+}
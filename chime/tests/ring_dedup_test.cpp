@@ -0,0 +1,71 @@
+// Feeds RingDeduplicator bursts of rings with explicit timestamps: repeats
+// inside the window are dropped, the window runs from the first copy, and
+// the fixed table forgets its oldest ring when it fills.
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "chime/ring_dedup.h"
+#include "test_check.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+const auto kStart = std::chrono::steady_clock::time_point{} + 1h;
+
+void CheckBurst() {
+    chime::RingDeduplicator dedup(1000ms);
+    VC_CHECK(!dedup.IsDuplicate("doorbell/front", "ring", kStart));
+    VC_CHECK(dedup.IsDuplicate("doorbell/front", "ring", kStart + 10ms));
+    VC_CHECK(dedup.IsDuplicate("doorbell/front", "ring", kStart + 999ms));
+    // Topic and payload both count.
+    VC_CHECK(!dedup.IsDuplicate("doorbell/back", "ring", kStart + 20ms));
+    VC_CHECK(!dedup.IsDuplicate("doorbell/front", "ring2", kStart + 30ms));
+    VC_CHECK(!dedup.IsDuplicate("ring", "doorbell/front", kStart + 40ms));
+    VC_CHECK(!dedup.IsDuplicate("doorbell/front", "ring", kStart + 1000ms));
+    VC_CHECK(dedup.hits() == 2 && dedup.misses() == 5);
+}
+
+// A button held down republishing every 400 ms still rings once a second.
+void CheckSteadyRepeat() {
+    chime::RingDeduplicator dedup(1000ms);
+    int rings = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (!dedup.IsDuplicate("doorbell", "", kStart + i * 400ms)) {
+            ++rings;
+        }
+    }
+    // Accepted at 0, 1200, 2400 and 3600 ms.
+    VC_CHECK(rings == 4);
+}
+
+void CheckDisabled() {
+    chime::RingDeduplicator dedup(0ms);
+    VC_CHECK(!dedup.IsDuplicate("doorbell", "ring", kStart));
+    VC_CHECK(!dedup.IsDuplicate("doorbell", "ring", kStart));
+    VC_CHECK(dedup.hits() == 0 && dedup.misses() == 2);
+}
+
+void CheckCapacity() {
+    chime::RingDeduplicator dedup(60s);
+    for (std::size_t i = 0; i < chime::RingDeduplicator::kCapacity; ++i) {
+        VC_CHECK(!dedup.IsDuplicate("topic/" + std::to_string(i), "x", kStart));
+    }
+    VC_CHECK(dedup.IsDuplicate("topic/0", "x", kStart + 1s));
+    // One more ring overwrites the oldest slot, topic/0's.
+    VC_CHECK(!dedup.IsDuplicate("topic/new", "x", kStart + 1s));
+    VC_CHECK(!dedup.IsDuplicate("topic/0", "x", kStart + 2s));
+    VC_CHECK(dedup.IsDuplicate("topic/new", "x", kStart + 2s));
+}
+
+} // namespace
+
+int main() {
+    CheckBurst();
+    CheckSteadyRepeat();
+    CheckDisabled();
+    CheckCapacity();
+    return vc::test::ExitCode();
+}
@@ -0,0 +1,132 @@
+// Parses ring_routes through LoadConfig and checks RingRouter's route
+// selection: priorities, ties, the ring_topic fallback and cooldowns.
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "chime/chime_config.h"
+#include "chime/ring_router.h"
+#include "test_check.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+class ConfigFile {
+  public:
+    ConfigFile()
+        : path_(std::filesystem::temp_directory_path() / ("chime_ring_router_test." + std::to_string(getpid()))) {}
+    ~ConfigFile() { std::filesystem::remove(path_); }
+
+    // Loads the required keys plus `extra`.
+    chime::ChimeConfig Load(const std::string &extra) {
+        {
+            std::ofstream file(path_, std::ios::trunc);
+            file << "mqtt_host=broker\nmqtt_port=1883\nmqtt_topics=doorbell/#\n" << extra << "\n";
+        }
+        const auto result = chime::LoadConfig(path_.string());
+        VC_CHECK_CTX(result.success, result.error);
+        return result.config;
+    }
+
+  private:
+    std::filesystem::path path_;
+};
+
+void CheckParse(ConfigFile &file) {
+    const chime::ChimeConfig config =
+        file.Load("ring_routes=doorbell/front | front.wav | 90 | 5 | 2000, doorbell/+ |/abs/any.wav,"
+                  "doorbell/back|back.wav||-3|");
+    VC_CHECK(config.ring_routes.size() == 3);
+    if (config.ring_routes.size() != 3) {
+        return;
+    }
+    const chime::RingRoute &front = config.ring_routes[0];
+    VC_CHECK(front.topic_filter == "doorbell/front" && front.sound == "front.wav");
+    VC_CHECK(front.volume == 90 && front.priority == 5 && front.cooldown_ms == 2000);
+    // Omitted and empty optional fields keep their defaults.
+    const chime::RingRoute &any = config.ring_routes[1];
+    VC_CHECK(any.topic_filter == "doorbell/+" && any.sound == "/abs/any.wav");
+    VC_CHECK(any.volume == -1 && any.priority == 0 && any.cooldown_ms == 0);
+    const chime::RingRoute &back = config.ring_routes[2];
+    VC_CHECK(back.volume == -1 && back.priority == -3 && back.cooldown_ms == 0);
+}
+
+// Any malformed entry rejects the whole key, leaving the default (empty).
+void CheckRejected(ConfigFile &file) {
+    const std::vector<std::string> rejected = {
+        "a|b.wav|101", "a|b.wav|-1", "a|b.wav|50|1001", "a|b.wav|50|0|3600001", "a", "|b.wav", "a|",
+        "a|b.wav|50|0|0|x", "a|b.wav|loud", "a|b.wav|5x", "ok|ok.wav, bad"};
+    for (const std::string &value : rejected) {
+        const chime::ChimeConfig config = file.Load("ring_routes=" + value);
+        VC_CHECK_CTX(config.ring_routes.empty(), value);
+    }
+}
+
+void CheckMatch(ConfigFile &file) {
+    chime::ChimeConfig config = file.Load("ring_sounds_dir=/sounds\nvolume_bell=40\n"
+                                          "ring_routes=doorbell/#|all.wav,doorbell/front|front.wav|90|5,"
+                                          "doorbell/+|plus.wav||5,doorbell/bad#|bad.wav");
+    chime::RingRouter router;
+    std::vector<std::string> errors;
+    router.Build(config, &errors);
+    VC_CHECK(errors.size() == 1);
+    VC_CHECK(router.routes().size() == 3);
+
+    // doorbell/front and doorbell/+ tie on priority; the earlier one wins.
+    const chime::RingRouter::Route *route = router.Match("doorbell/front");
+    VC_CHECK(route != nullptr && route->sound_path == "/sounds/front.wav" && route->volume == 90);
+    // Higher priority beats the broader doorbell/#, listed first.
+    route = router.Match("doorbell/back");
+    VC_CHECK(route != nullptr && route->sound_path == "/sounds/plus.wav" && route->volume == 40);
+    route = router.Match("doorbell/back/gate");
+    VC_CHECK(route != nullptr && route->sound_path == "/sounds/all.wav");
+    VC_CHECK(router.Match("garage/open") == nullptr);
+}
+
+void CheckFallback(ConfigFile &file) {
+    chime::ChimeConfig config = file.Load("ring_topic=home/+/ring\nsound_path=/usr/ring.wav\nvolume_bell=65");
+    chime::RingRouter router;
+    router.Build(config, nullptr);
+    VC_CHECK(router.routes().size() == 1);
+    const chime::RingRouter::Route *route = router.Match("home/porch/ring");
+    VC_CHECK(route != nullptr && route->sound_path == "/usr/ring.wav" && route->volume == 65);
+    VC_CHECK(router.Match("home/porch") == nullptr);
+}
+
+void CheckCooldown(ConfigFile &file) {
+    chime::ChimeConfig config = file.Load("ring_routes=a|a.wav|||500,b|b.wav");
+    chime::RingRouter router;
+    router.Build(config, nullptr);
+    const chime::RingRouter::Route *a = router.Match("a");
+    const chime::RingRouter::Route *b = router.Match("b");
+    VC_CHECK(a != nullptr && b != nullptr);
+    if (a == nullptr || b == nullptr) {
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    VC_CHECK(router.Admit(*a, start));
+    VC_CHECK(!router.Admit(*a, start + 499ms));
+    // Cooldowns are per route, and a dropped ring does not extend them.
+    VC_CHECK(router.Admit(*b, start + 100ms));
+    VC_CHECK(router.Admit(*a, start + 500ms));
+    VC_CHECK(router.Admit(*b, start + 101ms));
+}
+
+} // namespace
+
+int main() {
+    ConfigFile file;
+    CheckParse(file);
+    CheckRejected(file);
+    CheckMatch(file);
+    CheckFallback(file);
+    CheckCooldown(file);
+    return vc::test::ExitCode();
+}
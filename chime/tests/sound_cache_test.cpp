@@ -0,0 +1,152 @@
+// Exercises SoundCache's loader thread: Refresh() picking up changed and
+// removed files, and LoadAsync() for paths that were never preloaded.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "chime/sound_cache.h"
+#include "chime/wav.h"
+#include "test_check.h"
+#include "vc/logging/logger.h"
+
+namespace {
+
+constexpr auto kTimeout = std::chrono::seconds(5);
+
+void WriteWav(const std::filesystem::path &path, std::size_t frames, int16_t value) {
+    const std::vector<int16_t> samples(frames, value);
+    const std::vector<uint8_t> header = chime::BuildWavHeader(1, 48000, 16, frames * 2);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+    file.write(reinterpret_cast<const char *>(samples.data()), static_cast<std::streamsize>(frames * 2));
+}
+
+template <typename Predicate> bool WaitFor(Predicate done) {
+    const auto deadline = std::chrono::steady_clock::now() + kTimeout;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+// Collects one LoadAsync() result.
+class LoadResult {
+  public:
+    chime::SoundCache::LoadCallback Callback() {
+        return [this](std::shared_ptr<const chime::CachedSound> sound) {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            sound_ = std::move(sound);
+            done_ = true;
+            cv_.notify_all();
+        };
+    }
+
+    bool Wait(std::shared_ptr<const chime::CachedSound> *sound) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, kTimeout, [this]() { return done_; })) {
+            return false;
+        }
+        *sound = sound_;
+        return true;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool done_ = false;
+    std::shared_ptr<const chime::CachedSound> sound_;
+};
+
+void CheckRefresh(vc::logging::Logger &logger, const std::filesystem::path &dir) {
+    const std::string ring = (dir / "ring.wav").string();
+    WriteWav(ring, 480, 1000);
+
+    chime::SoundCache cache(logger, chime::PcmOutputFormat{1, 48000});
+    cache.Preload({ring});
+    const auto first = cache.Find(ring);
+    VC_CHECK(first != nullptr && first->frames() == 480);
+
+    // A different size is enough to count as changed whatever the mtime
+    // granularity.
+    WriteWav(ring, 960, 2000);
+    cache.Refresh();
+    VC_CHECK(WaitFor([&]() {
+        const auto sound = cache.Find(ring);
+        return sound != nullptr && sound->frames() == 960;
+    }));
+    // The previous version stays valid for whoever still holds it.
+    VC_CHECK(first->frames() == 480);
+
+    std::filesystem::remove(ring);
+    cache.Refresh();
+    VC_CHECK(cache.Find(ring) == nullptr);
+}
+
+void CheckDirectory(vc::logging::Logger &logger, const std::filesystem::path &dir) {
+    const std::filesystem::path sounds = dir / "sounds";
+    std::filesystem::create_directories(sounds);
+    WriteWav(sounds / "a.wav", 100, 1);
+
+    chime::SoundCache cache(logger, chime::PcmOutputFormat{2, 48000});
+    cache.PreloadDirectory(sounds.string());
+    VC_CHECK(cache.Count() == 1);
+
+    WriteWav(sounds / "b.wav", 200, 1);
+    {
+        std::ofstream broken(sounds / "c.wav", std::ios::binary);
+        broken << "not a wav file";
+    }
+    cache.Refresh();
+    VC_CHECK(WaitFor([&]() { return cache.Find((sounds / "b.wav").string()) != nullptr; }));
+    const auto b = cache.Find((sounds / "b.wav").string());
+    VC_CHECK(b != nullptr && b->channels == 2 && b->frames() == 200);
+    VC_CHECK(cache.Find((sounds / "c.wav").string()) == nullptr);
+}
+
+void CheckLoadAsync(vc::logging::Logger &logger, const std::filesystem::path &dir) {
+    const std::string late_path = (dir / "late.wav").string();
+    WriteWav(late_path, 300, 5);
+    chime::SoundCache cache(logger, chime::PcmOutputFormat{1, 48000});
+
+    LoadResult loaded;
+    cache.LoadAsync(late_path, loaded.Callback());
+    std::shared_ptr<const chime::CachedSound> sound;
+    VC_CHECK(loaded.Wait(&sound));
+    VC_CHECK(sound != nullptr && sound->frames() == 300);
+    VC_CHECK(cache.Find(late_path) == sound);
+
+    LoadResult missing;
+    cache.LoadAsync((dir / "missing.wav").string(), missing.Callback());
+    sound = std::make_shared<chime::CachedSound>();
+    VC_CHECK(missing.Wait(&sound));
+    VC_CHECK(sound == nullptr);
+}
+
+} // namespace
+
+int main() {
+    const std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / ("chime_sound_cache_test." + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+
+    vc::logging::StderrLogger logger;
+    CheckRefresh(logger, dir);
+    CheckDirectory(logger, dir);
+    CheckLoadAsync(logger, dir);
+
+    std::filesystem::remove_all(dir);
+    return vc::test::ExitCode();
+}
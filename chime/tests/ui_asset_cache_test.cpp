@@ -0,0 +1,229 @@
+// Loads a small web UI build directory into UiAssetCache and checks which
+// variant ChooseUiAssetVariant serves for a range of Accept-Encoding and
+// If-None-Match headers.
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "chime/webd_string_utils.h"
+#include "chime/webd_ui_asset_cache.h"
+#include "test_check.h"
+
+namespace {
+
+using chime::webd::ChooseUiAssetVariant;
+using chime::webd::UiAsset;
+using chime::webd::UiAssetCache;
+using chime::webd::UiAssetChoice;
+
+void WriteFile(const std::filesystem::path &path, const std::string &contents) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+}
+
+std::string Repeat(const std::string &text, int count) {
+    std::string repeated;
+    for (int i = 0; i < count; ++i) {
+        repeated += text;
+    }
+    return repeated;
+}
+
+const std::string kIndex = Repeat("<p>doorbell chime settings</p>\n", 100);
+const std::string kApp = Repeat("console.log('ring');\n", 100);
+const std::string kAppBrotli = "app brotli bytes";
+const std::string kAppGzip = "app gzip bytes";
+const std::string kVendor = Repeat("v", 100);
+const std::string kVendorBrotli = Repeat("b", 95);
+const std::string kLogo = Repeat("png!", 100);
+
+// index.html is gzipped at load; app.js ships both precompressed copies;
+// vendor.js ships a brotli copy that saves too little to keep; tiny.css
+// and logo.png get no compressed copy; orphan.txt.gz has no base file.
+void WriteDist(const std::filesystem::path &dist) {
+    WriteFile(dist / "index.html", kIndex);
+    WriteFile(dist / "assets/app.js", kApp);
+    WriteFile(dist / "assets/app.js.br", kAppBrotli);
+    WriteFile(dist / "assets/app.js.gz", kAppGzip);
+    WriteFile(dist / "assets/vendor.js", kVendor);
+    WriteFile(dist / "assets/vendor.js.br", kVendorBrotli);
+    WriteFile(dist / "tiny.css", "a{}");
+    WriteFile(dist / "logo.png", kLogo);
+    WriteFile(dist / "orphan.txt.gz", "orphan");
+}
+
+void CheckLoad(const UiAssetCache &cache) {
+    VC_CHECK(cache.totals().files == 6);
+
+    const UiAsset *index = cache.Find("/");
+    VC_CHECK(index != nullptr && index == cache.Find("/index.html"));
+    if (index != nullptr) {
+        VC_CHECK(index->identity.body == kIndex);
+        VC_CHECK(index->content_type == "text/html; charset=utf-8");
+        VC_CHECK(index->cache_control == "no-cache");
+        VC_CHECK(index->gzip.body.size() > 2 && index->gzip.body.size() < kIndex.size());
+        VC_CHECK(index->gzip.body.substr(0, 2) == "\x1f\x8b");
+        VC_CHECK(index->brotli.body.empty() && index->brotli.etag.empty());
+        VC_CHECK(index->gzip.etag.size() == index->identity.etag.size() + 5);
+        VC_CHECK(index->gzip.etag.substr(0, index->identity.etag.size() - 1) ==
+                 index->identity.etag.substr(0, index->identity.etag.size() - 1));
+    }
+
+    const UiAsset *app = cache.Find("/assets/app.js");
+    VC_CHECK(app != nullptr);
+    if (app != nullptr) {
+        VC_CHECK(app->identity.body == kApp);
+        VC_CHECK(app->brotli.body == kAppBrotli);
+        VC_CHECK(app->gzip.body == kAppGzip);
+        VC_CHECK(app->cache_control == "public, max-age=31536000, immutable");
+        VC_CHECK(app->brotli.etag != app->gzip.etag && app->gzip.etag != app->identity.etag);
+    }
+    // Precompressed siblings are not assets of their own.
+    VC_CHECK(cache.Find("/assets/app.js.br") == nullptr);
+    VC_CHECK(cache.Find("/assets/app.js.gz") == nullptr);
+    VC_CHECK(cache.Find("/assets/vendor.js.br") == nullptr);
+
+    // 95 of 100 bytes is not worth decompressing; a generated gzip is.
+    const UiAsset *vendor = cache.Find("/assets/vendor.js");
+    VC_CHECK(vendor != nullptr && vendor->brotli.body.empty() && vendor->brotli.etag.empty());
+    VC_CHECK(vendor != nullptr && !vendor->gzip.body.empty());
+
+    const UiAsset *tiny = cache.Find("/tiny.css");
+    VC_CHECK(tiny != nullptr && tiny->identity.body == "a{}" && tiny->gzip.body.empty() && tiny->gzip.etag.empty());
+
+    const UiAsset *logo = cache.Find("/logo.png");
+    VC_CHECK(logo != nullptr && logo->content_type == "image/png" && logo->gzip.body.empty());
+    VC_CHECK(logo != nullptr && logo->cache_control == "public, max-age=3600");
+
+    const UiAsset *orphan = cache.Find("/orphan.txt.gz");
+    VC_CHECK(orphan != nullptr && orphan->identity.body == "orphan");
+    VC_CHECK(orphan != nullptr && orphan->content_type == "application/octet-stream");
+
+    VC_CHECK(cache.Find("/missing.js") == nullptr);
+}
+
+void CheckAcceptsEncoding() {
+    using chime::webd::AcceptsEncoding;
+    VC_CHECK(AcceptsEncoding("gzip, deflate, br", "br"));
+    VC_CHECK(AcceptsEncoding(" GZip ;Q=0.5", "gzip"));
+    VC_CHECK(AcceptsEncoding("gzip;q=0.001", "gzip"));
+    VC_CHECK(!AcceptsEncoding("br;q=0, gzip", "br"));
+    VC_CHECK(!AcceptsEncoding("br;q=0.000", "br"));
+    VC_CHECK(!AcceptsEncoding("deflate", "gzip"));
+    VC_CHECK(!AcceptsEncoding("", "gzip"));
+
+    // "*" covers codings not named, whichever order they come in.
+    VC_CHECK(AcceptsEncoding("*", "br"));
+    VC_CHECK(!AcceptsEncoding("*;q=0", "br"));
+    VC_CHECK(AcceptsEncoding("gzip;q=0, *", "br"));
+    VC_CHECK(!AcceptsEncoding("gzip;q=0, *", "gzip"));
+    VC_CHECK(!AcceptsEncoding("*, gzip;q=0", "gzip"));
+    VC_CHECK(AcceptsEncoding("*;q=0, gzip", "gzip"));
+}
+
+void CheckEtagListMatches() {
+    using chime::webd::EtagListMatches;
+    VC_CHECK(EtagListMatches("\"abc\"", "\"abc\""));
+    VC_CHECK(EtagListMatches("W/\"abc\"", "\"abc\""));
+    VC_CHECK(EtagListMatches("\"x\",  W/\"abc\" ", "\"abc\""));
+    VC_CHECK(EtagListMatches("*", "\"abc\""));
+    VC_CHECK(!EtagListMatches("\"abcd\"", "\"abc\""));
+    VC_CHECK(!EtagListMatches("\"ab\"", "\"abc\""));
+    VC_CHECK(!EtagListMatches("", "\"abc\""));
+}
+
+void CheckChooseVariant(const UiAssetCache &cache) {
+    const UiAsset *app = cache.Find("/assets/app.js");
+    const UiAsset *index = cache.Find("/index.html");
+    const UiAsset *logo = cache.Find("/logo.png");
+    if (app == nullptr || index == nullptr || logo == nullptr) {
+        VC_CHECK(false);
+        return;
+    }
+
+    UiAssetChoice choice = ChooseUiAssetVariant(*app, "gzip, deflate, br", "");
+    VC_CHECK(choice.variant == &app->brotli && choice.content_encoding == "br");
+    VC_CHECK(choice.vary_accept_encoding && !choice.not_modified);
+    choice = ChooseUiAssetVariant(*app, "br;q=0, gzip", "");
+    VC_CHECK(choice.variant == &app->gzip && choice.content_encoding == "gzip");
+    choice = ChooseUiAssetVariant(*app, "*", "");
+    VC_CHECK(choice.variant == &app->brotli);
+    choice = ChooseUiAssetVariant(*app, "*;q=0", "");
+    VC_CHECK(choice.variant == &app->identity && choice.content_encoding.empty());
+    choice = ChooseUiAssetVariant(*app, "", "");
+    VC_CHECK(choice.variant == &app->identity && choice.vary_accept_encoding);
+
+    // No brotli copy: "br" alone gets identity.
+    choice = ChooseUiAssetVariant(*index, "br", "");
+    VC_CHECK(choice.variant == &index->identity && choice.vary_accept_encoding);
+    choice = ChooseUiAssetVariant(*index, "br, gzip", "");
+    VC_CHECK(choice.variant == &index->gzip && choice.content_encoding == "gzip");
+
+    // Nothing to vary on without a compressed copy.
+    choice = ChooseUiAssetVariant(*logo, "gzip, br", "");
+    VC_CHECK(choice.variant == &logo->identity && !choice.vary_accept_encoding);
+}
+
+// A client holding any encoding of the bytes gets 304, with the ETag of
+// the variant it would have been sent now.
+void CheckNotModified(const UiAssetCache &cache) {
+    const UiAsset *app = cache.Find("/assets/app.js");
+    const UiAsset *logo = cache.Find("/logo.png");
+    if (app == nullptr || logo == nullptr) {
+        VC_CHECK(false);
+        return;
+    }
+    const std::string identity(app->identity.etag);
+    const std::string gzip(app->gzip.etag);
+    const std::string brotli(app->brotli.etag);
+
+    UiAssetChoice choice = ChooseUiAssetVariant(*app, "br", identity);
+    VC_CHECK(choice.not_modified && choice.variant == &app->brotli);
+    choice = ChooseUiAssetVariant(*app, "", "W/" + gzip);
+    VC_CHECK(choice.not_modified && choice.variant == &app->identity);
+    choice = ChooseUiAssetVariant(*app, "gzip", "\"stale\", " + brotli);
+    VC_CHECK(choice.not_modified && choice.variant == &app->gzip);
+    choice = ChooseUiAssetVariant(*app, "gzip", "*");
+    VC_CHECK(choice.not_modified);
+    choice = ChooseUiAssetVariant(*app, "gzip", "\"stale\"");
+    VC_CHECK(!choice.not_modified);
+
+    // A compressed-variant tag for an asset that has none is stale.
+    const std::string logo_identity(logo->identity.etag);
+    choice = ChooseUiAssetVariant(*logo, "gzip", logo_identity.substr(0, logo_identity.size() - 1) + "-gzip\"");
+    VC_CHECK(!choice.not_modified);
+    choice = ChooseUiAssetVariant(*logo, "gzip", logo_identity);
+    VC_CHECK(choice.not_modified);
+}
+
+void CheckMissingDir(const std::filesystem::path &dir) {
+    UiAssetCache cache;
+    std::string error;
+    VC_CHECK(cache.Load((dir / "absent").string(), &error));
+    VC_CHECK(cache.empty() && cache.totals().files == 0);
+}
+
+} // namespace
+
+int main() {
+    const std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / ("chime_ui_asset_cache_test." + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    WriteDist(dir / "dist");
+
+    UiAssetCache cache;
+    std::string error;
+    VC_CHECK_CTX(cache.Load((dir / "dist").string(), &error), error);
+    CheckLoad(cache);
+    CheckAcceptsEncoding();
+    CheckEtagListMatches();
+    CheckChooseVariant(cache);
+    CheckNotModified(cache);
+    CheckMissingDir(dir);
+
+    std::filesystem::remove_all(dir);
+    return vc::test::ExitCode();
+}
@@ -0,0 +1,208 @@
+// Compiles a web UI build directory into a C++ source file for chime-webd:
+// every file with its gzip/brotli variants, content type, Cache-Control and
+// ETags, plus a collision-free slot table for EmbeddedUiPathHash. Runs on
+// the build host; a missing directory yields an empty table.
+//
+//   chime-webd-embed-ui <webui/dist> <output.cpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "chime/webd_embedded_ui.h"
+#include "chime/webd_ui_asset_cache.h"
+
+namespace {
+
+constexpr std::size_t kLiteralLineBytes = 96;
+constexpr uint32_t kMaxSeedAttempts = 1u << 24;
+
+// Printable ASCII stays readable; everything else becomes a three-digit
+// octal escape, which cannot swallow a following digit the way \x can. So
+// does '?', which would otherwise start trigraphs such as "??/" that
+// -Wtrigraphs flags in minified JavaScript.
+// Writes at least one literal, so `sizeof(literal) - 1` is the length.
+void WriteLiteral(std::ostream &out, std::string_view bytes, const char *continuation) {
+    if (bytes.empty()) {
+        out << "\"\"";
+        return;
+    }
+    std::size_t line_bytes = 0;
+    out << '"';
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        if (line_bytes == kLiteralLineBytes) {
+            out << '"' << continuation << '"';
+            line_bytes = 0;
+        }
+        const auto c = static_cast<unsigned char>(bytes[i]);
+        if (c == '"' || c == '\\') {
+            out << '\\' << static_cast<char>(c);
+        } else if (c >= 0x20 && c < 0x7f && c != '?') {
+            out << static_cast<char>(c);
+        } else {
+            char escaped[5];
+            std::snprintf(escaped, sizeof(escaped), "\\%03o", c);
+            out << escaped;
+        }
+        ++line_bytes;
+    }
+    out << '"';
+}
+
+void WriteVariant(std::ostream &out, const chime::webd::UiAssetVariant &variant, const std::string &symbol) {
+    if (variant.body.empty()) {
+        out << "{}";
+        return;
+    }
+    out << "{std::string_view(" << symbol << ", sizeof(" << symbol << ") - 1), ";
+    WriteLiteral(out, variant.etag, "\n     ");
+    out << "}";
+}
+
+// Smallest seed under which every path lands in its own slot.
+bool FindSeed(const std::vector<const chime::webd::UiAsset *> &assets, std::size_t slot_count, uint32_t *seed,
+              std::vector<int32_t> *slots) {
+    for (uint32_t candidate = 0; candidate < kMaxSeedAttempts; ++candidate) {
+        slots->assign(slot_count, -1);
+        bool collided = false;
+        for (std::size_t i = 0; i < assets.size() && !collided; ++i) {
+            int32_t &slot = (*slots)[chime::webd::EmbeddedUiPathHash(assets[i]->path, candidate) % slot_count];
+            collided = slot >= 0;
+            slot = static_cast<int32_t>(i);
+        }
+        if (!collided) {
+            *seed = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <webui-dist-dir> <output.cpp>\n";
+        return 2;
+    }
+    const std::string dist_dir = argv[1];
+    const std::filesystem::path output_path = argv[2];
+
+    chime::webd::UiAssetCache cache;
+    std::string error;
+    if (!cache.Load(dist_dir, &error)) {
+        std::cerr << "chime-webd-embed-ui: " << error << "\n";
+        return 1;
+    }
+
+    std::vector<const chime::webd::UiAsset *> assets;
+    cache.ForEach([&](const chime::webd::UiAsset &asset) { assets.push_back(&asset); });
+    std::sort(assets.begin(), assets.end(), [](const auto *a, const auto *b) { return a->path < b->path; });
+
+    const std::size_t slot_count = std::max<std::size_t>(1, assets.size() * 2);
+    uint32_t seed = 0;
+    std::vector<int32_t> slots;
+    if (!FindSeed(assets, slot_count, &seed, &slots)) {
+        std::cerr << "chime-webd-embed-ui: no collision-free seed for " << assets.size() << " paths\n";
+        return 1;
+    }
+
+    std::ostringstream out;
+    out << "// Generated by chime-webd-embed-ui from the web UI build; do not edit.\n\n"
+        << "#include \"chime/webd_embedded_ui.h\"\n\n"
+        << "#include <array>\n#include <cstdint>\n#include <string_view>\n\n"
+        << "namespace chime::webd {\nnamespace {\n\n";
+
+    for (std::size_t i = 0; i < assets.size(); ++i) {
+        const std::string prefix = "kAsset" + std::to_string(i);
+        out << "// " << assets[i]->path << "\n";
+        for (const auto &[suffix, variant] : {std::pair{"Identity", &assets[i]->identity},
+                                              std::pair{"Gzip", &assets[i]->gzip},
+                                              std::pair{"Brotli", &assets[i]->brotli}}) {
+            if (variant->body.empty()) {
+                continue;
+            }
+            out << "constexpr char " << prefix << suffix << "[] =\n    ";
+            WriteLiteral(out, variant->body, "\n    ");
+            out << ";\n";
+        }
+        out << "\n";
+    }
+
+    out << "constexpr std::array<UiAsset, " << assets.size() << "> kAssets = {{\n";
+    for (std::size_t i = 0; i < assets.size(); ++i) {
+        const std::string prefix = "kAsset" + std::to_string(i);
+        const chime::webd::UiAsset &asset = *assets[i];
+        out << "    {";
+        WriteLiteral(out, asset.path, "\n     ");
+        out << ", ";
+        WriteLiteral(out, asset.content_type, "\n     ");
+        out << ", ";
+        WriteLiteral(out, asset.cache_control, "\n     ");
+        out << ",\n     ";
+        WriteVariant(out, asset.identity, prefix + "Identity");
+        out << ",\n     ";
+        WriteVariant(out, asset.gzip, prefix + "Gzip");
+        out << ",\n     ";
+        WriteVariant(out, asset.brotli, prefix + "Brotli");
+        out << "},\n";
+    }
+    out << "}};\n\n";
+
+    out << "constexpr uint32_t kSeed = " << seed << "u;\n"
+        << "// Index into kAssets by EmbeddedUiPathHash(path, kSeed) % size; -1 is empty.\n"
+        << "constexpr std::array<int32_t, " << slots.size() << "> kSlots = {";
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        out << (i % 16 == 0 ? "\n    " : " ") << slots[i] << ",";
+    }
+    out << "\n};\n\n"
+        << "} // namespace\n\n"
+        << "const UiAsset *FindEmbeddedUiAsset(std::string_view request_path) {\n"
+        << "    const std::string_view path = request_path == \"/\" ? std::string_view(\"/index.html\") : "
+           "request_path;\n"
+        << "    const int32_t index = kSlots[EmbeddedUiPathHash(path, kSeed) % kSlots.size()];\n"
+        << "    if (index < 0 || kAssets[static_cast<std::size_t>(index)].path != path) {\n"
+        << "        return nullptr;\n"
+        << "    }\n"
+        << "    return &kAssets[static_cast<std::size_t>(index)];\n"
+        << "}\n\n"
+        << "std::size_t EmbeddedUiAssetCount() {\n"
+        << "    return kAssets.size();\n"
+        << "}\n\n"
+        << "} // namespace chime::webd\n";
+
+    // Written next to the target and renamed, so an interrupted build never
+    // leaves a truncated source behind.
+    std::error_code ec;
+    if (output_path.has_parent_path()) {
+        std::filesystem::create_directories(output_path.parent_path(), ec);
+    }
+    const std::filesystem::path temp_path = output_path.string() + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file << out.str();
+        if (!file.good()) {
+            std::cerr << "chime-webd-embed-ui: failed to write " << temp_path.string() << "\n";
+            return 1;
+        }
+    }
+    std::filesystem::rename(temp_path, output_path, ec);
+    if (ec) {
+        std::cerr << "chime-webd-embed-ui: failed to write " << output_path.string() << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    const chime::webd::UiAssetCache::Totals totals = cache.totals();
+    std::cout << "chime-webd-embed-ui: embedded " << totals.files << " files from " << dist_dir << " ("
+              << totals.identity_bytes << " bytes, " << totals.gzip_bytes << " gzip, " << totals.brotli_bytes
+              << " brotli)\n";
+    return 0;
+}
@@ -0,0 +1,151 @@
+#ifndef VC_METRICS_METRICS_H
+#define VC_METRICS_METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vc::metrics {
+
+// Metric values are relaxed atomics: any thread may update or read them
+// without locking, and a reader sees each value on its own, not a
+// consistent snapshot across metrics.
+class Counter {
+ public:
+  void Add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+  uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+ public:
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+  void Add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// Fixed-bucket histogram. `bounds` are inclusive upper bounds in ascending
+// order; values above the last one land in a final overflow bucket.
+class Histogram {
+ public:
+  explicit Histogram(std::vector<uint64_t> bounds);
+
+  void Observe(uint64_t value);
+
+  const std::vector<uint64_t>& bounds() const { return bounds_; }
+  // Count per bucket (not cumulative), bounds().size() + 1 entries.
+  std::vector<uint64_t> BucketCounts() const;
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+ private:
+  std::vector<uint64_t> bounds_;
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+};
+
+// Counters split by one label, e.g. per MQTT topic. At most `max_series`
+// label values get their own counter; later ones share the "other" series,
+// so a wildcard subscription cannot grow it without bound. Series are
+// created on first use and never removed, so returned references stay
+// valid. Get() and reading the series must happen on one thread (chime's
+// event loop); the counters themselves may be updated from anywhere.
+class CounterFamily {
+ public:
+  static constexpr std::string_view kOverflowLabel = "other";
+
+  CounterFamily(std::string label, std::size_t max_series);
+
+  // Looks an existing series up without allocating.
+  Counter& Get(std::string_view label_value);
+
+  const std::string& label() const { return label_; }
+  void ForEach(const std::function<void(std::string_view, const Counter&)>& visit) const;
+
+ private:
+  struct Hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view value) const {
+      return std::hash<std::string_view>{}(value);
+    }
+  };
+
+  std::string label_;
+  std::size_t max_series_;
+  std::unordered_map<std::string, std::unique_ptr<Counter>, Hash, std::equal_to<>>
+      series_;
+  Counter overflow_;
+};
+
+// Receives every metric of a Registry, in registration order per kind.
+class RegistryVisitor {
+ public:
+  virtual ~RegistryVisitor() = default;
+  virtual void VisitCounter(std::string_view name, std::string_view help,
+                            const Counter& counter) = 0;
+  virtual void VisitGauge(std::string_view name, std::string_view help,
+                          const Gauge& gauge) = 0;
+  virtual void VisitHistogram(std::string_view name, std::string_view help,
+                              const Histogram& histogram) = 0;
+  virtual void VisitCounterFamily(std::string_view name, std::string_view help,
+                                  const CounterFamily& family) = 0;
+};
+
+// Owns a process's metrics. Registration takes a lock and is meant for
+// startup; the returned references are stable, so hot paths update them
+// directly without touching the registry.
+class Registry {
+ public:
+  Counter& AddCounter(std::string name, std::string help);
+  Gauge& AddGauge(std::string name, std::string help);
+  Histogram& AddHistogram(std::string name, std::string help,
+                          std::vector<uint64_t> bounds);
+  CounterFamily& AddCounterFamily(std::string name, std::string help,
+                                  std::string label, std::size_t max_series);
+
+  // {"counters":{..},"gauges":{..},"histograms":{name:{"bounds":[..],
+  // "buckets":[..],"count":n,"sum":n}},"families":{name:{"label":"..",
+  // "series":{value:n}}}}. Reads families, so same thread as their Get().
+  std::string ToJson() const;
+  // Holds the registration lock; same threading rule as ToJson().
+  void Visit(RegistryVisitor& visitor) const;
+
+ private:
+  template <typename Metric>
+  struct Entry {
+    template <typename... Args>
+    Entry(std::string entry_name, std::string entry_help, Args&&... args)
+        : name(std::move(entry_name)),
+          help(std::move(entry_help)),
+          metric(std::forward<Args>(args)...) {}
+
+    std::string name;
+    std::string help;
+    Metric metric;
+  };
+
+  mutable std::mutex mutex_;
+  std::deque<Entry<Counter>> counters_;
+  std::deque<Entry<Gauge>> gauges_;
+  std::deque<Entry<Histogram>> histograms_;
+  std::deque<Entry<CounterFamily>> families_;
+};
+
+}  // namespace vc::metrics
+
+#endif
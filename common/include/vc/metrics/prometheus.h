@@ -0,0 +1,19 @@
+#ifndef VC_METRICS_PROMETHEUS_H
+#define VC_METRICS_PROMETHEUS_H
+
+#include <string>
+#include <string_view>
+
+#include "vc/metrics/stats_segment.h"
+
+namespace vc::metrics {
+
+// Renders a stats segment snapshot in the Prometheus text exposition format
+// (version 0.0.4). Every name gets `prefix`; counters also get "_total", and
+// histogram buckets are made cumulative. The segment's update time is added
+// as <prefix>stats_updated_timestamp_seconds.
+std::string FormatPrometheus(const StatsSegment& segment, std::string_view prefix);
+
+}  // namespace vc::metrics
+
+#endif
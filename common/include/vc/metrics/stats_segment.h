@@ -0,0 +1,96 @@
+#ifndef VC_METRICS_STATS_SEGMENT_H
+#define VC_METRICS_STATS_SEGMENT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace vc::metrics {
+
+class Registry;
+
+// Fixed-layout copy of a Registry in a file-backed shared mapping (normally
+// on tmpfs), so another process can read the metrics without asking the
+// owner for them. One process writes, any number read; a sequence counter
+// (seqlock) lets readers detect and retry a copy that raced a write, so the
+// writer never waits for them.
+//
+// Every series is one entry: a counter, a gauge, a histogram, or one label
+// value of a counter family. Names and help are truncated to their fields.
+// Label values never are: one that does not fit is counted under the
+// family's overflow series. Metrics beyond kMaxSeries or histograms with
+// more than kMaxBounds bounds are left out.
+struct StatsSeries {
+  enum class Type : uint8_t { kCounter, kGauge, kHistogram };
+
+  static constexpr std::size_t kNameSize = 48;
+  static constexpr std::size_t kHelpSize = 80;
+  static constexpr std::size_t kLabelNameSize = 16;
+  static constexpr std::size_t kLabelValueSize = 96;
+  static constexpr std::size_t kMaxBounds = 12;
+
+  char name[kNameSize];
+  char help[kHelpSize];
+  // Empty unless the series belongs to a counter family.
+  char label_name[kLabelNameSize];
+  char label_value[kLabelValueSize];
+  Type type;
+  uint8_t bound_count;
+  // Counter and gauge value; histograms use count/sum/buckets instead.
+  int64_t value;
+  uint64_t count;
+  uint64_t sum;
+  uint64_t bounds[kMaxBounds];
+  // Not cumulative; bound_count + 1 entries, the last one for overflow.
+  uint64_t buckets[kMaxBounds + 1];
+};
+
+struct StatsSegment {
+  static constexpr uint32_t kMagic = 0x53544154;  // "STAT"
+  static constexpr uint32_t kVersion = 1;
+  static constexpr std::size_t kMaxSeries = 192;
+
+  uint32_t magic;
+  uint32_t version;
+  // Odd while the writer is updating the entries below.
+  std::atomic<uint32_t> sequence;
+  uint32_t series_count;
+  // Unix time of the last update.
+  int64_t updated_at;
+  StatsSeries series[kMaxSeries];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "the seqlock counter is shared between processes");
+
+class StatsSegmentWriter {
+ public:
+  StatsSegmentWriter() = default;
+  ~StatsSegmentWriter();
+
+  StatsSegmentWriter(const StatsSegmentWriter&) = delete;
+  StatsSegmentWriter& operator=(const StatsSegmentWriter&) = delete;
+
+  // Creates or reuses the file at `path` and maps it. Readers that have it
+  // open keep working across a restart of the writer.
+  bool Open(const std::string& path, std::string* error);
+  bool IsOpen() const { return segment_ != nullptr; }
+
+  // Copies every metric into the segment. Reads counter families, so it runs
+  // on the thread that updates them (see CounterFamily).
+  void Publish(const Registry& registry);
+
+ private:
+  StatsSegment* segment_ = nullptr;
+};
+
+// Copies a consistent snapshot of the segment at `path` into `out`. Fails if
+// the file is missing, has a different layout, or stayed mid-update for
+// every retry.
+bool ReadStatsSegment(const std::string& path, StatsSegment* out,
+                      std::string* error);
+
+}  // namespace vc::metrics
+
+#endif
@@ -1,7 +1,10 @@
 #ifndef VC_MQTT_CLIENT_H
 #define VC_MQTT_CLIENT_H
 
+#include <chrono>
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace vc::logging {
 class Logger;
@@ -12,13 +15,36 @@ struct mosquitto_message;
 
 namespace vc::mqtt {
 
+struct MessageView;
+
+// Owning copy of a message, for handlers that keep it past OnMessage().
 struct Message {
   std::string topic;
   std::string payload;
   int qos = 0;
   bool retain = false;
+
+  MessageView View() const;
+};
+
+// Received message as delivered to EventHandler::OnMessage(). Topic and
+// payload point into mosquitto's buffers and are only valid until the
+// callback returns; use ToOwned() to keep them.
+struct MessageView {
+  std::string_view topic;
+  std::string_view payload;
+  int qos = 0;
+  bool retain = false;
+
+  Message ToOwned() const {
+    return Message{std::string(topic), std::string(payload), qos, retain};
+  }
 };
 
+inline MessageView Message::View() const {
+  return MessageView{topic, payload, qos, retain};
+}
+
 struct ConnectOptions {
   std::string client_id;
   std::string username;
@@ -34,12 +60,25 @@ struct ConnectOptions {
   bool reconnect_exponential_backoff = true;
 };
 
+// Read-side counters of the external event loop path (DrainRead).
+struct ReadStats {
+  unsigned long long drains = 0;
+  // mosquitto_loop_read() calls; each handles about one packet.
+  unsigned long long reads = 0;
+  // Drains that hit their time budget with input still queued.
+  unsigned long long budget_exhausted = 0;
+  unsigned int max_batch = 0;
+  // Input left in the socket after the last drain, and the largest seen.
+  std::size_t backlog_bytes = 0;
+  std::size_t max_backlog_bytes = 0;
+};
+
 class EventHandler {
  public:
   virtual ~EventHandler() = default;
   virtual void OnConnect(int rc) = 0;
   virtual void OnDisconnect(int rc) = 0;
-  virtual void OnMessage(const Message& message) = 0;
+  virtual void OnMessage(const MessageView& message) = 0;
 };
 
 class Client {
@@ -58,6 +97,24 @@ class Client {
   bool Publish(const std::string& topic, const std::string& payload, int qos,
                bool retain);
 
+  // External event loop support, used instead of Loop(): watch Socket()
+  // (-1 while there is no connection) for reads, and for writes while
+  // WantWrite(); call DrainRead()/LoopWrite() when it is ready and
+  // LoopMisc() often enough to send keepalive pings. Return values are
+  // MOSQ_ERR_* codes like Loop(); any non-zero code means the connection
+  // needs Reconnect().
+  int Socket() const;
+  bool WantWrite() const;
+  // Handles packets until the socket has no input left or `budget` has
+  // passed, so a burst (retained replay after reconnect, a busy wildcard
+  // subscription) is drained in one wakeup without starving timers.
+  int DrainRead(std::chrono::microseconds budget);
+  int LoopWrite();
+  int LoopMisc();
+  // Bytes received by the kernel but not yet read.
+  std::size_t PendingBytes() const;
+  const ReadStats& read_stats() const { return read_stats_; }
+
   bool IsConnected() const;
   std::string LastError() const;
 
@@ -76,6 +133,7 @@ class Client {
   bool connected_ = false;
   bool lib_ready_ = false;
   std::string last_error_;
+  ReadStats read_stats_;
 };
 
 }  // namespace vc::mqtt
@@ -0,0 +1,98 @@
+#ifndef VC_MQTT_TOPIC_MATCHER_H
+#define VC_MQTT_TOPIC_MATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vc::mqtt {
+
+// True if `filter` is a valid MQTT subscription filter: non-empty, '+' and
+// '#' only as whole levels, '#' only as the last level.
+bool IsValidTopicFilter(std::string_view filter);
+
+// Set of MQTT topic filters compiled into a trie keyed by topic level, each
+// mapped to a caller-chosen action id (typically an index into the
+// caller's own table). Matching walks the topic once, following the exact,
+// '+' and '#' branches of each level, so its cost depends on the topic's
+// depth rather than the number of filters, and it does not allocate.
+class TopicMatcher {
+ public:
+  TopicMatcher();
+
+  // Adds `filter` -> `action`. The same filter may map to several actions.
+  bool Add(std::string_view filter, std::size_t action, std::string* error);
+  void Clear();
+  bool empty() const { return filters_ == 0; }
+  std::size_t size() const { return filters_; }
+
+  // Calls `visit(action)` for every filter matching `topic`. Order follows
+  // the trie, not insertion order.
+  template <typename Visitor>
+  void ForEachMatch(std::string_view topic, Visitor&& visit) const {
+    Visit(0, topic, 0, visit);
+  }
+
+  bool Matches(std::string_view topic) const;
+
+ private:
+  static constexpr uint32_t kNoNode = UINT32_MAX;
+
+  struct LevelHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view level) const {
+      return std::hash<std::string_view>{}(level);
+    }
+  };
+
+  struct Node {
+    std::unordered_map<std::string, uint32_t, LevelHash, std::equal_to<>>
+        children;
+    uint32_t plus_child = kNoNode;
+    // Filters ending at this node.
+    std::vector<std::size_t> actions;
+    // Filters ending in "/#" below this node; they match this level and
+    // everything under it.
+    std::vector<std::size_t> hash_actions;
+  };
+
+  // `pos` is the offset of the next topic level, or past the end once all
+  // levels are consumed.
+  template <typename Visitor>
+  void Visit(uint32_t index, std::string_view topic, std::size_t pos,
+             Visitor& visit) const {
+    const Node& node = nodes_[index];
+    for (const std::size_t action : node.hash_actions) {
+      visit(action);
+    }
+    if (pos > topic.size()) {
+      for (const std::size_t action : node.actions) {
+        visit(action);
+      }
+      return;
+    }
+
+    std::size_t end = topic.find('/', pos);
+    if (end == std::string_view::npos) {
+      end = topic.size();
+    }
+    const auto child = node.children.find(topic.substr(pos, end - pos));
+    if (child != node.children.end()) {
+      Visit(child->second, topic, end + 1, visit);
+    }
+    if (node.plus_child != kNoNode) {
+      Visit(node.plus_child, topic, end + 1, visit);
+    }
+  }
+
+  std::vector<Node> nodes_;
+  std::size_t filters_ = 0;
+};
+
+}  // namespace vc::mqtt
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef VC_RUNTIME_EVENT_LOOP_H
+#define VC_RUNTIME_EVENT_LOOP_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vc::runtime {
+
+// Single-threaded reactor: waits on file descriptors and timers and runs
+// their callbacks on the calling thread, so an idle process sleeps in the
+// kernel until there is real work. On Linux it is built on epoll with one
+// timerfd per timer; elsewhere it falls back to poll() with the nearest
+// timer deadline as the timeout.
+//
+// Callbacks may watch, unwatch and (re)arm from inside the loop. A
+// descriptor that is unwatched during a dispatch round gets no further
+// events from that round, even if its number is reused right away.
+class EventLoop {
+ public:
+  static constexpr uint32_t kReadable = 1u << 0;
+  static constexpr uint32_t kWritable = 1u << 1;
+  // Error or hang-up; always reported, never needs to be requested.
+  static constexpr uint32_t kError = 1u << 2;
+
+  using FdCallback = std::function<void(uint32_t events)>;
+  using TimerCallback = std::function<void()>;
+  using TimerId = int;
+
+  EventLoop();
+  ~EventLoop();
+
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+  bool Open(std::string* error);
+
+  // Starts watching `fd` (replacing any previous watch of it).
+  bool Watch(int fd, uint32_t events, FdCallback callback, std::string* error);
+  bool SetEvents(int fd, uint32_t events, std::string* error);
+  void Unwatch(int fd);
+
+  // Timers start disarmed. A zero `interval` makes the timer one-shot.
+  TimerId AddTimer(TimerCallback callback, std::string* error);
+  bool ArmTimer(TimerId id, std::chrono::milliseconds first,
+                std::chrono::milliseconds interval, std::string* error);
+  void DisarmTimer(TimerId id);
+
+  // Waits up to `timeout_ms` (-1 = until something is ready) and runs the
+  // callbacks of everything that became ready. Returns false only if waiting
+  // itself failed; an interrupting signal is not an error.
+  bool RunOnce(int timeout_ms, std::string* error);
+
+  // Number of times RunOnce() returned from waiting.
+  uint64_t wakeups() const { return wakeups_; }
+
+ private:
+  struct FdWatch {
+    uint32_t events = 0;
+    uint32_t generation = 0;
+    FdCallback callback;
+  };
+
+  struct Timer {
+    int fd = -1;
+    bool armed = false;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::milliseconds interval{0};
+    TimerCallback callback;
+  };
+
+  void DispatchFd(int fd, uint32_t generation, uint32_t events);
+  void FireTimer(TimerId id);
+
+  int epoll_fd_ = -1;
+  uint32_t next_generation_ = 1;
+  uint64_t wakeups_ = 0;
+  std::unordered_map<int, FdWatch> watches_;
+  std::vector<Timer> timers_;
+};
+
+}  // namespace vc::runtime
+
+#endif
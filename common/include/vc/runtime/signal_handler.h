@@ -11,6 +11,10 @@ class SignalHandler {
   void Install();
   bool ShouldStop() const;
   int LastSignal() const;
+  // Becomes readable when a handled signal arrives, so an event loop can
+  // sleep indefinitely and still notice shutdown. -1 before Install().
+  int WakeFd() const;
+  void DrainWakeFd() const;
   static std::string SignalName(int signal);
 
  private:
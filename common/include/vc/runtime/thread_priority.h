@@ -0,0 +1,17 @@
+#ifndef VC_RUNTIME_THREAD_PRIORITY_H
+#define VC_RUNTIME_THREAD_PRIORITY_H
+
+#include <string>
+#include <thread>
+
+namespace vc::runtime {
+
+// Moves `thread` to SCHED_FIFO at `priority` (1-99), with
+// SCHED_RESET_ON_FORK so processes it starts do not inherit that priority.
+// Needs root, CAP_SYS_NICE or an RLIMIT_RTPRIO allowance; on failure the
+// thread keeps its normal scheduling and `error` says why.
+bool SetRealtimePriority(std::thread& thread, int priority, std::string* error);
+
+}  // namespace vc::runtime
+
+#endif
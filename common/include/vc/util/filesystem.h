@@ -7,6 +7,10 @@ namespace vc::util {
 
 bool FileExists(const std::string& path);
 std::string ReadTrimmedFile(const std::string& path);
+// Writes `contents` to a temporary file next to `path` and renames it into
+// place, creating missing parent directories.
+bool WriteFileAtomic(const std::string& path, const std::string& contents,
+                     std::string* error);
 
 }  // namespace vc::util
 
@@ -0,0 +1,108 @@
+#ifndef VC_UTIL_LRU_MAP_H
+#define VC_UTIL_LRU_MAP_H
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace vc::util {
+
+// Bounded string-keyed map that evicts its least recently used entry. Entries
+// live in a list ordered from most to least recently used, indexed by views
+// of their own keys, so lookup, touch, insert and evict are all O(1) and
+// lookups take a string_view without building a std::string. Once full, an
+// insert reuses the evicted entry's list node.
+template <typename Value>
+class LruMap {
+ public:
+  struct Entry {
+    std::string key;
+    Value value;
+  };
+  using const_iterator = typename std::list<Entry>::const_iterator;
+
+  explicit LruMap(std::size_t capacity) : capacity_(capacity) {
+    index_.reserve(capacity);
+  }
+
+  LruMap(const LruMap&) = delete;
+  LruMap& operator=(const LruMap&) = delete;
+
+  // Looks `key` up without changing its recency.
+  Value* Find(std::string_view key) {
+    const auto it = index_.find(key);
+    return it == index_.end() ? nullptr : &it->second->value;
+  }
+
+  // Looks `key` up and marks it most recently used.
+  Value* Touch(std::string_view key) {
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->value;
+  }
+
+  // Inserts `key` as the most recently used entry, evicting the least
+  // recently used one if the map is full. An existing key is only touched;
+  // the returned flag tells whether `value` was stored.
+  std::pair<Value*, bool> Emplace(std::string_view key, Value value) {
+    if (Value* existing = Touch(key); existing != nullptr) {
+      return {existing, false};
+    }
+    if (capacity_ == 0) {
+      return {nullptr, false};
+    }
+
+    if (entries_.size() >= capacity_) {
+      auto oldest = std::prev(entries_.end());
+      index_.erase(oldest->key);
+      oldest->key.assign(key);
+      oldest->value = std::move(value);
+      entries_.splice(entries_.begin(), entries_, oldest);
+    } else {
+      entries_.push_front(Entry{std::string(key), std::move(value)});
+    }
+    index_.emplace(entries_.front().key, entries_.begin());
+    return {&entries_.front().value, true};
+  }
+
+  bool Erase(std::string_view key) {
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+      return false;
+    }
+    const auto entry = it->second;
+    index_.erase(it);
+    entries_.erase(entry);
+    return true;
+  }
+
+  void Clear() {
+    index_.clear();
+    entries_.clear();
+  }
+
+  std::size_t size() const { return entries_.size(); }
+  std::size_t capacity() const { return capacity_; }
+  bool empty() const { return entries_.empty(); }
+
+  // Most recently used first.
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+ private:
+  std::size_t capacity_;
+  std::list<Entry> entries_;
+  std::unordered_map<std::string_view, typename std::list<Entry>::iterator>
+      index_;
+};
+
+}  // namespace vc::util
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef VC_UTIL_STRINGS_H
 #define VC_UTIL_STRINGS_H
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -11,6 +12,10 @@ std::string BoolToString(bool value);
 std::string Join(const std::vector<std::string>& values, std::string_view separator);
 std::string EscapeShellDoubleQuotes(const std::string& value);
 std::string SanitizePayloadForLog(std::string_view payload);
+// Appends the sanitized form of at most `max_bytes` of `payload` to `out`,
+// followed by "..." if it was cut short. Lets callers reuse one buffer.
+void AppendPayloadForLog(std::string_view payload, std::size_t max_bytes,
+                         std::string* out);
 
 }  // namespace vc::util
 
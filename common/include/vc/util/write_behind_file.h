@@ -0,0 +1,58 @@
+#ifndef VC_UTIL_WRITE_BEHIND_FILE_H
+#define VC_UTIL_WRITE_BEHIND_FILE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace vc::logging {
+class Logger;
+}
+
+namespace vc::util {
+
+// Keeps a small file in sync with in-memory state without writing it on
+// the caller's thread. Update() only swaps the pending contents; a worker
+// thread writes them atomically once `delay` has passed since the first
+// unwritten update, so a burst of changes costs one write. Stop() (and the
+// destructor) writes whatever is still pending before returning.
+class WriteBehindFile {
+ public:
+  WriteBehindFile(vc::logging::Logger& logger, std::string path,
+                  std::chrono::milliseconds delay);
+  ~WriteBehindFile();
+
+  WriteBehindFile(const WriteBehindFile&) = delete;
+  WriteBehindFile& operator=(const WriteBehindFile&) = delete;
+
+  void Update(std::string contents);
+  void Stop();
+
+  unsigned long long writes() const;
+  // Updates replaced by a newer one before they were written.
+  unsigned long long coalesced() const;
+
+ private:
+  void Run();
+  void Write(const std::string& contents);
+
+  vc::logging::Logger& logger_;
+  const std::string path_;
+  const std::chrono::milliseconds delay_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::optional<std::string> pending_;
+  std::chrono::steady_clock::time_point due_;
+  bool stopping_ = false;
+  unsigned long long writes_ = 0;
+  unsigned long long coalesced_ = 0;
+  std::thread worker_;
+};
+
+}  // namespace vc::util
+
+#endif
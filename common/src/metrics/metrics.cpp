@@ -0,0 +1,204 @@
+#include "vc/metrics/metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace vc::metrics {
+namespace {
+
+void AppendJsonString(std::string_view value, std::string* out) {
+  out->push_back('"');
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        out->append("\\\"");
+        break;
+      case '\\':
+        out->append("\\\\");
+        break;
+      case '\n':
+        out->append("\\n");
+        break;
+      case '\r':
+        out->append("\\r");
+        break;
+      case '\t':
+        out->append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out->append(escaped);
+        } else {
+          out->push_back(c);
+        }
+    }
+  }
+  out->push_back('"');
+}
+
+void AppendKey(std::string_view key, bool* first, std::string* out) {
+  if (!*first) {
+    out->push_back(',');
+  }
+  *first = false;
+  AppendJsonString(key, out);
+  out->push_back(':');
+}
+
+template <typename T>
+void AppendArray(const std::vector<T>& values, std::string* out) {
+  out->push_back('[');
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    if (i > 0) {
+      out->push_back(',');
+    }
+    out->append(std::to_string(values[i]));
+  }
+  out->push_back(']');
+}
+
+}  // namespace
+
+Histogram::Histogram(std::vector<uint64_t> bounds)
+    : bounds_(std::move(bounds)),
+      buckets_(std::make_unique<std::atomic<uint64_t>[]>(bounds_.size() + 1)) {
+  std::sort(bounds_.begin(), bounds_.end());
+  for (std::size_t i = 0; i <= bounds_.size(); ++i) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::Observe(uint64_t value) {
+  const auto bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+  buckets_[static_cast<std::size_t>(bucket)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+std::vector<uint64_t> Histogram::BucketCounts() const {
+  std::vector<uint64_t> counts(bounds_.size() + 1);
+  for (std::size_t i = 0; i < counts.size(); ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  return counts;
+}
+
+CounterFamily::CounterFamily(std::string label, std::size_t max_series)
+    : label_(std::move(label)), max_series_(max_series) {
+  series_.reserve(max_series);
+}
+
+Counter& CounterFamily::Get(std::string_view label_value) {
+  if (const auto it = series_.find(label_value); it != series_.end()) {
+    return *it->second;
+  }
+  if (series_.size() >= max_series_) {
+    return overflow_;
+  }
+  return *series_.emplace(std::string(label_value), std::make_unique<Counter>())
+              .first->second;
+}
+
+void CounterFamily::ForEach(
+    const std::function<void(std::string_view, const Counter&)>& visit) const {
+  for (const auto& [value, counter] : series_) {
+    visit(value, *counter);
+  }
+  if (overflow_.value() > 0) {
+    visit(kOverflowLabel, overflow_);
+  }
+}
+
+Counter& Registry::AddCounter(std::string name, std::string help) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return counters_.emplace_back(std::move(name), std::move(help)).metric;
+}
+
+Gauge& Registry::AddGauge(std::string name, std::string help) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return gauges_.emplace_back(std::move(name), std::move(help)).metric;
+}
+
+Histogram& Registry::AddHistogram(std::string name, std::string help,
+                                  std::vector<uint64_t> bounds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return histograms_.emplace_back(std::move(name), std::move(help), std::move(bounds))
+      .metric;
+}
+
+CounterFamily& Registry::AddCounterFamily(std::string name, std::string help,
+                                          std::string label,
+                                          std::size_t max_series) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return families_
+      .emplace_back(std::move(name), std::move(help), std::move(label), max_series)
+      .metric;
+}
+
+std::string Registry::ToJson() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string out = "{\"counters\":{";
+  bool first = true;
+  for (const auto& entry : counters_) {
+    AppendKey(entry.name, &first, &out);
+    out.append(std::to_string(entry.metric.value()));
+  }
+
+  out.append("},\"gauges\":{");
+  first = true;
+  for (const auto& entry : gauges_) {
+    AppendKey(entry.name, &first, &out);
+    out.append(std::to_string(entry.metric.value()));
+  }
+
+  out.append("},\"histograms\":{");
+  first = true;
+  for (const auto& entry : histograms_) {
+    const Histogram& histogram = entry.metric;
+    AppendKey(entry.name, &first, &out);
+    out.append("{\"bounds\":");
+    AppendArray(histogram.bounds(), &out);
+    out.append(",\"buckets\":");
+    AppendArray(histogram.BucketCounts(), &out);
+    out.append(",\"count\":").append(std::to_string(histogram.count()));
+    out.append(",\"sum\":").append(std::to_string(histogram.sum()));
+    out.push_back('}');
+  }
+
+  out.append("},\"families\":{");
+  first = true;
+  for (const auto& entry : families_) {
+    AppendKey(entry.name, &first, &out);
+    out.append("{\"label\":");
+    AppendJsonString(entry.metric.label(), &out);
+    out.append(",\"series\":{");
+    bool first_series = true;
+    entry.metric.ForEach([&](std::string_view value, const Counter& counter) {
+      AppendKey(value, &first_series, &out);
+      out.append(std::to_string(counter.value()));
+    });
+    out.append("}}");
+  }
+  out.append("}}");
+  return out;
+}
+
+void Registry::Visit(RegistryVisitor& visitor) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& entry : counters_) {
+    visitor.VisitCounter(entry.name, entry.help, entry.metric);
+  }
+  for (const auto& entry : gauges_) {
+    visitor.VisitGauge(entry.name, entry.help, entry.metric);
+  }
+  for (const auto& entry : histograms_) {
+    visitor.VisitHistogram(entry.name, entry.help, entry.metric);
+  }
+  for (const auto& entry : families_) {
+    visitor.VisitCounterFamily(entry.name, entry.help, entry.metric);
+  }
+}
+
+}  // namespace vc::metrics
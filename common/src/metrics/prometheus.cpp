@@ -0,0 +1,95 @@
+#include "vc/metrics/prometheus.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace vc::metrics {
+namespace {
+
+void AppendEscaped(std::string_view value, bool quote, std::string* out) {
+  for (const char c : value) {
+    if (c == '\\') {
+      out->append("\\\\");
+    } else if (c == '\n') {
+      out->append("\\n");
+    } else if (quote && c == '"') {
+      out->append("\\\"");
+    } else {
+      out->push_back(c);
+    }
+  }
+}
+
+void AppendHeader(std::string_view name, std::string_view help,
+                  const char* type, std::string* out) {
+  out->append("# HELP ").append(name).push_back(' ');
+  AppendEscaped(help, false, out);
+  out->append("\n# TYPE ").append(name).push_back(' ');
+  out->append(type).push_back('\n');
+}
+
+void AppendLabel(std::string_view name, std::string_view value, std::string* out) {
+  out->push_back('{');
+  out->append(name).append("=\"");
+  AppendEscaped(value, true, out);
+  out->append("\"}");
+}
+
+}  // namespace
+
+std::string FormatPrometheus(const StatsSegment& segment, std::string_view prefix) {
+  std::string out;
+  std::string name;
+  std::string previous;
+  const uint32_t series_count =
+      std::min<uint32_t>(segment.series_count, StatsSegment::kMaxSeries);
+  for (uint32_t i = 0; i < series_count; ++i) {
+    const StatsSeries& series = segment.series[i];
+    name.assign(prefix).append(series.name);
+
+    if (series.type == StatsSeries::Type::kHistogram) {
+      AppendHeader(name, series.help, "histogram", &out);
+      const std::size_t bound_count =
+          std::min<std::size_t>(series.bound_count, StatsSeries::kMaxBounds);
+      uint64_t cumulative = 0;
+      for (std::size_t b = 0; b <= bound_count; ++b) {
+        cumulative += series.buckets[b];
+        out.append(name).append("_bucket");
+        AppendLabel("le", b < bound_count ? std::to_string(series.bounds[b]) : "+Inf", &out);
+        out.push_back(' ');
+        out.append(std::to_string(cumulative)).push_back('\n');
+      }
+      // Buckets and count are updated separately; the bucket total keeps
+      // _count equal to the +Inf bucket.
+      out.append(name).append("_sum ").append(std::to_string(series.sum)).push_back('\n');
+      out.append(name).append("_count ").append(std::to_string(cumulative)).push_back('\n');
+      previous.clear();
+      continue;
+    }
+
+    const bool counter = series.type == StatsSeries::Type::kCounter;
+    if (counter) {
+      name.append("_total");
+    }
+    // Series of one counter family are stored next to each other and share
+    // one header.
+    if (name != previous) {
+      AppendHeader(name, series.help, counter ? "counter" : "gauge", &out);
+      previous = name;
+    }
+    out.append(name);
+    if (series.label_name[0] != '\0') {
+      AppendLabel(series.label_name, series.label_value, &out);
+    }
+    out.push_back(' ');
+    out.append(std::to_string(series.value)).push_back('\n');
+  }
+
+  name.assign(prefix).append("stats_updated_timestamp_seconds");
+  AppendHeader(name, "unix time the stats segment was last updated", "gauge", &out);
+  out.append(name).push_back(' ');
+  out.append(std::to_string(segment.updated_at)).push_back('\n');
+  return out;
+}
+
+}  // namespace vc::metrics
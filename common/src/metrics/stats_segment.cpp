@@ -0,0 +1,249 @@
+#include "vc/metrics/stats_segment.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "vc/metrics/metrics.h"
+
+namespace vc::metrics {
+namespace {
+
+// A reader copying the segment while the writer updates it simply retries;
+// the writer holds the sequence odd for microseconds.
+constexpr int kReadAttempts = 100;
+
+template <std::size_t N>
+void CopyField(std::string_view value, char (&field)[N]) {
+  const std::size_t length = std::min(value.size(), N - 1);
+  std::memcpy(field, value.data(), length);
+  field[length] = '\0';
+}
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+  return what + " " + path + ": " + std::strerror(errno);
+}
+
+class SegmentFiller final : public RegistryVisitor {
+ public:
+  explicit SegmentFiller(StatsSegment* segment) : segment_(segment) {}
+
+  void VisitCounter(std::string_view name, std::string_view help,
+                    const Counter& counter) override {
+    StatsSeries* series = Next(name, help, StatsSeries::Type::kCounter);
+    if (series != nullptr) {
+      series->value = static_cast<int64_t>(counter.value());
+    }
+  }
+
+  void VisitGauge(std::string_view name, std::string_view help,
+                  const Gauge& gauge) override {
+    StatsSeries* series = Next(name, help, StatsSeries::Type::kGauge);
+    if (series != nullptr) {
+      series->value = gauge.value();
+    }
+  }
+
+  void VisitHistogram(std::string_view name, std::string_view help,
+                      const Histogram& histogram) override {
+    const std::vector<uint64_t>& bounds = histogram.bounds();
+    if (bounds.size() > StatsSeries::kMaxBounds) {
+      return;
+    }
+    StatsSeries* series = Next(name, help, StatsSeries::Type::kHistogram);
+    if (series == nullptr) {
+      return;
+    }
+    const std::vector<uint64_t> buckets = histogram.BucketCounts();
+    series->bound_count = static_cast<uint8_t>(bounds.size());
+    std::copy(bounds.begin(), bounds.end(), series->bounds);
+    std::copy(buckets.begin(), buckets.end(), series->buckets);
+    series->count = histogram.count();
+    series->sum = histogram.sum();
+  }
+
+  // A label value too long for its field is counted under the family's
+  // overflow series instead of being cut: two long topics sharing a prefix
+  // would otherwise become duplicate series, which fails the whole scrape,
+  // and a cut could split a UTF-8 sequence.
+  void VisitCounterFamily(std::string_view name, std::string_view help,
+                          const CounterFamily& family) override {
+    uint64_t folded = 0;
+    StatsSeries* overflow = nullptr;
+    family.ForEach([&](std::string_view label_value, const Counter& counter) {
+      if (label_value.size() >= StatsSeries::kLabelValueSize) {
+        folded += counter.value();
+        return;
+      }
+      StatsSeries* series = AddLabeled(name, help, family, label_value);
+      if (series == nullptr) {
+        return;
+      }
+      series->value = static_cast<int64_t>(counter.value());
+      if (label_value == CounterFamily::kOverflowLabel) {
+        overflow = series;
+      }
+    });
+    if (folded == 0) {
+      return;
+    }
+    if (overflow == nullptr) {
+      overflow = AddLabeled(name, help, family, CounterFamily::kOverflowLabel);
+    }
+    if (overflow != nullptr) {
+      overflow->value += static_cast<int64_t>(folded);
+    }
+  }
+
+  uint32_t count() const { return count_; }
+
+ private:
+  StatsSeries* Next(std::string_view name, std::string_view help,
+                    StatsSeries::Type type) {
+    if (count_ >= StatsSegment::kMaxSeries) {
+      return nullptr;
+    }
+    StatsSeries* series = &segment_->series[count_++];
+    CopyField(name, series->name);
+    CopyField(help, series->help);
+    series->label_name[0] = '\0';
+    series->label_value[0] = '\0';
+    series->type = type;
+    series->bound_count = 0;
+    series->value = 0;
+    series->count = 0;
+    series->sum = 0;
+    return series;
+  }
+
+  StatsSeries* AddLabeled(std::string_view name, std::string_view help,
+                          const CounterFamily& family,
+                          std::string_view label_value) {
+    StatsSeries* series = Next(name, help, StatsSeries::Type::kCounter);
+    if (series != nullptr) {
+      CopyField(family.label(), series->label_name);
+      CopyField(label_value, series->label_value);
+    }
+    return series;
+  }
+
+  StatsSegment* segment_;
+  uint32_t count_ = 0;
+};
+
+}  // namespace
+
+StatsSegmentWriter::~StatsSegmentWriter() {
+  if (segment_ != nullptr) {
+    munmap(segment_, sizeof(StatsSegment));
+  }
+}
+
+bool StatsSegmentWriter::Open(const std::string& path, std::string* error) {
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    *error = ErrnoMessage("open", path);
+    return false;
+  }
+  if (ftruncate(fd, sizeof(StatsSegment)) != 0) {
+    *error = ErrnoMessage("resize", path);
+    close(fd);
+    return false;
+  }
+  void* mapping =
+      mmap(nullptr, sizeof(StatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    *error = ErrnoMessage("map", path);
+    return false;
+  }
+
+  segment_ = static_cast<StatsSegment*>(mapping);
+  // A segment left by an earlier run keeps its sequence, so readers that
+  // still have it mapped never see the counter go backwards; make it even in
+  // case that run died mid-update.
+  uint32_t sequence = segment_->sequence.load(std::memory_order_relaxed);
+  if (segment_->magic != StatsSegment::kMagic ||
+      segment_->version != StatsSegment::kVersion) {
+    sequence = 0;
+  }
+  segment_->sequence.store(sequence + (sequence & 1u), std::memory_order_relaxed);
+  segment_->magic = StatsSegment::kMagic;
+  segment_->version = StatsSegment::kVersion;
+  return true;
+}
+
+void StatsSegmentWriter::Publish(const Registry& registry) {
+  if (segment_ == nullptr) {
+    return;
+  }
+  const uint32_t sequence = segment_->sequence.load(std::memory_order_relaxed);
+  segment_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  SegmentFiller filler(segment_);
+  registry.Visit(filler);
+  segment_->series_count = filler.count();
+  segment_->updated_at = static_cast<int64_t>(std::time(nullptr));
+
+  segment_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool ReadStatsSegment(const std::string& path, StatsSegment* out,
+                      std::string* error) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    *error = ErrnoMessage("open", path);
+    return false;
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0 ||
+      static_cast<std::size_t>(info.st_size) != sizeof(StatsSegment)) {
+    *error = "unexpected size of " + path;
+    close(fd);
+    return false;
+  }
+  void* mapping = mmap(nullptr, sizeof(StatsSegment), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    *error = ErrnoMessage("map", path);
+    return false;
+  }
+
+  const auto* segment = static_cast<const StatsSegment*>(mapping);
+  bool copied = false;
+  for (int attempt = 0; attempt < kReadAttempts && !copied; ++attempt) {
+    const uint32_t before = segment->sequence.load(std::memory_order_acquire);
+    if ((before & 1u) != 0) {
+      sched_yield();
+      continue;
+    }
+    std::memcpy(static_cast<void*>(out), segment, sizeof(StatsSegment));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    copied = segment->sequence.load(std::memory_order_relaxed) == before;
+  }
+  munmap(mapping, sizeof(StatsSegment));
+
+  if (!copied) {
+    *error = "stats segment " + path + " busy";
+    return false;
+  }
+  if (out->magic != StatsSegment::kMagic || out->version != StatsSegment::kVersion) {
+    *error = "unknown stats segment layout in " + path;
+    return false;
+  }
+  out->series_count =
+      std::min<uint32_t>(out->series_count, StatsSegment::kMaxSeries);
+  return true;
+}
+
+}  // namespace vc::metrics
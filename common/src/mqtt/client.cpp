@@ -5,8 +5,11 @@
 #include <cerrno>
 #include <cstring>
 #include <netdb.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 
+#include <algorithm>
+#include <chrono>
 #include <mutex>
 #include <set>
 #include <string>
@@ -231,6 +234,86 @@ int Client::Loop(int timeout_ms, int max_packets) {
   return rc;
 }
 
+int Client::Socket() const {
+  return mosq_ == nullptr ? -1 : mosquitto_socket(mosq_);
+}
+
+bool Client::WantWrite() const {
+  return mosq_ != nullptr && mosquitto_want_write(mosq_);
+}
+
+int Client::DrainRead(std::chrono::microseconds budget) {
+  if (mosq_ == nullptr) {
+    SetLastError("loop called before connect");
+    return MOSQ_ERR_INVAL;
+  }
+
+  // mosquitto_loop_read() handles one packet per call (plus whatever TLS
+  // has already decrypted), so keep calling it while the kernel still holds
+  // input for us.
+  const auto deadline = std::chrono::steady_clock::now() + budget;
+  unsigned int reads = 0;
+  std::size_t pending = 0;
+  int rc = MOSQ_ERR_SUCCESS;
+  do {
+    rc = mosquitto_loop_read(mosq_, 1);
+    ++reads;
+    if (rc != MOSQ_ERR_SUCCESS) {
+      SetLastError("read error: " + std::string(mosquitto_strerror(rc)));
+      pending = 0;
+      break;
+    }
+    pending = PendingBytes();
+  } while (pending > 0 && std::chrono::steady_clock::now() < deadline);
+
+  ++read_stats_.drains;
+  read_stats_.reads += reads;
+  read_stats_.max_batch = std::max(read_stats_.max_batch, reads);
+  if (pending > 0) {
+    ++read_stats_.budget_exhausted;
+  }
+  read_stats_.backlog_bytes = pending;
+  read_stats_.max_backlog_bytes =
+      std::max(read_stats_.max_backlog_bytes, pending);
+  return rc;
+}
+
+std::size_t Client::PendingBytes() const {
+  const int socket = Socket();
+  if (socket < 0) {
+    return 0;
+  }
+  int bytes = 0;
+  if (ioctl(socket, FIONREAD, &bytes) != 0 || bytes < 0) {
+    return 0;
+  }
+  return static_cast<std::size_t>(bytes);
+}
+
+int Client::LoopWrite() {
+  if (mosq_ == nullptr) {
+    SetLastError("loop called before connect");
+    return MOSQ_ERR_INVAL;
+  }
+  const int rc = mosquitto_loop_write(mosq_, 1);
+  if (rc != MOSQ_ERR_SUCCESS) {
+    SetLastError("write error: " + std::string(mosquitto_strerror(rc)));
+  }
+  return rc;
+}
+
+int Client::LoopMisc() {
+  if (mosq_ == nullptr) {
+    SetLastError("loop called before connect");
+    return MOSQ_ERR_INVAL;
+  }
+  const int rc = mosquitto_loop_misc(mosq_);
+  if (rc != MOSQ_ERR_SUCCESS) {
+    SetLastError("keepalive error: " + std::string(mosquitto_strerror(rc)));
+  }
+  return rc;
+}
+
 bool Client::Reconnect() {
   if (mosq_ == nullptr) {
     SetLastError("reconnect called before connect");
@@ -316,13 +399,14 @@ void Client::HandleMessage(struct mosquitto*, void* obj,
     return;
   }
 
-  Message message;
+  MessageView message;
   message.topic = msg->topic;
   message.qos = msg->qos;
   message.retain = (msg->retain != 0);
   if (msg->payload != nullptr && msg->payloadlen > 0) {
-    message.payload.assign(static_cast<const char*>(msg->payload),
-                           static_cast<std::size_t>(msg->payloadlen));
+    message.payload =
+        std::string_view(static_cast<const char*>(msg->payload),
+                         static_cast<std::size_t>(msg->payloadlen));
   }
 
   self->handler_.OnMessage(message);
@@ -19,6 +19,33 @@ int Client::Loop(int, int) {
     return -1;
 }
 
+int Client::Socket() const {
+    return -1;
+}
+
+bool Client::WantWrite() const {
+    return false;
+}
+
+int Client::DrainRead(std::chrono::microseconds) {
+    SetLastError("loop unavailable: libmosquitto not available in this build");
+    return -1;
+}
+
+int Client::LoopWrite() {
+    SetLastError("loop unavailable: libmosquitto not available in this build");
+    return -1;
+}
+
+int Client::LoopMisc() {
+    SetLastError("loop unavailable: libmosquitto not available in this build");
+    return -1;
+}
+
+std::size_t Client::PendingBytes() const {
+    return 0;
+}
+
 bool Client::Reconnect() {
     SetLastError("reconnect unavailable: libmosquitto not available in this build");
     return false;
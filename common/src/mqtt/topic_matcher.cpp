@@ -0,0 +1,96 @@
+#include "vc/mqtt/topic_matcher.h"
+
+namespace vc::mqtt {
+namespace {
+
+// Splits the level starting at `*pos` and advances `*pos` past it and its
+// separator; `*pos` ends up past the end after the last level.
+std::string_view NextLevel(std::string_view topic, std::size_t* pos) {
+  std::size_t end = topic.find('/', *pos);
+  if (end == std::string_view::npos) {
+    end = topic.size();
+  }
+  const std::string_view level = topic.substr(*pos, end - *pos);
+  *pos = end + 1;
+  return level;
+}
+
+}  // namespace
+
+bool IsValidTopicFilter(std::string_view filter) {
+  if (filter.empty()) {
+    return false;
+  }
+  std::size_t pos = 0;
+  while (pos <= filter.size()) {
+    const std::string_view level = NextLevel(filter, &pos);
+    if (level == "#") {
+      return pos > filter.size();
+    }
+    if (level != "+" && level.find_first_of("+#") != std::string_view::npos) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TopicMatcher::TopicMatcher() : nodes_(1) {}
+
+bool TopicMatcher::Add(std::string_view filter, std::size_t action,
+                       std::string* error) {
+  if (!IsValidTopicFilter(filter)) {
+    if (error != nullptr) {
+      *error = "invalid topic filter '" + std::string(filter) + "'";
+    }
+    return false;
+  }
+
+  uint32_t index = 0;
+  std::size_t pos = 0;
+  while (pos <= filter.size()) {
+    const std::string_view level = NextLevel(filter, &pos);
+    if (level == "#") {
+      nodes_[index].hash_actions.push_back(action);
+      ++filters_;
+      return true;
+    }
+
+    uint32_t next = kNoNode;
+    if (level == "+") {
+      next = nodes_[index].plus_child;
+    } else {
+      const auto child = nodes_[index].children.find(level);
+      if (child != nodes_[index].children.end()) {
+        next = child->second;
+      }
+    }
+    if (next == kNoNode) {
+      // Appending may move nodes_, so take the index before linking it.
+      next = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+      if (level == "+") {
+        nodes_[index].plus_child = next;
+      } else {
+        nodes_[index].children.emplace(std::string(level), next);
+      }
+    }
+    index = next;
+  }
+
+  nodes_[index].actions.push_back(action);
+  ++filters_;
+  return true;
+}
+
+void TopicMatcher::Clear() {
+  nodes_.assign(1, Node{});
+  filters_ = 0;
+}
+
+bool TopicMatcher::Matches(std::string_view topic) const {
+  bool matched = false;
+  ForEachMatch(topic, [&matched](std::size_t) { matched = true; });
+  return matched;
+}
+
+}  // namespace vc::mqtt
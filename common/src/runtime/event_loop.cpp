@@ -0,0 +1,373 @@
+#include "vc/runtime/event_loop.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#else
+#include <poll.h>
+#endif
+
+namespace vc::runtime {
+namespace {
+
+void SetError(std::string* error, const std::string& message) {
+  if (error != nullptr) {
+    *error = message + ": " + std::strerror(errno);
+  }
+}
+
+#ifdef __linux__
+constexpr int kMaxEventsPerWait = 16;
+// epoll user data: timers carry this bit and their id, descriptors carry
+// their watch generation and fd number.
+constexpr uint64_t kTimerTag = 1ull << 63;
+
+uint64_t FdTag(int fd, uint32_t generation) {
+  return (static_cast<uint64_t>(generation & 0x7FFFFFFFu) << 32) |
+         static_cast<uint32_t>(fd);
+}
+
+uint32_t ToEpoll(uint32_t events) {
+  uint32_t out = 0;
+  if ((events & EventLoop::kReadable) != 0) {
+    out |= EPOLLIN;
+  }
+  if ((events & EventLoop::kWritable) != 0) {
+    out |= EPOLLOUT;
+  }
+  return out;
+}
+
+uint32_t FromEpoll(uint32_t events) {
+  uint32_t out = 0;
+  if ((events & EPOLLIN) != 0) {
+    out |= EventLoop::kReadable;
+  }
+  if ((events & EPOLLOUT) != 0) {
+    out |= EventLoop::kWritable;
+  }
+  if ((events & (EPOLLERR | EPOLLHUP)) != 0) {
+    out |= EventLoop::kError;
+  }
+  return out;
+}
+
+timespec ToTimespec(std::chrono::milliseconds value) {
+  timespec spec{};
+  spec.tv_sec = static_cast<time_t>(value.count() / 1000);
+  spec.tv_nsec = static_cast<long>((value.count() % 1000) * 1000000);
+  return spec;
+}
+#endif
+
+}  // namespace
+
+EventLoop::EventLoop() = default;
+
+EventLoop::~EventLoop() {
+  for (const Timer& timer : timers_) {
+    if (timer.fd >= 0) {
+      close(timer.fd);
+    }
+  }
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+  }
+}
+
+#ifdef __linux__
+
+bool EventLoop::Open(std::string* error) {
+  if (epoll_fd_ >= 0) {
+    return true;
+  }
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    SetError(error, "epoll_create1 failed");
+    return false;
+  }
+  return true;
+}
+
+bool EventLoop::Watch(int fd, uint32_t events, FdCallback callback,
+                      std::string* error) {
+  const bool existing = watches_.count(fd) > 0;
+  const uint32_t generation = next_generation_++;
+
+  epoll_event event{};
+  event.events = ToEpoll(events);
+  event.data.u64 = FdTag(fd, generation);
+  int rc = epoll_ctl(epoll_fd_, existing ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd,
+                     &event);
+  // The kernel drops closed descriptors from the set on its own, and a new
+  // descriptor may reuse the number of one that was never unwatched.
+  if (rc < 0 && existing && errno == ENOENT) {
+    rc = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+  } else if (rc < 0 && !existing && errno == EEXIST) {
+    rc = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+  }
+  if (rc < 0) {
+    SetError(error, "epoll_ctl(fd=" + std::to_string(fd) + ") failed");
+    return false;
+  }
+
+  watches_[fd] = FdWatch{events, generation, std::move(callback)};
+  return true;
+}
+
+bool EventLoop::SetEvents(int fd, uint32_t events, std::string* error) {
+  const auto it = watches_.find(fd);
+  if (it == watches_.end()) {
+    errno = ENOENT;
+    SetError(error, "fd " + std::to_string(fd) + " is not watched");
+    return false;
+  }
+  if (it->second.events == events) {
+    return true;
+  }
+  epoll_event event{};
+  event.events = ToEpoll(events);
+  event.data.u64 = FdTag(fd, it->second.generation);
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) < 0) {
+    SetError(error, "epoll_ctl(fd=" + std::to_string(fd) + ") failed");
+    return false;
+  }
+  it->second.events = events;
+  return true;
+}
+
+void EventLoop::Unwatch(int fd) {
+  if (watches_.erase(fd) == 0) {
+    return;
+  }
+  // Fails harmlessly if the descriptor was already closed.
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+EventLoop::TimerId EventLoop::AddTimer(TimerCallback callback,
+                                       std::string* error) {
+  const int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (fd < 0) {
+    SetError(error, "timerfd_create failed");
+    return -1;
+  }
+  const auto id = static_cast<TimerId>(timers_.size());
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = kTimerTag | static_cast<uint32_t>(id);
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+    SetError(error, "epoll_ctl(timerfd) failed");
+    close(fd);
+    return -1;
+  }
+
+  Timer timer;
+  timer.fd = fd;
+  timer.callback = std::move(callback);
+  timers_.push_back(std::move(timer));
+  return id;
+}
+
+bool EventLoop::ArmTimer(TimerId id, std::chrono::milliseconds first,
+                         std::chrono::milliseconds interval,
+                         std::string* error) {
+  Timer& timer = timers_.at(static_cast<std::size_t>(id));
+  itimerspec spec{};
+  // A zero it_value would disarm the timer; fire on the next wait instead.
+  spec.it_value = first.count() > 0 ? ToTimespec(first) : timespec{0, 1};
+  spec.it_interval = ToTimespec(interval);
+  if (timerfd_settime(timer.fd, 0, &spec, nullptr) < 0) {
+    SetError(error, "timerfd_settime failed");
+    return false;
+  }
+  timer.armed = true;
+  timer.interval = interval;
+  return true;
+}
+
+void EventLoop::DisarmTimer(TimerId id) {
+  Timer& timer = timers_.at(static_cast<std::size_t>(id));
+  const itimerspec spec{};
+  timerfd_settime(timer.fd, 0, &spec, nullptr);
+  timer.armed = false;
+}
+
+bool EventLoop::RunOnce(int timeout_ms, std::string* error) {
+  epoll_event events[kMaxEventsPerWait];
+  const int count =
+      epoll_wait(epoll_fd_, events, kMaxEventsPerWait, timeout_ms);
+  ++wakeups_;
+  if (count < 0) {
+    if (errno == EINTR) {
+      return true;
+    }
+    SetError(error, "epoll_wait failed");
+    return false;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    const uint64_t tag = events[i].data.u64;
+    if ((tag & kTimerTag) == 0) {
+      DispatchFd(static_cast<int>(tag & 0xFFFFFFFFu),
+                 static_cast<uint32_t>(tag >> 32),
+                 FromEpoll(events[i].events));
+      continue;
+    }
+
+    const auto id = static_cast<TimerId>(tag & 0xFFFFFFFFu);
+    uint64_t expirations = 0;
+    // Nothing to read if an earlier callback re-armed or disarmed it.
+    if (read(timers_[static_cast<std::size_t>(id)].fd, &expirations,
+             sizeof(expirations)) != sizeof(expirations)) {
+      continue;
+    }
+    if (timers_[static_cast<std::size_t>(id)].interval.count() == 0) {
+      timers_[static_cast<std::size_t>(id)].armed = false;
+    }
+    FireTimer(id);
+  }
+  return true;
+}
+
+#else
+
+bool EventLoop::Open(std::string*) { return true; }
+
+bool EventLoop::Watch(int fd, uint32_t events, FdCallback callback,
+                      std::string*) {
+  watches_[fd] = FdWatch{events, next_generation_++, std::move(callback)};
+  return true;
+}
+
+bool EventLoop::SetEvents(int fd, uint32_t events, std::string* error) {
+  const auto it = watches_.find(fd);
+  if (it == watches_.end()) {
+    errno = ENOENT;
+    SetError(error, "fd " + std::to_string(fd) + " is not watched");
+    return false;
+  }
+  it->second.events = events;
+  return true;
+}
+
+void EventLoop::Unwatch(int fd) { watches_.erase(fd); }
+
+EventLoop::TimerId EventLoop::AddTimer(TimerCallback callback, std::string*) {
+  Timer timer;
+  timer.callback = std::move(callback);
+  timers_.push_back(std::move(timer));
+  return static_cast<TimerId>(timers_.size() - 1);
+}
+
+bool EventLoop::ArmTimer(TimerId id, std::chrono::milliseconds first,
+                         std::chrono::milliseconds interval, std::string*) {
+  Timer& timer = timers_.at(static_cast<std::size_t>(id));
+  timer.armed = true;
+  timer.deadline = std::chrono::steady_clock::now() + first;
+  timer.interval = interval;
+  return true;
+}
+
+void EventLoop::DisarmTimer(TimerId id) {
+  timers_.at(static_cast<std::size_t>(id)).armed = false;
+}
+
+bool EventLoop::RunOnce(int timeout_ms, std::string* error) {
+  std::vector<pollfd> fds;
+  std::vector<uint32_t> generations;
+  fds.reserve(watches_.size());
+  generations.reserve(watches_.size());
+  for (const auto& [fd, watch] : watches_) {
+    pollfd entry{};
+    entry.fd = fd;
+    entry.events = static_cast<short>(
+        ((watch.events & kReadable) != 0 ? POLLIN : 0) |
+        ((watch.events & kWritable) != 0 ? POLLOUT : 0));
+    fds.push_back(entry);
+    generations.push_back(watch.generation);
+  }
+
+  int wait_ms = timeout_ms;
+  const auto now = std::chrono::steady_clock::now();
+  for (const Timer& timer : timers_) {
+    if (!timer.armed) {
+      continue;
+    }
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+        timer.deadline - now);
+    const int remaining_ms =
+        static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+    wait_ms = wait_ms < 0 ? remaining_ms : std::min(wait_ms, remaining_ms);
+  }
+
+  const int count = poll(fds.data(), static_cast<nfds_t>(fds.size()), wait_ms);
+  ++wakeups_;
+  if (count < 0) {
+    if (errno == EINTR) {
+      return true;
+    }
+    SetError(error, "poll failed");
+    return false;
+  }
+
+  for (std::size_t i = 0; i < fds.size() && count > 0; ++i) {
+    uint32_t events = 0;
+    if ((fds[i].revents & POLLIN) != 0) {
+      events |= kReadable;
+    }
+    if ((fds[i].revents & POLLOUT) != 0) {
+      events |= kWritable;
+    }
+    if ((fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+      events |= kError;
+    }
+    if (events != 0) {
+      DispatchFd(fds[i].fd, generations[i], events);
+    }
+  }
+
+  const auto fired_at = std::chrono::steady_clock::now();
+  for (std::size_t id = 0; id < timers_.size(); ++id) {
+    Timer& timer = timers_[id];
+    if (!timer.armed || timer.deadline > fired_at) {
+      continue;
+    }
+    if (timer.interval.count() > 0) {
+      while (timer.deadline <= fired_at) {
+        timer.deadline += timer.interval;
+      }
+    } else {
+      timer.armed = false;
+    }
+    FireTimer(static_cast<TimerId>(id));
+  }
+  return true;
+}
+
+#endif
+
+void EventLoop::DispatchFd(int fd, uint32_t generation, uint32_t events) {
+  const auto it = watches_.find(fd);
+  if (it == watches_.end() ||
+      (it->second.generation & 0x7FFFFFFFu) != (generation & 0x7FFFFFFFu)) {
+    return;
+  }
+  // Copied so the callback may unwatch its own descriptor.
+  const FdCallback callback = it->second.callback;
+  callback(events);
+}
+
+void EventLoop::FireTimer(TimerId id) {
+  const TimerCallback callback =
+      timers_[static_cast<std::size_t>(id)].callback;
+  callback();
+}
+
+}  // namespace vc::runtime
@@ -1,12 +1,32 @@
 #include "vc/runtime/signal_handler.h"
 
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace vc::runtime {
 namespace {
 volatile std::sig_atomic_t g_should_stop = 0;
 volatile std::sig_atomic_t g_last_signal = 0;
+// Self-pipe written from the handler; both ends are non-blocking.
+int g_wake_read_fd = -1;
+int g_wake_write_fd = -1;
+
+void SetNonBlockingCloexec(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
 }  // namespace
 
 void SignalHandler::Install() {
+  int fds[2];
+  if (g_wake_read_fd < 0 && pipe(fds) == 0) {
+    SetNonBlockingCloexec(fds[0]);
+    SetNonBlockingCloexec(fds[1]);
+    g_wake_read_fd = fds[0];
+    g_wake_write_fd = fds[1];
+  }
   std::signal(SIGINT, SignalHandler::Handle);
   std::signal(SIGTERM, SignalHandler::Handle);
 }
@@ -15,6 +35,14 @@ bool SignalHandler::ShouldStop() const { return g_should_stop != 0; }
 
 int SignalHandler::LastSignal() const { return g_last_signal; }
 
+int SignalHandler::WakeFd() const { return g_wake_read_fd; }
+
+void SignalHandler::DrainWakeFd() const {
+  char buffer[16];
+  while (g_wake_read_fd >= 0 && read(g_wake_read_fd, buffer, sizeof(buffer)) > 0) {
+  }
+}
+
 std::string SignalHandler::SignalName(int signal) {
   switch (signal) {
     case SIGINT:
@@ -29,6 +57,12 @@ std::string SignalHandler::SignalName(int signal) {
 void SignalHandler::Handle(int signal) {
   g_last_signal = signal;
   g_should_stop = 1;
+  if (g_wake_write_fd >= 0) {
+    const int saved_errno = errno;
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = write(g_wake_write_fd, &byte, 1);
+    errno = saved_errno;
+  }
 }
 
 }  // namespace vc::runtime
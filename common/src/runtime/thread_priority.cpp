@@ -0,0 +1,41 @@
+#include "vc/runtime/thread_priority.h"
+
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace vc::runtime {
+
+bool SetRealtimePriority(std::thread& thread, int priority, std::string* error) {
+#ifdef __linux__
+  const int min_priority = sched_get_priority_min(SCHED_FIFO);
+  const int max_priority = sched_get_priority_max(SCHED_FIFO);
+  if (priority < min_priority || priority > max_priority) {
+    *error = "priority " + std::to_string(priority) + " outside " +
+             std::to_string(min_priority) + "-" + std::to_string(max_priority);
+    return false;
+  }
+
+  sched_param param{};
+  param.sched_priority = priority;
+  // Children forked from the thread start under SCHED_OTHER instead of
+  // inheriting real-time priority.
+  const int rc = pthread_setschedparam(thread.native_handle(),
+                                       SCHED_FIFO | SCHED_RESET_ON_FORK, &param);
+  if (rc != 0) {
+    *error = std::strerror(rc);
+    return false;
+  }
+  return true;
+#else
+  (void)thread;
+  (void)priority;
+  *error = "real-time scheduling not supported on this platform";
+  return false;
+#endif
+}
+
+}  // namespace vc::runtime
@@ -1,6 +1,8 @@
 #include "vc/util/filesystem.h"
 
+#include <filesystem>
 #include <fstream>
+#include <system_error>
 
 #include "vc/config/kv_config.h"
 
@@ -21,4 +23,39 @@ std::string ReadTrimmedFile(const std::string& path) {
   return vc::config::trim(line);
 }
 
+bool WriteFileAtomic(const std::string& path, const std::string& contents,
+                     std::string* error) {
+  const std::filesystem::path target(path);
+  std::error_code ec;
+  if (target.has_parent_path()) {
+    std::filesystem::create_directories(target.parent_path(), ec);
+    if (ec) {
+      *error = "create directories failed: " + ec.message();
+      return false;
+    }
+  }
+
+  const std::filesystem::path temp_path = path + ".tmp";
+  std::ofstream out(temp_path, std::ios::trunc | std::ios::binary);
+  if (!out.is_open()) {
+    *error = "failed to open " + temp_path.string();
+    return false;
+  }
+  out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  out.flush();
+  if (!out.good()) {
+    *error = "failed writing " + temp_path.string();
+    return false;
+  }
+  out.close();
+
+  std::filesystem::rename(temp_path, target, ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+    *error = "rename " + temp_path.string() + " failed: " + ec.message();
+    return false;
+  }
+  return true;
+}
+
 }  // namespace vc::util
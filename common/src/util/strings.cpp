@@ -34,20 +34,29 @@ std::string EscapeShellDoubleQuotes(const std::string& value) {
 std::string SanitizePayloadForLog(std::string_view payload) {
   std::string clean;
   clean.reserve(payload.size());
-  for (const unsigned char c : payload) {
+  AppendPayloadForLog(payload, payload.size(), &clean);
+  return clean;
+}
+
+void AppendPayloadForLog(std::string_view payload, std::size_t max_bytes,
+                         std::string* out) {
+  const std::string_view shown = payload.substr(0, max_bytes);
+  for (const unsigned char c : shown) {
     if (c == '\n') {
-      clean.append("\\n");
+      out->append("\\n");
     } else if (c == '\r') {
-      clean.append("\\r");
+      out->append("\\r");
     } else if (c == '\t') {
-      clean.append("\\t");
+      out->append("\\t");
     } else if (std::isprint(c) != 0) {
-      clean.push_back(static_cast<char>(c));
+      out->push_back(static_cast<char>(c));
     } else {
-      clean.push_back('?');
+      out->push_back('?');
     }
   }
-  return clean;
+  if (shown.size() < payload.size()) {
+    out->append("...");
+  }
 }
 
 }  // namespace vc::util
@@ -0,0 +1,94 @@
+#include "vc/util/write_behind_file.h"
+
+#include <utility>
+
+#include "vc/logging/logger.h"
+#include "vc/util/filesystem.h"
+
+namespace vc::util {
+
+WriteBehindFile::WriteBehindFile(vc::logging::Logger& logger, std::string path,
+                                 std::chrono::milliseconds delay)
+    : logger_(logger), path_(std::move(path)), delay_(delay) {
+  worker_ = std::thread([this]() { Run(); });
+}
+
+WriteBehindFile::~WriteBehindFile() { Stop(); }
+
+void WriteBehindFile::Update(std::string contents) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.has_value()) {
+      ++coalesced_;
+    } else {
+      due_ = std::chrono::steady_clock::now() + delay_;
+    }
+    pending_ = std::move(contents);
+  }
+  wake_.notify_one();
+}
+
+void WriteBehindFile::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+
+  // Updates that raced with shutdown are written here, on the caller.
+  std::optional<std::string> contents;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    contents.swap(pending_);
+  }
+  if (contents.has_value()) {
+    Write(*contents);
+  }
+}
+
+unsigned long long WriteBehindFile::writes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return writes_;
+}
+
+unsigned long long WriteBehindFile::coalesced() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return coalesced_;
+}
+
+void WriteBehindFile::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this]() { return stopping_ || pending_.has_value(); });
+    if (!stopping_) {
+      wake_.wait_until(lock, due_, [this]() { return stopping_; });
+    }
+    if (!pending_.has_value()) {
+      return;
+    }
+
+    std::string contents = std::move(*pending_);
+    pending_.reset();
+    lock.unlock();
+    Write(contents);
+    lock.lock();
+    if (stopping_ && !pending_.has_value()) {
+      return;
+    }
+  }
+}
+
+void WriteBehindFile::Write(const std::string& contents) {
+  std::string error;
+  if (!WriteFileAtomic(path_, contents, &error)) {
+    logger_.Warn("storage", "write " + path_ + " failed: " + error);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++writes_;
+}
+
+}  // namespace vc::util
@@ -0,0 +1,101 @@
+// Exercises LruMap's recency order: Touch and Emplace move an entry to the
+// front, Find does not, and a full map evicts from the back.
+
+#include <string>
+#include <vector>
+
+#include "test_check.h"
+#include "vc/util/lru_map.h"
+
+namespace {
+
+template <typename Value>
+std::vector<std::string> Keys(const vc::util::LruMap<Value>& map) {
+  std::vector<std::string> keys;
+  for (const auto& entry : map) {
+    keys.push_back(entry.key);
+  }
+  return keys;
+}
+
+using Strings = std::vector<std::string>;
+
+void CheckRecency() {
+  vc::util::LruMap<int> map(3);
+  VC_CHECK(map.empty() && map.capacity() == 3);
+  VC_CHECK(map.Emplace("a", 1).second);
+  VC_CHECK(map.Emplace("b", 2).second);
+  VC_CHECK(map.Emplace("c", 3).second);
+  VC_CHECK(Keys(map) == Strings({"c", "b", "a"}));
+
+  // Find leaves the order alone; Touch moves to the front.
+  VC_CHECK(map.Find("a") != nullptr && *map.Find("a") == 1);
+  VC_CHECK(Keys(map) == Strings({"c", "b", "a"}));
+  VC_CHECK(map.Touch("a") != nullptr);
+  VC_CHECK(Keys(map) == Strings({"a", "c", "b"}));
+  VC_CHECK(map.Find("z") == nullptr && map.Touch("z") == nullptr);
+
+  // An existing key is touched, not overwritten.
+  const auto existing = map.Emplace("b", 20);
+  VC_CHECK(!existing.second && *existing.first == 2);
+  VC_CHECK(Keys(map) == Strings({"b", "a", "c"}));
+  *existing.first = 22;
+  VC_CHECK(*map.Find("b") == 22);
+}
+
+void CheckEviction() {
+  vc::util::LruMap<std::string> map(2);
+  map.Emplace("first", "1");
+  map.Emplace("second", "2");
+  map.Touch("first");
+  // "second" is least recently used; its node is reused for "third".
+  const auto inserted = map.Emplace("third", "3");
+  VC_CHECK(inserted.second && *inserted.first == "3");
+  VC_CHECK(map.size() == 2);
+  VC_CHECK(map.Find("second") == nullptr);
+  VC_CHECK(Keys(map) == Strings({"third", "first"}));
+
+  // Keys stay findable after their node was reused for a longer key.
+  const std::string long_key(100, 'k');
+  map.Emplace(long_key, "long");
+  VC_CHECK(map.Find(long_key) != nullptr && *map.Find(long_key) == "long");
+  VC_CHECK(map.Find("first") == nullptr);
+  VC_CHECK(map.Find("third") != nullptr);
+
+  for (int i = 0; i < 1000; ++i) {
+    map.Emplace("key" + std::to_string(i), std::to_string(i));
+  }
+  VC_CHECK(map.size() == 2);
+  VC_CHECK(Keys(map) == Strings({"key999", "key998"}));
+  VC_CHECK(*map.Find("key998") == "998");
+}
+
+void CheckEraseAndClear() {
+  vc::util::LruMap<int> map(4);
+  map.Emplace("a", 1);
+  map.Emplace("b", 2);
+  VC_CHECK(map.Erase("a"));
+  VC_CHECK(!map.Erase("a"));
+  VC_CHECK(map.size() == 1 && map.Find("a") == nullptr);
+  map.Clear();
+  VC_CHECK(map.empty());
+  VC_CHECK(map.Emplace("a", 3).second);
+  VC_CHECK(*map.Find("a") == 3);
+}
+
+void CheckZeroCapacity() {
+  vc::util::LruMap<int> map(0);
+  const auto inserted = map.Emplace("a", 1);
+  VC_CHECK(!inserted.second && inserted.first == nullptr);
+  VC_CHECK(map.empty());
+}
+
+}  // namespace
+
+int main() {
+  CheckRecency();
+  CheckEviction();
+  CheckEraseAndClear();
+  CheckZeroCapacity();
+  return vc::test::ExitCode();
+}
@@ -0,0 +1,341 @@
+// Publishes a Registry into a stats segment and reads it back, including
+// while another thread keeps publishing (the seqlock must never hand out a
+// torn copy), and checks FormatPrometheus output for a fixed segment.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "test_check.h"
+#include "vc/metrics/metrics.h"
+#include "vc/metrics/prometheus.h"
+#include "vc/metrics/stats_segment.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+using vc::metrics::StatsSegment;
+using vc::metrics::StatsSeries;
+
+// StatsSegment is too large for the stack of a test thread.
+std::unique_ptr<StatsSegment> NewSegment() {
+  return std::make_unique<StatsSegment>();
+}
+
+const StatsSeries* FindSeries(const StatsSegment& segment,
+                              const std::string& name,
+                              const std::string& label_value = "") {
+  for (uint32_t i = 0; i < segment.series_count; ++i) {
+    const StatsSeries& series = segment.series[i];
+    if (name == series.name && label_value == series.label_value) {
+      return &series;
+    }
+  }
+  return nullptr;
+}
+
+void CheckRoundTrip(const std::string& path) {
+  vc::metrics::Registry registry;
+  registry.AddCounter("rings", "rings played").Add(3);
+  registry.AddGauge("queue_depth", "queued sounds").Set(-2);
+  vc::metrics::Histogram& latency =
+      registry.AddHistogram("latency_ms", "ring latency", {10, 100});
+  latency.Observe(5);
+  latency.Observe(50);
+  latency.Observe(500);
+  vc::metrics::CounterFamily& topics = registry.AddCounterFamily(
+      "messages", "messages per topic", "topic", 1);
+  topics.Get("doorbell/front").Add(4);
+  topics.Get("doorbell/back").Add(1);
+  registry.AddCounter(std::string(100, 'n'), "long name");
+
+  vc::metrics::StatsSegmentWriter writer;
+  std::string error;
+  VC_CHECK_CTX(writer.Open(path, &error), error);
+  writer.Publish(registry);
+
+  const auto segment = NewSegment();
+  VC_CHECK_CTX(vc::metrics::ReadStatsSegment(path, segment.get(), &error),
+               error);
+  VC_CHECK(segment->series_count == 6);
+  VC_CHECK(segment->sequence.load() == 2);
+  VC_CHECK(segment->updated_at > 0);
+
+  const StatsSeries* rings = FindSeries(*segment, "rings");
+  VC_CHECK(rings != nullptr && rings->type == StatsSeries::Type::kCounter &&
+           rings->value == 3 && std::string(rings->help) == "rings played");
+  const StatsSeries* depth = FindSeries(*segment, "queue_depth");
+  VC_CHECK(depth != nullptr && depth->type == StatsSeries::Type::kGauge &&
+           depth->value == -2);
+
+  const StatsSeries* histogram = FindSeries(*segment, "latency_ms");
+  VC_CHECK(histogram != nullptr && histogram->bound_count == 2);
+  if (histogram != nullptr) {
+    VC_CHECK(histogram->bounds[0] == 10 && histogram->bounds[1] == 100);
+    VC_CHECK(histogram->buckets[0] == 1 && histogram->buckets[1] == 1 &&
+             histogram->buckets[2] == 1);
+    VC_CHECK(histogram->count == 3 && histogram->sum == 555);
+  }
+
+  // One series per label value; past max_series they share "other".
+  const StatsSeries* front = FindSeries(*segment, "messages", "doorbell/front");
+  VC_CHECK(front != nullptr && front->value == 4 &&
+           std::string(front->label_name) == "topic");
+  const StatsSeries* other = FindSeries(*segment, "messages", "other");
+  VC_CHECK(other != nullptr && other->value == 1);
+
+  const std::string truncated(StatsSeries::kNameSize - 1, 'n');
+  VC_CHECK(FindSeries(*segment, truncated) != nullptr);
+}
+
+// Topics longer than the label field must not be cut: two sharing their
+// first kLabelValueSize - 1 bytes would become duplicate series. They are
+// counted under "other", merged with the family's own overflow series.
+void CheckLongLabelValues(const std::string& path) {
+  const std::string prefix =
+      "zigbee2mqtt/" + std::string(StatsSeries::kLabelValueSize, 'x');
+  // Longest value that fits, ending in a two-byte UTF-8 sequence.
+  const std::string fits =
+      std::string(StatsSeries::kLabelValueSize - 3, 'y') + "\xc3\xa9";
+
+  vc::metrics::Registry registry;
+  vc::metrics::CounterFamily& merged = registry.AddCounterFamily(
+      "messages", "messages per topic", "topic", 4);
+  merged.Get(prefix + "/front").Add(2);
+  merged.Get(prefix + "/back").Add(3);
+  merged.Get(fits).Add(1);
+  merged.Get("short").Add(7);
+  merged.Get("overflowed").Add(4);
+  vc::metrics::CounterFamily& only_long = registry.AddCounterFamily(
+      "bytes", "bytes per topic", "topic", 4);
+  only_long.Get(prefix + "/front").Add(10);
+  only_long.Get(prefix + "/back").Add(20);
+
+  vc::metrics::StatsSegmentWriter writer;
+  std::string error;
+  VC_CHECK_CTX(writer.Open(path, &error), error);
+  writer.Publish(registry);
+  const auto segment = NewSegment();
+  VC_CHECK_CTX(vc::metrics::ReadStatsSegment(path, segment.get(), &error),
+               error);
+
+  VC_CHECK(segment->series_count == 4);
+  const StatsSeries* kept = FindSeries(*segment, "messages", fits);
+  VC_CHECK(kept != nullptr && kept->value == 1);
+  const StatsSeries* other = FindSeries(*segment, "messages", "other");
+  VC_CHECK(other != nullptr && other->value == 9);
+  VC_CHECK(FindSeries(*segment, "messages", "short") != nullptr);
+  const StatsSeries* bytes = FindSeries(*segment, "bytes", "other");
+  VC_CHECK(bytes != nullptr && bytes->value == 30);
+
+  const std::string text = vc::metrics::FormatPrometheus(*segment, "vc_");
+  VC_CHECK(text.find("zigbee2mqtt") == std::string::npos);
+  VC_CHECK(text.find("vc_messages_total{topic=\"other\"} 9\n") !=
+           std::string::npos);
+  VC_CHECK(text.find("vc_bytes_total{topic=\"other\"} 30\n") !=
+           std::string::npos);
+}
+
+// A reader copying while the writer publishes must either get a consistent
+// snapshot or retry; every published state has the counter equal to the
+// gauge, so a torn copy shows up as a mismatch.
+void CheckConcurrentReads(const std::string& path) {
+  vc::metrics::Registry registry;
+  vc::metrics::Counter& counter = registry.AddCounter("updates", "updates");
+  vc::metrics::Gauge& gauge = registry.AddGauge("mirror", "same as updates");
+  for (int i = 0; i < 150; ++i) {
+    registry.AddCounter("padding_" + std::to_string(i), "widens the copy");
+  }
+
+  vc::metrics::StatsSegmentWriter writer;
+  std::string error;
+  VC_CHECK_CTX(writer.Open(path, &error), error);
+  writer.Publish(registry);
+
+  std::atomic<bool> stop{false};
+  std::thread publisher([&]() {
+    while (!stop.load()) {
+      counter.Add();
+      gauge.Set(static_cast<int64_t>(counter.value()));
+      writer.Publish(registry);
+    }
+  });
+
+  const auto segment = NewSegment();
+  int reads = 0;
+  int torn = 0;
+  int64_t last = -1;
+  bool monotonic = true;
+  const auto deadline = std::chrono::steady_clock::now() + 500ms;
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (!vc::metrics::ReadStatsSegment(path, segment.get(), &error)) {
+      continue;
+    }
+    ++reads;
+    const StatsSeries* updates = FindSeries(*segment, "updates");
+    const StatsSeries* mirror = FindSeries(*segment, "mirror");
+    if (updates == nullptr || mirror == nullptr ||
+        updates->value != mirror->value) {
+      ++torn;
+      continue;
+    }
+    monotonic = monotonic && updates->value >= last;
+    last = updates->value;
+  }
+  stop = true;
+  publisher.join();
+
+  VC_CHECK(reads > 0);
+  VC_CHECK_CTX(torn == 0, std::to_string(torn) + " of " +
+                              std::to_string(reads) + " reads torn");
+  VC_CHECK(monotonic);
+}
+
+// A writer that died mid-update leaves the sequence odd; the next one makes
+// it even again without moving it backwards.
+void CheckReopen(const std::string& path) {
+  {
+    const int fd = open(path.c_str(), O_RDWR);
+    void* mapping = mmap(nullptr, sizeof(StatsSegment), PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    close(fd);
+    VC_CHECK(mapping != MAP_FAILED);
+    if (mapping == MAP_FAILED) {
+      return;
+    }
+    static_cast<StatsSegment*>(mapping)->sequence.store(1001);
+    munmap(mapping, sizeof(StatsSegment));
+  }
+
+  std::string error;
+  const auto segment = NewSegment();
+  VC_CHECK(!vc::metrics::ReadStatsSegment(path, segment.get(), &error));
+
+  vc::metrics::StatsSegmentWriter writer;
+  VC_CHECK_CTX(writer.Open(path, &error), error);
+  VC_CHECK_CTX(vc::metrics::ReadStatsSegment(path, segment.get(), &error),
+               error);
+  VC_CHECK(segment->sequence.load() == 1002);
+}
+
+void CheckReadErrors(const std::filesystem::path& dir) {
+  const auto segment = NewSegment();
+  std::string error;
+  VC_CHECK(!vc::metrics::ReadStatsSegment((dir / "missing").string(),
+                                          segment.get(), &error));
+  VC_CHECK(!error.empty());
+
+  const std::filesystem::path small = dir / "small";
+  std::ofstream(small) << "not a segment";
+  error.clear();
+  VC_CHECK(!vc::metrics::ReadStatsSegment(small.string(), segment.get(),
+                                          &error));
+  VC_CHECK(!error.empty());
+
+  const std::filesystem::path zeros = dir / "zeros";
+  { std::ofstream create(zeros); }
+  std::filesystem::resize_file(zeros, sizeof(StatsSegment));
+  error.clear();
+  VC_CHECK(!vc::metrics::ReadStatsSegment(zeros.string(), segment.get(),
+                                          &error));
+  VC_CHECK(error.find("layout") != std::string::npos);
+}
+
+template <std::size_t N>
+void SetField(char (&field)[N], const char* value) {
+  std::strncpy(field, value, N - 1);
+}
+
+StatsSeries& AddSeries(StatsSegment* segment, const char* name,
+                       const char* help, StatsSeries::Type type) {
+  StatsSeries& series = segment->series[segment->series_count++];
+  SetField(series.name, name);
+  SetField(series.help, help);
+  series.type = type;
+  return series;
+}
+
+void CheckPrometheus() {
+  const auto segment = NewSegment();
+  segment->updated_at = 1700000000;
+  AddSeries(segment.get(), "rings", "rings \\ played\nhere",
+            StatsSeries::Type::kCounter)
+      .value = 5;
+  for (const auto& [label, value] :
+       {std::pair{"a\"b\\c", 3}, std::pair{"d", 4}}) {
+    StatsSeries& series = AddSeries(segment.get(), "messages", "per topic",
+                                    StatsSeries::Type::kCounter);
+    SetField(series.label_name, "topic");
+    SetField(series.label_value, label);
+    series.value = value;
+  }
+  AddSeries(segment.get(), "queue", "depth", StatsSeries::Type::kGauge).value =
+      -2;
+  StatsSeries& latency = AddSeries(segment.get(), "latency_ms", "latency",
+                                   StatsSeries::Type::kHistogram);
+  latency.bound_count = 2;
+  latency.bounds[0] = 10;
+  latency.bounds[1] = 100;
+  latency.buckets[0] = 1;
+  latency.buckets[1] = 2;
+  latency.buckets[2] = 3;
+  latency.sum = 500;
+  // Stale relative to the buckets; _count follows the buckets.
+  latency.count = 7;
+
+  const std::string expected =
+      "# HELP vc_rings_total rings \\\\ played\\nhere\n"
+      "# TYPE vc_rings_total counter\n"
+      "vc_rings_total 5\n"
+      "# HELP vc_messages_total per topic\n"
+      "# TYPE vc_messages_total counter\n"
+      "vc_messages_total{topic=\"a\\\"b\\\\c\"} 3\n"
+      "vc_messages_total{topic=\"d\"} 4\n"
+      "# HELP vc_queue depth\n"
+      "# TYPE vc_queue gauge\n"
+      "vc_queue -2\n"
+      "# HELP vc_latency_ms latency\n"
+      "# TYPE vc_latency_ms histogram\n"
+      "vc_latency_ms_bucket{le=\"10\"} 1\n"
+      "vc_latency_ms_bucket{le=\"100\"} 3\n"
+      "vc_latency_ms_bucket{le=\"+Inf\"} 6\n"
+      "vc_latency_ms_sum 500\n"
+      "vc_latency_ms_count 6\n"
+      "# HELP vc_stats_updated_timestamp_seconds unix time the stats segment "
+      "was last updated\n"
+      "# TYPE vc_stats_updated_timestamp_seconds gauge\n"
+      "vc_stats_updated_timestamp_seconds 1700000000\n";
+  const std::string actual = vc::metrics::FormatPrometheus(*segment, "vc_");
+  VC_CHECK_CTX(actual == expected, "\n" + actual);
+}
+
+}  // namespace
+
+int main() {
+  const std::filesystem::path dir =
+      std::filesystem::temp_directory_path() /
+      ("vc_stats_segment_test." + std::to_string(getpid()));
+  std::filesystem::create_directories(dir);
+  const std::string path = (dir / "stats").string();
+
+  CheckRoundTrip(path);
+  CheckLongLabelValues(path);
+  CheckConcurrentReads(path);
+  CheckReopen(path);
+  CheckReadErrors(dir);
+  CheckPrometheus();
+
+  std::filesystem::remove_all(dir);
+  return vc::test::ExitCode();
+}
@@ -0,0 +1,45 @@
+#ifndef VC_TEST_CHECK_H
+#define VC_TEST_CHECK_H
+
+#include <iostream>
+#include <string_view>
+
+// Minimal checks for the ctest executables: a failed check prints its
+// location and the test keeps going, so one run reports every mismatch.
+// main() returns vc::test::ExitCode().
+
+namespace vc::test {
+
+inline int& FailureCount() {
+  static int failures = 0;
+  return failures;
+}
+
+inline bool Check(bool passed, std::string_view expression,
+                  std::string_view context, const char* file, int line) {
+  if (!passed) {
+    ++FailureCount();
+    std::cerr << file << ":" << line << ": check failed: " << expression;
+    if (!context.empty()) {
+      std::cerr << " [" << context << "]";
+    }
+    std::cerr << "\n";
+  }
+  return passed;
+}
+
+inline int ExitCode() {
+  if (FailureCount() != 0) {
+    std::cerr << FailureCount() << " check(s) failed\n";
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace vc::test
+
+#define VC_CHECK(expr) ::vc::test::Check((expr), #expr, {}, __FILE__, __LINE__)
+#define VC_CHECK_CTX(expr, context) \
+  ::vc::test::Check((expr), #expr, (context), __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,144 @@
+// Holds TopicMatcher against the level-by-level filter match ChimeService
+// used before the trie: every filter/topic pair below must give the same
+// answer both ways, and ForEachMatch must report each matching action once.
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test_check.h"
+#include "vc/mqtt/topic_matcher.h"
+
+namespace {
+
+// The matcher the trie replaced, copied from ChimeService as the reference
+// ('+' one level, '#' the rest). Only meaningful for valid filters.
+bool ReferenceMatch(std::string_view filter, std::string_view topic) {
+  std::size_t filter_pos = 0;
+  std::size_t topic_pos = 0;
+  bool topic_done = false;
+  while (true) {
+    const std::size_t filter_end =
+        std::min(filter.find('/', filter_pos), filter.size());
+    const std::string_view filter_level =
+        filter.substr(filter_pos, filter_end - filter_pos);
+    const bool filter_last = filter_end == filter.size();
+    if (filter_level == "#") {
+      return filter_last;
+    }
+    if (topic_done) {
+      return false;
+    }
+
+    const std::size_t topic_end =
+        std::min(topic.find('/', topic_pos), topic.size());
+    const std::string_view topic_level =
+        topic.substr(topic_pos, topic_end - topic_pos);
+    if (filter_level != "+" && filter_level != topic_level) {
+      return false;
+    }
+    const bool topic_last = topic_end == topic.size();
+    if (filter_last) {
+      return topic_last;
+    }
+    topic_done = topic_last;
+    filter_pos = filter_end + 1;
+    topic_pos = topic_end + 1;
+  }
+}
+
+const std::vector<std::string> kFilters = {
+    "a", "a/b", "a/b/c", "+", "+/+", "a/+", "+/b", "a/+/c", "#", "a/#",
+    "a/b/#", "+/#", "+/b/#", "/", "/a", "a/", "a//b", "+/", "/+", "//",
+    "a/+/#", "vc/#", "vc/doorbell/+/ring", "vc/doorbell/front/ring"};
+
+// Includes the empty topic and empty levels at either end and in the middle.
+const std::vector<std::string> kTopics = {
+    "a", "b", "a/b", "a/c", "b/b", "a/b/c", "a/x/c", "a/b/c/d", "a/b/d", "",
+    "/", "/a", "a/", "//", "a//b", "a/b/", "/a/b", "a//", "vc",
+    "vc/doorbell/front/ring", "vc/doorbell/back/ring",
+    "vc/doorbell/front/ring/x", "vc/doorbell//ring"};
+
+std::string Pair(std::string_view filter, std::string_view topic) {
+  return "filter='" + std::string(filter) + "' topic='" + std::string(topic) +
+         "'";
+}
+
+void CheckSingleFilters() {
+  for (const std::string& filter : kFilters) {
+    vc::mqtt::TopicMatcher matcher;
+    std::string error;
+    VC_CHECK_CTX(matcher.Add(filter, 7, &error), filter + ": " + error);
+    for (const std::string& topic : kTopics) {
+      std::size_t visits = 0;
+      matcher.ForEachMatch(topic, [&](std::size_t action) {
+        VC_CHECK_CTX(action == 7, Pair(filter, topic));
+        ++visits;
+      });
+      const bool expected = ReferenceMatch(filter, topic);
+      VC_CHECK_CTX(visits == (expected ? 1u : 0u), Pair(filter, topic));
+      VC_CHECK_CTX(matcher.Matches(topic) == expected, Pair(filter, topic));
+    }
+  }
+}
+
+// All filters in one trie, so shared prefixes and the exact, '+' and '#'
+// branches of one node are walked together.
+void CheckCombined() {
+  vc::mqtt::TopicMatcher matcher;
+  for (std::size_t i = 0; i < kFilters.size(); ++i) {
+    VC_CHECK(matcher.Add(kFilters[i], i, nullptr));
+  }
+  // A filter may map to more than one action.
+  VC_CHECK(matcher.Add("a/b", kFilters.size(), nullptr));
+  VC_CHECK(matcher.size() == kFilters.size() + 1);
+
+  for (const std::string& topic : kTopics) {
+    std::vector<std::size_t> expected;
+    for (std::size_t i = 0; i < kFilters.size(); ++i) {
+      if (ReferenceMatch(kFilters[i], topic)) {
+        expected.push_back(i);
+      }
+    }
+    if (topic == "a/b") {
+      expected.push_back(kFilters.size());
+    }
+    std::vector<std::size_t> actual;
+    matcher.ForEachMatch(topic,
+                         [&](std::size_t action) { actual.push_back(action); });
+    std::sort(actual.begin(), actual.end());
+    VC_CHECK_CTX(actual == expected, "topic='" + topic + "'");
+  }
+
+  matcher.Clear();
+  VC_CHECK(matcher.empty());
+  VC_CHECK(!matcher.Matches("a/b"));
+}
+
+void CheckInvalidFilters() {
+  const std::vector<std::string> invalid = {
+      "", "#/a", "a/#/b", "a#", "a/b#", "+a", "a/+b", "a+/b", "##", "++",
+      "a/#/"};
+  for (const std::string& filter : invalid) {
+    VC_CHECK_CTX(!vc::mqtt::IsValidTopicFilter(filter), filter);
+    vc::mqtt::TopicMatcher matcher;
+    std::string error;
+    VC_CHECK_CTX(!matcher.Add(filter, 0, &error), filter);
+    VC_CHECK_CTX(!error.empty(), filter);
+    VC_CHECK_CTX(matcher.empty(), filter);
+  }
+  for (const std::string& filter : kFilters) {
+    VC_CHECK_CTX(vc::mqtt::IsValidTopicFilter(filter), filter);
+  }
+}
+
+}  // namespace
+
+int main() {
+  CheckSingleFilters();
+  CheckCombined();
+  CheckInvalidFilters();
+  return vc::test::ExitCode();
+}
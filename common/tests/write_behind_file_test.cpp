@@ -0,0 +1,136 @@
+// Checks that WriteBehindFile coalesces a burst of updates into one delayed
+// write, flushes on Stop(), keeps updates that arrive after Stop() for the
+// destructor, and only logs when the file cannot be written.
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <unistd.h>
+
+#include "test_check.h"
+#include "vc/logging/logger.h"
+#include "vc/util/write_behind_file.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+class CountingLogger final : public vc::logging::Logger {
+ public:
+  void Log(vc::logging::Level level, std::string_view,
+           std::string_view) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (level != vc::logging::Level::kInfo) {
+      ++warnings_;
+    }
+  }
+
+  int warnings() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return warnings_;
+  }
+
+ private:
+  std::mutex mutex_;
+  int warnings_ = 0;
+};
+
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+template <typename Predicate>
+bool WaitFor(Predicate done) {
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(5ms);
+  }
+  return true;
+}
+
+void CheckCoalesces(const std::filesystem::path& dir) {
+  CountingLogger logger;
+  const std::filesystem::path path = dir / "burst.txt";
+  vc::util::WriteBehindFile file(logger, path.string(), 300ms);
+  for (int i = 1; i <= 5; ++i) {
+    file.Update("version " + std::to_string(i));
+  }
+  // Nothing is written until the delay from the first update has passed.
+  VC_CHECK(!std::filesystem::exists(path));
+  VC_CHECK(WaitFor([&]() { return file.writes() == 1; }));
+  VC_CHECK(ReadFile(path) == "version 5");
+  VC_CHECK(file.coalesced() == 4);
+
+  // A later update starts a new delay and replaces the file.
+  file.Update("version 6");
+  VC_CHECK(WaitFor([&]() { return file.writes() == 2; }));
+  VC_CHECK(ReadFile(path) == "version 6");
+  VC_CHECK(logger.warnings() == 0);
+}
+
+void CheckStopFlushes(const std::filesystem::path& dir) {
+  CountingLogger logger;
+  const std::filesystem::path path = dir / "stop.txt";
+  {
+    vc::util::WriteBehindFile file(logger, path.string(), 60s);
+    file.Update("pending");
+    const auto start = std::chrono::steady_clock::now();
+    file.Stop();
+    VC_CHECK(std::chrono::steady_clock::now() - start < 5s);
+    VC_CHECK(file.writes() == 1);
+    VC_CHECK(ReadFile(path) == "pending");
+
+    // Arrives after the worker has gone; the destructor writes it.
+    file.Update("late");
+    VC_CHECK(ReadFile(path) == "pending");
+  }
+  VC_CHECK(ReadFile(path) == "late");
+}
+
+void CheckNothingPending(const std::filesystem::path& dir) {
+  CountingLogger logger;
+  const std::filesystem::path path = dir / "idle.txt";
+  { vc::util::WriteBehindFile file(logger, path.string(), 10ms); }
+  VC_CHECK(!std::filesystem::exists(path));
+}
+
+// The parent "directory" is a regular file, which fails even as root.
+void CheckWriteFailure(const std::filesystem::path& dir) {
+  std::ofstream(dir / "not_a_dir") << "x";
+  CountingLogger logger;
+  vc::util::WriteBehindFile file(logger, (dir / "not_a_dir/file.txt").string(),
+                                 0ms);
+  file.Update("lost");
+  file.Stop();
+  VC_CHECK(file.writes() == 0);
+  VC_CHECK(logger.warnings() == 1);
+}
+
+}  // namespace
+
+int main() {
+  const std::filesystem::path dir =
+      std::filesystem::temp_directory_path() /
+      ("vc_write_behind_file_test." + std::to_string(getpid()));
+  std::filesystem::create_directories(dir);
+
+  CheckCoalesces(dir);
+  CheckStopFlushes(dir);
+  CheckNothingPending(dir);
+  CheckWriteFailure(dir);
+
+  std::filesystem::remove_all(dir);
+  return vc::test::ExitCode();
+}
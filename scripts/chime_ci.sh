@@ -12,6 +12,7 @@ FIX_FORMAT=0
 SKIP_FORMAT=0
 SKIP_TIDY=0
 SKIP_BUILD=0
+SKIP_TESTS=0
 
 log() {
   echo "[chime-ci] $*"
@@ -36,7 +37,8 @@ Options:
   --fix-format              Apply clang-format in place instead of check-only
   --skip-format             Skip clang-format
   --skip-tidy               Skip clang-tidy
-  --skip-build              Skip build step
+  --skip-build              Skip build step (and tests)
+  --skip-tests              Skip ctest
   -h, --help                Show this help text
 
 Examples:
@@ -85,6 +87,10 @@ parse_args() {
         SKIP_BUILD=1
         shift
         ;;
+      --skip-tests)
+        SKIP_TESTS=1
+        shift
+        ;;
       -h|--help)
         usage
         exit 0
@@ -258,6 +264,17 @@ run_build() {
   log "Build passed"
 }
 
+run_tests() {
+  if [ "$SKIP_BUILD" = "1" ] || [ "$SKIP_TESTS" = "1" ]; then
+    log "Skipping tests"
+    return
+  fi
+
+  require_tool ctest
+  ctest --test-dir "$BUILD_DIR" --build-config "$BUILD_TYPE" --output-on-failure
+  log "Tests passed"
+}
+
 main() {
   parse_args "$@"
 
@@ -273,6 +290,7 @@ main() {
   fi
   run_clang_tidy
   run_build
+  run_tests
 
   log "All requested checks passed"
 }
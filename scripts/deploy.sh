@@ -27,8 +27,6 @@ REMOTE_BINARY_STAGING_PATH="/usr/local/bin/.chime.new"
 REMOTE_WEBD_BINARY_STAGING_PATH="/usr/local/bin/.chime-webd.new"
 REMOTE_BINARY_PREV_PATH="/usr/local/bin/.chime.prev"
 REMOTE_WEBD_BINARY_PREV_PATH="/usr/local/bin/.chime-webd.prev"
-REMOTE_WEBD_UI_ROOT="/usr/local/share/chime-web-ui"
-REMOTE_WEBD_UI_DIST_PATH="$REMOTE_WEBD_UI_ROOT/dist"
 REMOTE_CONFIG_PATH="/etc/chime.conf"
 
 log() { echo "[deploy] $*"; }
@@ -161,6 +159,12 @@ mkdir -p /home/builder/chime-src/chime /home/builder/chime-src/common /home/buil
 sync_start="$(step_start)"
 rsync -a --delete /home/builder/virtualchime/chime/ /home/builder/chime-src/chime/
 rsync -a --delete /home/builder/virtualchime/common/ /home/builder/chime-src/common/
+if [ -d /home/builder/virtualchime/webui/dist ]; then
+    mkdir -p /home/builder/chime-src/webui/dist
+    rsync -a --delete /home/builder/virtualchime/webui/dist/ /home/builder/chime-src/webui/dist/
+else
+    rm -rf /home/builder/chime-src/webui
+fi
 rsync -a --delete /home/builder/virtualchime/buildroot/ /home/builder/br2-external/
 step_done "sync" "$sync_start"
 
@@ -263,16 +267,6 @@ fi
 mv -f $REMOTE_WEBD_BINARY_STAGING_PATH $REMOTE_WEBD_BINARY_PATH
 "
 
-    if [ -d "$WEBUI_DIST_DIR" ]; then
-        log "Deploying web UI assets from $WEBUI_DIST_DIR..."
-        ssh $SSH_OPTS "$SSH_USER@$host" "mkdir -p $REMOTE_WEBD_UI_ROOT"
-        scp -O -r $SSH_OPTS "$WEBUI_DIST_DIR" "$SSH_USER@$host:$REMOTE_WEBD_UI_ROOT"
-        ssh $SSH_OPTS "$SSH_USER@$host" "ls -la $REMOTE_WEBD_UI_DIST_PATH >/dev/null"
-    else
-        log "WARNING: $WEBUI_DIST_DIR not found; webd will serve fallback page."
-        log "Build UI assets first with: ./scripts/local_chime.sh webui-build"
-    fi
-
     log "Starting web service..."
     ssh $SSH_OPTS "$SSH_USER@$host" "/etc/init.d/S45webd start"
 
@@ -538,10 +532,11 @@ cmd_chime() {
     elif [ "$no_build" -eq 1 ]; then
         binary_path="$CHIME_BINARY"
     else
-        rebuild_chime_binary
+        # The web UI is compiled into chime-webd, so it is built first.
         if [ "$with_webd" -eq 1 ]; then
             build_webui_assets
         fi
+        rebuild_chime_binary
         binary_path="$CHIME_BINARY"
     fi
 
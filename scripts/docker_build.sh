@@ -210,6 +210,13 @@ sync_start="$(step_start)"
 rsync -a --delete /home/builder/virtualchime/buildroot/ /home/builder/br2-external/
 rsync -a --delete /home/builder/virtualchime/chime/ /home/builder/chime-src/chime/
 rsync -a --delete /home/builder/virtualchime/common/ /home/builder/chime-src/common/
+if [ -d /home/builder/virtualchime/webui/dist ]; then
+    mkdir -p /home/builder/chime-src/webui/dist
+    rsync -a --delete /home/builder/virtualchime/webui/dist/ /home/builder/chime-src/webui/dist/
+else
+    echo "[build] WARNING: webui/dist not found; chime-webd will serve its fallback page"
+    rm -rf /home/builder/chime-src/webui
+fi
 step_done "sync" "$sync_start"
 
 cd "buildroot-$BUILDROOT_VERSION"
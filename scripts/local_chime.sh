@@ -165,17 +165,39 @@ build_webd_binary() {
     read -r -a SSL_CFLAGS <<< "$cflags"
     read -r -a SSL_LIBS <<< "$libs"
 
+    local embed_ui_bin="$BIN_DIR/chime-webd-embed-ui"
+    local embedded_ui_source="$BUILD_DIR/generated/webd_embedded_ui.cpp"
+    log "Embedding web UI from $WEBUI_DIST_DIR..."
+    "${CXX:-c++}" \
+        -std=c++20 \
+        -O2 \
+        ${CXXFLAGS:-} \
+        -I"$CHIME_DIR/include" \
+        "$CHIME_DIR/tools/embed_ui_assets.cpp" \
+        "$CHIME_DIR/src/webd/string_utils.cpp" \
+        "$CHIME_DIR/src/webd/ui_asset_cache.cpp" \
+        -o "$embed_ui_bin" \
+        ${LDFLAGS:-} \
+        -lz
+    "$embed_ui_bin" "$WEBUI_DIST_DIR" "$embedded_ui_source"
+
     local sources=(
+        "$embedded_ui_source"
         "$CHIME_DIR/src/webd/main.cpp"
         "$CHIME_DIR/src/webd/apply_manager.cpp"
         "$CHIME_DIR/src/webd/config_store.cpp"
         "$CHIME_DIR/src/webd/json.cpp"
         "$CHIME_DIR/src/webd/mdns.cpp"
         "$CHIME_DIR/src/webd/string_utils.cpp"
+        "$CHIME_DIR/src/webd/ui_asset_cache.cpp"
         "$CHIME_DIR/src/webd/ui_assets.cpp"
         "$CHIME_DIR/src/webd/web_server.cpp"
         "$CHIME_DIR/src/webd/wifi_scan.cpp"
         "$PROJECT_DIR/common/src/logging/logger.cpp"
+        "$PROJECT_DIR/common/src/metrics/metrics.cpp"
+        "$PROJECT_DIR/common/src/metrics/prometheus.cpp"
+        "$PROJECT_DIR/common/src/metrics/stats_segment.cpp"
+        "$PROJECT_DIR/common/src/mqtt/topic_matcher.cpp"
         "$PROJECT_DIR/common/src/runtime/signal_handler.cpp"
         "$PROJECT_DIR/common/src/util/environment.cpp"
     )
@@ -193,6 +215,7 @@ build_webd_binary() {
         -o "$WEBD_BIN" \
         ${LDFLAGS:-} \
         "${SSL_LIBS[@]}" \
+        -lz \
         -lpthread
 
     log "Built: $WEBD_BIN"
@@ -202,11 +225,12 @@ build() {
     mkdir -p "$BUILD_DIR" "$BIN_DIR"
     load_versions
     build_chime_binary
-    build_webd_binary
 
+    # Built first so chime-webd embeds the fresh dist.
     if [ "${LOCAL_CHIME_BUILD_WEBUI:-0}" = "1" ]; then
         build_webui
     fi
+    build_webd_binary
 }
 
 build_webui() {
@@ -226,6 +250,16 @@ build_webui() {
         bun run build
     )
 
+    # chime-webd gzips assets itself when it starts; brotli at full quality
+    # is too slow for the device, so it is done here when the tool exists.
+    if command -v brotli >/dev/null 2>&1; then
+        log "Precompressing web UI assets with brotli..."
+        find "$WEBUI_DIST_DIR" -type f \( -name '*.html' -o -name '*.css' -o -name '*.js' -o -name '*.json' \
+            -o -name '*.svg' -o -name '*.ico' \) -exec brotli --force --keep --best {} +
+    else
+        log "brotli not found; web UI will be served with gzip only"
+    fi
+
     log "Built web UI dist: $WEBUI_DIST_DIR"
 }
 